@@ -1,5 +1,6 @@
 #include <common.h>
 #include <asm/global_data.h>
+#include <bootstage.h>
 #include <spl.h>
 #include <init.h>
 #include <hang.h>
@@ -73,10 +74,12 @@ void __noreturn board_init_f(ulong dummy)
 #endif
 
 	printf("spl sdram init ...\n");
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DRAM, "dram");
 	if (spl_sdram_init()) {
 		printf("spl sdram init failed\n");
 		hang();
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DRAM);
     readq(PHYS_TO_UNCACHED(0x16002108)) |= 0x80000000;
 
 	// change the sp, gd and malloc to sdram space
@@ -1,4 +1,5 @@
 #include <common.h>
+#include <bootstage.h>
 #include <init.h>
 #include <spl.h>
 #include <asm/addrspace.h>
@@ -12,6 +13,7 @@
 #include <image.h>
 #include <gzip.h>
 #include <linux/lzo.h>
+#include <linux/zstd.h>
 #include <linux/mtd/partitions.h>
 
 #if CONFIG_SYS_LOAD_ADDR >= LOCK_CACHE_BASE && CONFIG_SYS_LOAD_ADDR < (LOCK_CACHE_BASE + LOCK_CACHE_SIZE)
@@ -204,9 +206,13 @@ static int spl_board_load_image(struct spl_image_info *spl_image,
 		header = spl_get_load_buffer(-uncompress_size, uncompress_size);
 
 		buf = (u8*)CONFIG_SYS_LOAD_ADDR;
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_LOAD, "spl_load");
 		memcpy(buf, imgaddr, size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_LOAD);
 
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
 		ret = gunzip(header, uncompress_size, buf, &size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
 		if (ret) {
 			puts("gunzip Uncompress failed!\n");
 			return ret;
@@ -225,9 +231,13 @@ static int spl_board_load_image(struct spl_image_info *spl_image,
 		header = spl_get_load_buffer(-uncompress_size, uncompress_size);
 
 		buf = (u8*)CONFIG_SYS_LOAD_ADDR;
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_LOAD, "spl_load");
 		memcpy(buf, imgaddr, size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_LOAD);
 
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
 		ret = lzop_decompress(buf, size, (unsigned char*)header, &uncompress_size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
 		if (ret != LZO_E_OK) {
 			printf("lzop uncompress failed\n");
 			return ret;
@@ -235,8 +245,40 @@ static int spl_board_load_image(struct spl_image_info *spl_image,
 
 		debug("lzo uncompressed size: %ld\n", uncompress_size);
 		imgaddr = (u8 *)header;
+	} else if (IS_ENABLED(CONFIG_SPL_ZSTD) &&
+		   get_unaligned_le32(buf) == ZSTD_MAGICNUMBER) {
+		size_t wsize = zstd_dctx_workspace_bound();
+		zstd_dctx *dctx;
+
+		/*
+		 * The workspace is too large for the SPL heap, so put it in
+		 * DRAM. The boot space is memory-mapped, so decompress straight
+		 * from it; only the frame itself is read.
+		 */
+		dctx = zstd_init_dctx((void *)CONFIG_SYS_LOAD_ADDR, wsize);
+		if (!dctx) {
+			printf("zstd uncompress failed: no context\n");
+			return -ENOMEM;
+		}
+		header = spl_get_load_buffer(-uncompress_size, uncompress_size);
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
+		size = zstd_find_frame_compressed_size(imgaddr,
+						       BOOT_SPACE_SIZE - payload_offs);
+		if (!zstd_is_error(size))
+			size = zstd_decompress_dctx(dctx, header, uncompress_size,
+						    imgaddr, size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
+		if (zstd_is_error(size)) {
+			printf("zstd uncompress failed: %d\n",
+			       zstd_get_error_code(size));
+			return -EIO;
+		}
+
+		debug("zstd uncompressed size: %zu\n", size);
+		imgaddr = (u8 *)header;
 	}
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_LOAD, "spl_load");
 	if (IS_ENABLED(CONFIG_SPL_LOAD_FIT_FULL) &&
 			image_get_magic(header) == FDT_MAGIC) {
 		memcpy((void *)CONFIG_SYS_LOAD_ADDR,
@@ -258,6 +300,7 @@ static int spl_board_load_image(struct spl_image_info *spl_image,
 		memcpy((void *)spl_image->load_addr, 
 			imgaddr + spl_image->offset, spl_image->size);
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_LOAD);
 
 	return 0;
 }
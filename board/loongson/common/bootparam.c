@@ -1,4 +1,5 @@
 #include <common.h>
+#include <bootstage.h>
 #include <asm/addrspace.h>
 #include <smbios.h>
 #include <dm/device.h>
@@ -14,6 +15,8 @@
 #define SMBIOS_SIZE_LIMIT 			0x800
 #define ACPI_TABLE_PHYSICAL_ADDRESS	0x0fefe000
 #define ACPI_TABLE_SIZE_LIMIT 		0x100000
+#define BOOTSTAGE_TABLE_ADDRESS		0x0f03a000
+#define BOOTSTAGE_TABLE_SIZE		CONFIG_BOOTSTAGE_STASH_SIZE
 
 // static struct boot_params ls_boot_params;
 
@@ -172,6 +175,27 @@ void loongson_fdt_init(void)
 						(void *)fdt);
 }
 
+#ifdef CONFIG_LOONGSON_BOOTSTAGE_TABLE
+static const efi_guid_t bootstage_guid = LOONGSON_BOOTSTAGE_TABLE_GUID;
+
+/*
+ * Pass the boot timing records, including those stashed by SPL, to the
+ * kernel. They follow the boot params, in the reserved low memory.
+ */
+void loongson_bootstage_init(void)
+{
+	void *table = (void *)PHYS_TO_CACHED(BOOTSTAGE_TABLE_ADDRESS);
+
+	if (bootstage_stash(table, BOOTSTAGE_TABLE_SIZE)) {
+		printf("Warning: boot timing does not fit in %#x bytes\n",
+		       BOOTSTAGE_TABLE_SIZE);
+		return;
+	}
+	efi_install_configuration_table(&bootstage_guid,
+					(void *)BOOTSTAGE_TABLE_ADDRESS);
+}
+#endif
+
 int init_boot_param(struct boot_params *bp)
 {
 	u64 __maybe_unused tab_offset = sizeof(struct boot_params);
@@ -201,6 +225,9 @@ int init_boot_param(struct boot_params *bp)
 	loongson_acpi_init();
 #endif
 	loongson_fdt_init();
+#ifdef CONFIG_LOONGSON_BOOTSTAGE_TABLE
+	loongson_bootstage_init();
+#endif
 	return 0;
 }
 
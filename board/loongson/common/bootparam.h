@@ -42,6 +42,14 @@
 #define SPI_VBIOS_OFFSET	0x1000
 #define VBIOS_SIZE		0x1E000	//120KB
 
+/*
+ * EFI configuration table holding the boot timing records, in the format
+ * written by bootstage_stash()
+ */
+#define LOONGSON_BOOTSTAGE_TABLE_GUID \
+	EFI_GUID(0x6a1e2f5c, 0x3b4d, 0x4e8a, \
+		 0x9c, 0x27, 0x51, 0xd0, 0x8e, 0x3f, 0xa4, 0x6b)
+
 #if defined(BOOT_PARAMS_BPI)
 #define OFFSET_OF(type, field)	((phys_addr_t) &(((type *)0)->field))
 /* mask of the flags in bootparamsinterface */
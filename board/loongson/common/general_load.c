@@ -1,6 +1,7 @@
 #include <blk.h>
 #include <part.h>
 #include <gzip.h>
+#include <net/sink.h>
 #include <mach/addrspace.h>
 #include <asm/addrspace.h>
 #include "general_load.h"
@@ -36,13 +37,18 @@ static int64_t net_load(char* ip, char* port,
 		enum proto_t proto, char* symbol,
 		int64_t offset, void* buffer, int64_t size)
 {
+	ulong len;
+
 	if(strcmp(symbol, net_boot_file_name) == 0)
 		return 0;
 
 	copy_filename(net_boot_file_name, symbol,
 		      sizeof(net_boot_file_name));
 
-	return net_loop(proto);
+	if (net_loop_size(proto, &len) < 0)
+		return -1;
+
+	return len;
 }
 
 static int64_t blk_fs_load(char* interface, char* part,
@@ -211,6 +217,37 @@ static int64_t gl_burn(gl_device_t* gl_device, gl_format_t* gl_format, char* sym
 	return len;
 }
 
+#if CONFIG_IS_ENABLED(NET_SINK)
+// 网络下载直接写入块设备，不经过内存缓冲，镜像可以大于内存
+static int gl_stream(gl_target_t* src, gl_target_t* dest, enum gl_extra_e extra)
+{
+	struct blk_desc* dev = dest->gl_device.desc;
+	int64_t offset;
+	ulong len;
+	int ret;
+
+	offset = blk_partition_offset(dest->gl_device.interface,
+			dest->gl_device.part);
+	if (extra & GL_EXTRA_DECOMPRESS)
+		ret = net_sink_gzwrite(dev, offset);
+	else
+		ret = net_sink_blk(dev, offset);
+	if (ret)
+		return -1;
+
+	copy_filename(net_boot_file_name, src->symbol,
+		      sizeof(net_boot_file_name));
+	ret = net_loop_size(src->gl_format.proto, &len);
+	// 数据没有留在内存中，清除文件名以免 net_load() 误认为已加载
+	net_boot_file_name[0] = '\0';
+	if (ret < 0)
+		return -1;
+
+	printf("load&burn %lu bytes\n", len);
+	return 0;
+}
+#endif
+
 int general_load(gl_target_t* src, gl_target_t* dest, enum gl_extra_e extra)
 {
 	void* buffer = (void*)CONFIG_SYS_LOAD_ADDR;
@@ -225,6 +262,13 @@ int general_load(gl_target_t* src, gl_target_t* dest, enum gl_extra_e extra)
 	if (src == NULL)
 		return -1;
 
+#if CONFIG_IS_ENABLED(NET_SINK)
+	if (dest && src->gl_device.type == GL_DEVICE_NET &&
+	    dest->gl_device.type == GL_DEVICE_BLK &&
+	    dest->gl_format.fstype == FS_TYPE_ANY)
+		return gl_stream(src, dest, extra);
+#endif
+
 	while (1) {
 		load_size = gl_load(&src->gl_device, &src->gl_format, src->symbol,
 				offset, buffer, buffer_size);
@@ -7,6 +7,9 @@
 #include <asm/sections.h>
 #include <asm/addrspace.h>
 #include <dm.h>
+#include <dm/uclass-internal.h>
+#include <event.h>
+#include <iomux.h>
 #include <mapmem.h>
 #include <video_console.h>
 #include <usb.h>
@@ -243,6 +246,16 @@ static int vidconsole_notice(char *buf)
 	struct udevice *con, *vdev = NULL;
 	int col, row, len, ret;
 	int vidcon_id = 0;
+
+	/* do not bring up the display just to show the notice */
+	if (IS_ENABLED(CONFIG_DM_DEFERRED_PROBE)) {
+		uclass_find_first_device(UCLASS_VIDEO, &vdev);
+		if (!vdev || !device_active(vdev)) {
+			sprintf(buf, "Press %s, %s", NOTICE_STR1, NOTICE_STR2);
+			return 0;
+		}
+	}
+
 	for (uclass_first_device(UCLASS_VIDEO, &vdev);
 				vdev; uclass_next_device(&vdev)) {
 		debug("video device: %s\n", vdev->name);
@@ -420,7 +433,9 @@ int last_stage_init(void)
 	multi_boards_check_store();
 #endif
 
-	usb_init();
+	/* with deferred probing, USB is started when it is first needed */
+	if (!IS_ENABLED(CONFIG_DM_DEFERRED_PROBE))
+		usb_init();
 #ifdef CONFIG_LOONGSON_RECOVER
 	/*
 	 * 上电时长按按钮3秒进入recover功能, recover优先顺序usb>mmc>sata
@@ -438,6 +453,28 @@ int last_stage_init(void)
 	return 0;
 }
 EVENT_SPY_SIMPLE(EVT_LAST_STAGE_INIT, last_stage_init);
+
+#ifdef CONFIG_DM_DEFERRED_PROBE
+/*
+ * Autoboot did not happen, so start USB and add the display and the USB
+ * keyboard to the console, unless the console was set up differently
+ */
+static int ls_probe_deferred(void)
+{
+	usb_init();
+#if defined(CONFIG_VIDEO) && defined(CONFIG_CONSOLE_MUX)
+	if (!strcmp(env_get("stdout") ?: "", "serial")) {
+		iomux_doenv(stdout, "serial,vidconsole");
+		iomux_doenv(stderr, "serial,vidconsole");
+	}
+	if (!strcmp(env_get("stdin") ?: "", "serial," STDIN_GPIOBTN))
+		iomux_doenv(stdin, "serial," STDIN_GPIOBTN ",usbkbd");
+#endif
+
+	return 0;
+}
+EVENT_SPY_SIMPLE(EVT_DM_PROBE_DEFERRED, ls_probe_deferred);
+#endif
 #endif
 #endif
 
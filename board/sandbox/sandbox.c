@@ -104,6 +104,7 @@ unsigned long timer_read_counter(void)
 static enum env_location env_locations[] = {
 	ENVL_NOWHERE,
 	ENVL_EXT4,
+	ENVL_SPI_FLASH,
 	ENVL_FAT,
 };
 
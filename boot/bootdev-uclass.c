@@ -592,6 +592,18 @@ void bootdev_clear_bootflows(struct udevice *dev)
 	}
 }
 
+/* Check if a label refers to a network bootdev */
+static bool label_is_net(const char *label)
+{
+	const char *end;
+
+	if (!strcmp("dhcp", label) || !strcmp("pxe", label))
+		return true;
+	trailing_strtoln_end(label, NULL, &end);
+
+	return uclass_get_by_namelen(label, end - label) == UCLASS_ETH;
+}
+
 int bootdev_next_label(struct bootflow_iter *iter, struct udevice **devp,
 		       int *method_flagsp)
 {
@@ -602,9 +614,21 @@ int bootdev_next_label(struct bootflow_iter *iter, struct udevice **devp,
 		const char *label = iter->labels[iter->cur_label];
 		int ret;
 
+		/* hunting for a network bootdev would run DHCP */
+		if (iter->flags & BOOTFLOWIF_SKIP_NET &&
+		    label_is_net(label)) {
+			log_debug("Skipping: %s\n", label);
+			continue;
+		}
 		log_debug("Scanning: %s\n", label);
 		ret = bootdev_hunt_and_find_by_label(label, &dev,
 						     method_flagsp);
+		if (!ret && iter->flags & BOOTFLOWIF_SKIP_NET) {
+			struct bootdev_uc_plat *ucp = dev_get_uclass_plat(dev);
+
+			if (ucp->prio >= BOOTDEVP_6_NET_BASE)
+				dev = NULL;
+		}
 		if (iter->flags & BOOTFLOWIF_SHOW) {
 			if (ret == -EPFNOSUPPORT) {
 				log_warning("Unknown uclass '%s' in label\n",
@@ -667,7 +691,9 @@ int bootdev_next_prio(struct bootflow_iter *iter, struct udevice **devp)
 		if (!dev) {
 			log_debug("None found at prio %d, moving to %d\n",
 				  iter->cur_prio, iter->cur_prio + 1);
-			if (++iter->cur_prio == BOOTDEVP_COUNT)
+			if (++iter->cur_prio == BOOTDEVP_COUNT ||
+			    (iter->flags & BOOTFLOWIF_SKIP_NET &&
+			     iter->cur_prio >= BOOTDEVP_6_NET_BASE))
 				return log_msg_ret("fin", -ENODEV);
 
 			if (iter->flags & BOOTFLOWIF_HUNT) {
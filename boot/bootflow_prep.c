@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Preparing to boot during the autoboot countdown
+ *
+ * While the countdown waits for a key, a cyclic task does the slow parts of a
+ * bootflow scan: it probes the Ethernet devices, so that the PHYs start to
+ * negotiate a link, runs the bootdev hunters, which start the buses and
+ * initialise the media, then scans for bootflows, mounting each filesystem,
+ * until it finds a valid one. That bootflow becomes the current one and all of
+ * its files are read, for bootmeths which normally leave this until the boot.
+ * The boot command then boots it without scanning again.
+ *
+ * Each step does one thing, e.g. runs one hunter, so pressing a key stops the
+ * work after the step in progress and other cyclic functions, such as the
+ * watchdog, run between steps. Network bootdevs are not scanned, since that
+ * runs DHCP.
+ */
+
+#define LOG_CATEGORY UCLASS_BOOTSTD
+
+#include <common.h>
+#include <bootdev.h>
+#include <bootflow.h>
+#include <bootstd.h>
+#include <cyclic.h>
+#include <dm.h>
+#include <log.h>
+#include <dm/device-internal.h>
+#include <dm/uclass-internal.h>
+
+/**
+ * enum prep_state_t - Steps taken by the task
+ *
+ * @PREP_ETH: Probing Ethernet devices
+ * @PREP_HUNT: Running bootdev hunters
+ * @PREP_SCAN: Scanning bootdevs for a valid bootflow
+ * @PREP_READ: Reading the files of the selected bootflow
+ */
+enum prep_state_t {
+	PREP_ETH,
+	PREP_HUNT,
+	PREP_SCAN,
+	PREP_READ,
+};
+
+/**
+ * struct bootflow_prep - State of the preparation
+ *
+ * @task: Task doing the work
+ * @state: Current step
+ * @dev: Last Ethernet device probed, or NULL if none
+ * @prio: Priority of the hunters being run
+ * @hunter: Index of the next hunter to look at
+ * @iter: Bootflow iterator, valid if @scanning
+ * @scanning: true if the scan has started and not finished
+ * @num_valid: Number of valid bootflows found (0 or 1)
+ * @bflow: Bootflow prepared for booting, or NULL if none
+ * @active: true if the task has been started and not finished with
+ */
+static struct bootflow_prep {
+	struct cyclic_task task;
+	enum prep_state_t state;
+	struct udevice *dev;
+	enum bootdev_prio_t prio;
+	int hunter;
+	struct bootflow_iter iter;
+	bool scanning;
+	int num_valid;
+	struct bootflow *bflow;
+	bool active;
+} prep;
+
+/* Probe the next Ethernet device, returning false if there are no more */
+static bool prep_eth(struct bootflow_prep *priv)
+{
+	if (!priv->dev)
+		uclass_find_first_device(UCLASS_ETH, &priv->dev);
+	else
+		uclass_find_next_device(&priv->dev);
+	if (!priv->dev)
+		return false;
+
+	/* this starts autonegotiation with many PHYs */
+	if (device_probe(priv->dev))
+		log_debug("Cannot probe %s\n", priv->dev->name);
+
+	return true;
+}
+
+/*
+ * Run the next hunter, in priority order, returning false if there are no more
+ *
+ * Each hunter runs in its own step, so that slow ones, such as starting USB and
+ * SCSI, do not add up. Network hunters are left out, since they run DHCP.
+ */
+static bool prep_hunt(struct bootflow_prep *priv)
+{
+	struct bootdev_hunter *start;
+	int n_ent, ret;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (; priv->prio < BOOTDEVP_6_NET_BASE; priv->prio++, priv->hunter = 0) {
+		while (priv->hunter < n_ent) {
+			struct bootdev_hunter *info = start + priv->hunter++;
+
+			if (info->prio != priv->prio)
+				continue;
+			ret = bootdev_hunt(uclass_get_name(info->uclass), false);
+			if (ret)
+				log_debug("Hunter %s failed (err=%dE)\n",
+					  uclass_get_name(info->uclass), ret);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Look at the next bootflow, returning 0 when a valid one is found or there are
+ * no more, 1 if not
+ */
+static int prep_scan(struct bootflow_prep *priv)
+{
+	struct bootflow bflow;
+	int ret;
+
+	if (!priv->scanning) {
+		bootstd_clear_glob();
+		ret = bootflow_scan_first(NULL, NULL, &priv->iter,
+					  BOOTFLOWIF_SKIP_GLOBAL |
+					  BOOTFLOWIF_SKIP_NET, &bflow);
+		priv->scanning = true;
+	} else {
+		ret = bootflow_scan_next(&priv->iter, &bflow);
+	}
+	if (ret == -ENODEV) {
+		bootflow_iter_uninit(&priv->iter);
+		priv->scanning = false;
+		return 0;
+	}
+	if (ret) {
+		bootflow_free(&bflow);
+		return 1;
+	}
+
+	bootflow_iter_uninit(&priv->iter);
+	priv->scanning = false;
+	ret = bootdev_add_bootflow(&bflow);
+	if (ret) {
+		bootflow_free(&bflow);
+		return log_msg_ret("add", ret);
+	}
+	priv->num_valid++;
+
+	return 0;
+}
+
+/* Select the bootflow found by the scan and read its files */
+static int prep_read(struct bootflow_prep *priv)
+{
+	struct bootstd_priv *std;
+	struct bootflow *bflow;
+	int ret;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("std", ret);
+	if (bootflow_first_glob(&bflow))
+		return 0;
+	std->cur_bootflow = bflow;
+	priv->bflow = bflow;
+
+	ret = bootflow_read_all(bflow);
+	if (ret && ret != -ENOSYS)
+		log_warning("Cannot read bootflow '%s' (err=%dE)\n",
+			    bflow->name, ret);
+
+	return 0;
+}
+
+static void prep_abandon(struct bootflow_prep *priv)
+{
+	if (priv->scanning) {
+		bootflow_iter_uninit(&priv->iter);
+		priv->scanning = false;
+	}
+	bootstd_clear_glob();
+}
+
+static int prep_step(struct cyclic_task *task, void *ctx)
+{
+	struct bootflow_prep *priv = ctx;
+	int ret;
+
+	if (task->cancel) {
+		prep_abandon(priv);
+		return -ECANCELED;
+	}
+
+	switch (priv->state) {
+	case PREP_ETH:
+		if (!prep_eth(priv))
+			priv->state = PREP_HUNT;
+		break;
+	case PREP_HUNT:
+		if (!prep_hunt(priv))
+			priv->state = PREP_SCAN;
+		break;
+	case PREP_SCAN:
+		ret = prep_scan(priv);
+		if (ret < 0) {
+			prep_abandon(priv);
+			return log_msg_ret("scan", ret);
+		}
+		if (!ret)
+			priv->state = PREP_READ;
+		break;
+	case PREP_READ:
+		return prep_read(priv);
+	}
+
+	return cyclic_task_yield(task);
+}
+
+int bootflow_prep_start(void)
+{
+	int ret;
+
+	if (prep.active)
+		return -EALREADY;
+
+	memset(&prep, '\0', sizeof(prep));
+	prep.prio = BOOTDEVP_1_PRE_SCAN;
+	ret = cyclic_task_start(&prep.task, prep_step, "bootflow_prep", &prep);
+	if (ret)
+		return log_msg_ret("start", ret);
+	prep.active = true;
+
+	return 0;
+}
+
+int bootflow_prep_finish(bool cancel)
+{
+	int ret;
+
+	if (!prep.active)
+		return -ENOENT;
+	if (cancel)
+		cyclic_task_cancel(&prep.task);
+	ret = cyclic_task_join(&prep.task, 0);
+	if (ret == -EDEADLK)
+		return log_msg_ret("join", ret);
+	prep.active = false;
+	if (cancel)
+		prep.bflow = NULL;
+	if (ret)
+		return log_msg_ret("prep", ret);
+	log_debug("Prepared %d bootflows\n", prep.num_valid);
+
+	return prep.num_valid;
+}
+
+struct bootflow *bootflow_prep_take(void)
+{
+	struct bootstd_priv *std;
+	struct bootflow *bflow;
+
+	bflow = prep.bflow;
+	prep.bflow = NULL;
+	if (!bflow || prep.active || bootstd_get_priv(&std))
+		return NULL;
+
+	/* something else may have selected or dropped it since */
+	if (std->cur_bootflow != bflow)
+		return NULL;
+
+	return bflow;
+}
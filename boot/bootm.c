@@ -616,6 +616,140 @@ static int handle_decomp_error(int comp_type, size_t uncomp_size,
 #endif
 
 #ifndef USE_HOSTCC
+/*
+ * Check that the range from @base to @end does not overlap the ramdisk or
+ * devicetree, returning -EXDEV if it does
+ */
+static int bootm_check_others(struct bootm_headers *images, ulong base,
+			      ulong end)
+{
+	if (check_overlap("RD", images->rd_start, images->rd_end, base,
+			  end - base))
+		return -EXDEV;
+	if (images->ft_addr &&
+	    check_overlap("FDT", map_to_sysmem(images->ft_addr),
+			  map_to_sysmem(images->ft_addr) + images->ft_len, base,
+			  end - base))
+		return -EXDEV;
+
+	return 0;
+}
+
+/*
+ * Reserve the range from @base to @end if it is free, returning true if it was
+ * reserved and must be freed by the caller
+ */
+static bool bootm_hold(struct lmb *lmb, ulong base, ulong end)
+{
+	return base && end > base &&
+		lmb_alloc_addr(lmb, base, end - base) == base;
+}
+
+/**
+ * bootm_place_os() - Move a compressed OS image out of the way of its output
+ *
+ * If the compressed image overlaps the place it is decompressed to, it is
+ * moved to the end of that place with enough margin to decompress it in
+ * place (CONFIG_BOOTM_DECOMP_IN_PLACE), or else copied to a staging buffer
+ * allocated with lmb (CONFIG_BOOTM_STAGING). This overwrites the image which
+ * holds the OS, so the ramdisk and devicetree must not be in the way. Since
+ * they are not reserved in lmb until later, they are held while the staging
+ * buffer is allocated and the buffer is checked against them.
+ *
+ * @images: Images information
+ * @load: Address to decompress to
+ * @startp: Address of the compressed image, updated if it is moved
+ * @stagingp: Returns the address of the staging buffer, to be freed by the
+ *	caller, or 0 if none
+ * @unc_lenp: Returns the space available for decompression, which is
+ *	limited to the size recorded in the image when decompressing in place
+ * Return: 0 if the image was moved, -EAGAIN if it was not in the way or could
+ * not be moved, -EXDEV if another image is in the way, -ENOMEM if there is
+ * no memory for a staging buffer
+ */
+static int bootm_place_os(struct bootm_headers *images, ulong load,
+			  ulong *startp, ulong *stagingp, uint *unc_lenp)
+{
+	ulong start = *startp, len = images->os.image_len;
+	int comp = images->os.comp;
+	ulong size, end, dst, rd_start, rd_end, ft_start, ft_end;
+	bool size_known, in_place, rd_held, ft_held;
+	void *buf;
+
+	*stagingp = 0;
+	buf = map_sysmem(start, len);
+	size_known = !image_decomp_size(comp, buf, len, &size) &&
+		size <= CONFIG_SYS_BOOTM_LEN;
+	if (!size_known)
+		size = CONFIG_SYS_BOOTM_LEN;
+	if (start >= load + size || start + len <= load)
+		return -EAGAIN;
+
+	in_place = IS_ENABLED(CONFIG_BOOTM_DECOMP_IN_PLACE) && size_known &&
+		(comp == IH_COMP_GZIP || comp == IH_COMP_LZ4 ||
+		 comp == IH_COMP_ZSTD);
+	if (in_place) {
+		end = load + size + image_decomp_margin(comp, size);
+		dst = ALIGN_DOWN(end - len, 8);
+
+		/* an image which does not compress cannot move below load */
+		if (dst < load)
+			in_place = false;
+	}
+	if (!in_place) {
+		if (!IS_ENABLED(CONFIG_BOOTM_STAGING))
+			return -EAGAIN;
+		end = load + size;
+	}
+
+	if (size_known && bootm_check_others(images, load, end))
+		return -EXDEV;
+
+	/* the output, and the margin above it, must be free memory */
+	if (lmb_alloc_addr(&images->lmb, load, end - load) != load) {
+		printf("No memory to decompress the OS image at %lx..%lx\n",
+		       load, end);
+		return -EAGAIN;
+	}
+
+	if (in_place) {
+		lmb_free(&images->lmb, load, end - load);
+		debug("Moving compressed OS from %lx to %lx to decompress in place\n",
+		      start, dst);
+		memmove(map_sysmem(dst, len), buf, len);
+		*unc_lenp = size;
+	} else {
+		/* keep the staging buffer clear of the output and other images */
+		rd_start = images->rd_start;
+		rd_end = images->rd_end;
+		ft_start = images->ft_addr ? map_to_sysmem(images->ft_addr) : 0;
+		ft_end = ft_start + images->ft_len;
+		rd_held = bootm_hold(&images->lmb, rd_start, rd_end);
+		ft_held = bootm_hold(&images->lmb, ft_start, ft_end);
+		dst = lmb_alloc(&images->lmb, len, ARCH_DMA_MINALIGN);
+		if (ft_held)
+			lmb_free(&images->lmb, ft_start, ft_end - ft_start);
+		if (rd_held)
+			lmb_free(&images->lmb, rd_start, rd_end - rd_start);
+		lmb_free(&images->lmb, load, end - load);
+		if (!dst) {
+			printf("No memory to stage the OS image (%lx bytes)\n",
+			       len);
+			return -ENOMEM;
+		}
+		if (bootm_check_others(images, dst, dst + len)) {
+			lmb_free(&images->lmb, dst, len);
+			return -EXDEV;
+		}
+		debug("Staging compressed OS at %lx\n", dst);
+		memcpy(map_sysmem(dst, len), buf, len);
+		*stagingp = dst;
+	}
+	*startp = dst;
+
+	return 0;
+}
+
 static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 {
 	struct image_info os = images->os;
@@ -626,7 +760,9 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 	ulong image_start = os.image_start;
 	ulong image_len = os.image_len;
 	ulong flush_start = ALIGN_DOWN(load, ARCH_DMA_MINALIGN);
-	bool no_overlap;
+	uint unc_len = CONFIG_SYS_BOOTM_LEN;
+	ulong staging = 0;
+	bool no_overlap, placed = false;
 	void *load_buf, *image_buf;
 	int err;
 
@@ -649,11 +785,20 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 		      req_size, load, image_len);
 	}
 
+	if (os.comp != IH_COMP_NONE) {
+		err = bootm_place_os(images, load, &image_start, &staging,
+				     &unc_len);
+		if (err == -EXDEV || err == -ENOMEM)
+			return 1;
+		placed = !err;
+	}
+
 	load_buf = map_sysmem(load, 0);
-	image_buf = map_sysmem(os.image_start, image_len);
-	err = image_decomp(os.comp, load, os.image_start, os.type,
-			   load_buf, image_buf, image_len,
-			   CONFIG_SYS_BOOTM_LEN, &load_end);
+	image_buf = map_sysmem(image_start, image_len);
+	err = image_decomp(os.comp, load, image_start, os.type,
+			   load_buf, image_buf, image_len, unc_len, &load_end);
+	if (staging)
+		lmb_free(&images->lmb, staging, image_len);
 	if (err) {
 		err = handle_decomp_error(os.comp, load_end - load,
 					  CONFIG_SYS_BOOTM_LEN, err);
@@ -668,7 +813,8 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 	debug("   kernel loaded at 0x%08lx, end = 0x%08lx\n", load, load_end);
 	bootstage_mark(BOOTSTAGE_ID_KERNEL_LOADED);
 
-	no_overlap = (os.comp == IH_COMP_NONE && load == image_start);
+	/* a moved image was overwritten on purpose */
+	no_overlap = placed || (os.comp == IH_COMP_NONE && load == image_start);
 
 	if (!no_overlap && load < blob_end && load_end > blob_start) {
 		debug("images.os.start = 0x%lX, images.os.end = 0x%lx\n",
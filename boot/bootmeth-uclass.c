@@ -73,12 +73,39 @@ int bootmeth_read_all(struct udevice *dev, struct bootflow *bflow)
 }
 #endif /* BOOTSTD_FULL */
 
+/* Probe the devices which the bootmeth says it needs */
+static void bootmeth_probe_needs(struct udevice *dev)
+{
+	struct bootmeth_uc_plat *plat = dev_get_uclass_plat(dev);
+	const char *const *name;
+	struct udevice *need;
+	enum uclass_id id;
+	ofnode node;
+	int ret;
+
+	for (name = plat->needs; name && *name; name++) {
+		id = uclass_get_by_name(*name);
+		if (id != UCLASS_INVALID) {
+			ret = uclass_probe_all(id);
+		} else {
+			node = ofnode_path(*name);
+			ret = ofnode_valid(node) ?
+				device_get_global_by_ofnode(node, &need) :
+				-ENOENT;
+		}
+		if (ret)
+			log_warning("Bootmeth '%s' cannot get '%s' (err=%d)\n",
+				    dev->name, *name, ret);
+	}
+}
+
 int bootmeth_boot(struct udevice *dev, struct bootflow *bflow)
 {
 	const struct bootmeth_ops *ops = bootmeth_get_ops(dev);
 
 	if (!ops->boot)
 		return -ENOSYS;
+	bootmeth_probe_needs(dev);
 
 	return ops->boot(dev, bflow);
 }
@@ -420,9 +447,22 @@ static int on_bootmeths(const char *name, const char *value, enum env_op op,
 U_BOOT_ENV_CALLBACK(bootmeths, on_bootmeths);
 #endif /* CONFIG_BOOTSTD_FULL */
 
+static int bootmeth_post_bind(struct udevice *dev)
+{
+	struct bootmeth_uc_plat *plat = dev_get_uclass_plat(dev);
+	const char **needs;
+
+	if (dev_has_ofnode(dev) &&
+	    dev_read_string_list(dev, "u-boot,needs", &needs) > 0)
+		plat->needs = needs;
+
+	return 0;
+}
+
 UCLASS_DRIVER(bootmeth) = {
 	.id		= UCLASS_BOOTMETH,
 	.name		= "bootmeth",
 	.flags		= DM_UC_FLAG_SEQ_ALIAS,
+	.post_bind	= bootmeth_post_bind,
 	.per_device_plat_auto	= sizeof(struct bootmeth_uc_plat),
 };
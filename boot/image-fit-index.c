@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Index of the last FIT which was checked
+ *
+ * Booting a FIT checks its format once for each image loaded from it, and
+ * each lookup of an image or configuration walks the devicetree from the
+ * start. With many configurations, e.g. one for each of dozens of boards,
+ * this is a noticeable part of the boot time.
+ *
+ * fit_check_format() adds a FIT which passes its checks to this index, with
+ * the offsets of the /images and /configurations nodes and of each image, and
+ * a CRC32 of the devicetree. Lookups use the index while the FIT is at the same
+ * address with the same header, so its size and layout are unchanged. An
+ * in-place edit does not move any node, but lookups still check the name of
+ * each node found.
+ *
+ * When the same FIT is checked again, the CRC32 is checked, so an in-place edit
+ * drops the index. The checks are then skipped if the CRC32 matches, unless the
+ * full check is enabled: a CRC32 is easily forged, so it cannot stand in for
+ * the checks needed by verified boot.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <image.h>
+#include <log.h>
+#include <u-boot/crc.h>
+#include <asm/global_data.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Maximum number of images held in the index */
+#define FIT_INDEX_MAX_IMAGES	128
+
+/**
+ * struct fit_index_image - an image in the index
+ *
+ * @name:	name of the image node, in the FIT
+ * @node:	offset of the image node
+ */
+struct fit_index_image {
+	const char *name;
+	int node;
+};
+
+/**
+ * struct fit_index - index of a FIT
+ *
+ * @fit:	the FIT, or NULL if there is none
+ * @hdr:	copy of the devicetree header, to notice changes quickly
+ * @crc:	CRC32 of the devicetree, when it was checked
+ * @images:	offset of the /images node
+ * @confs:	offset of the /configurations node, or -ve if none
+ * @count:	number of images, or -1 if there are too many to index
+ * @image:	the images
+ * @compat_fdt:	devicetree last passed to fit_conf_find_compat()
+ * @compat_crc:	CRC32 of its compatible property
+ * @compat_conf: configuration found for it, or -ve if none matched
+ */
+struct fit_index {
+	const void *fit;
+	struct fdt_header hdr;
+	u32 crc;
+	int images;
+	int confs;
+	int count;
+	struct fit_index_image image[FIT_INDEX_MAX_IMAGES];
+	const void *compat_fdt;
+	u32 compat_crc;
+	int compat_conf;
+};
+
+static struct fit_index fit_index;
+
+static u32 fit_index_crc(const void *fit)
+{
+	return crc32(0, fit, fdt_totalsize(fit));
+}
+
+/* Get the index of a FIT, if it is at the same address with the same header */
+static struct fit_index *fit_index_find(const void *fit)
+{
+	struct fit_index *idx = &fit_index;
+
+	if (!idx->fit || idx->fit != fit ||
+	    memcmp(&idx->hdr, fit, sizeof(idx->hdr)))
+		return NULL;
+
+	return idx;
+}
+
+int fit_index_check(const void *fit)
+{
+	struct fit_index *idx = fit_index_find(fit);
+
+	if (!idx)
+		return -ENOENT;
+
+	/* an in-place edit leaves the header as it was */
+	if (fit_index_crc(fit) != idx->crc) {
+		idx->fit = NULL;
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+/* Check that the node at @node is the top-level node @path */
+static int fit_index_check_path(const void *fit, int node, const char *path)
+{
+	const char *name = fdt_get_name(fit, node, NULL);
+
+	if (!name || strcmp(name, path + 1) ||
+	    fdt_parent_offset(fit, node) != 0)
+		return -ENOENT;
+
+	return node;
+}
+
+void fit_index_add(const void *fit)
+{
+	struct fit_index *idx = &fit_index;
+	int node;
+
+	/* the index lives in BSS, which is not usable before relocation */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+	idx->fit = NULL;
+	if (fdt_totalsize(fit) > CONFIG_FIT_INDEX_MAX_SIZE)
+		return;
+
+	idx->images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (idx->images < 0)
+		return;
+	idx->confs = fdt_path_offset(fit, FIT_CONFS_PATH);
+	idx->count = 0;
+	fdt_for_each_subnode(node, fit, idx->images) {
+		struct fit_index_image *img = &idx->image[idx->count];
+
+		if (idx->count == FIT_INDEX_MAX_IMAGES) {
+			idx->count = -1;
+			break;
+		}
+		img->name = fdt_get_name(fit, node, NULL);
+		if (!img->name)
+			return;
+		img->node = node;
+		idx->count++;
+	}
+	idx->compat_fdt = NULL;
+	memcpy(&idx->hdr, fit, sizeof(idx->hdr));
+	idx->crc = fit_index_crc(fit);
+	idx->fit = fit;
+	log_debug("Indexed FIT at %p, %d images\n", fit, idx->count);
+}
+
+int fit_index_path(const void *fit, const char *path)
+{
+	struct fit_index *idx = fit_index_find(fit);
+
+	if (!idx)
+		return -ENOENT;
+	if (!strcmp(path, FIT_IMAGES_PATH))
+		return fit_index_check_path(fit, idx->images, path);
+	if (!strcmp(path, FIT_CONFS_PATH) && idx->confs >= 0)
+		return fit_index_check_path(fit, idx->confs, path);
+
+	return -ENOENT;
+}
+
+int fit_index_image(const void *fit, const char *name)
+{
+	struct fit_index *idx = fit_index_find(fit);
+	int len = strlen(name);
+	const char *node_name;
+	int i;
+
+	if (!idx || idx->count < 0)
+		return -ENOENT;
+
+	/* match names as libfdt does, so the same node is found */
+	for (i = 0; i < idx->count; i++) {
+		struct fit_index_image *img = &idx->image[i];
+
+		if (strncmp(name, img->name, len) ||
+		    (img->name[len] &&
+		     (img->name[len] != '@' || strchr(name, '@'))))
+			continue;
+		node_name = fdt_get_name(fit, img->node, NULL);
+		if (!node_name || strcmp(img->name, node_name))
+			return -ENOENT;
+
+		return img->node;
+	}
+
+	return -ENOENT;
+}
+
+/* CRC32 of the compatible property of a devicetree, 0 if it has none */
+static u32 fit_index_compat_crc(const void *fdt)
+{
+	const void *compat;
+	int len;
+
+	compat = fdt_getprop(fdt, 0, "compatible", &len);
+	if (!compat)
+		return 0;
+
+	return crc32(0, compat, len);
+}
+
+int fit_index_get_compat(const void *fit, const void *fdt)
+{
+	struct fit_index *idx = fit_index_find(fit);
+
+	if (!idx || !idx->compat_fdt || idx->compat_fdt != fdt ||
+	    fit_index_compat_crc(fdt) != idx->compat_crc)
+		return -ENOENT;
+
+	return idx->compat_conf;
+}
+
+void fit_index_set_compat(const void *fit, const void *fdt, int conf)
+{
+	struct fit_index *idx = fit_index_find(fit);
+
+	if (!idx)
+		return;
+	idx->compat_fdt = fdt;
+	idx->compat_crc = fit_index_compat_crc(fdt);
+	idx->compat_conf = conf;
+}
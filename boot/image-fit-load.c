@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Hashing of FIT images while they are loaded
+ *
+ * Verifying an image of a FIT normally hashes its data once the whole FIT
+ * has been loaded. For a large FIT this is a second pass over the data,
+ * which has long left the caches. Instead, loaders report each piece of
+ * data as it arrives. Once the FIT header (the devicetree) is complete, the
+ * images and their hash nodes are found, and the data of each image is
+ * hashed while it is still in the cache. fit_image_check_hash() then uses
+ * the digest instead of hashing the data again.
+ *
+ * Only the data of FITs with external data (mkimage -E) is hashed as it
+ * arrives; embedded data is part of the devicetree and is hashed once the
+ * devicetree is complete.
+ *
+ * Each digest is used once. The digests of an image are dropped when a later
+ * load writes over its data, or when commands which write to memory report
+ * it with fit_load_hash_forget(). Other writes to memory are not tracked, so
+ * the digests are not used when the control devicetree requires a FIT to be
+ * signed by one of its keys: verified boot always hashes the data again.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <hash.h>
+#include <image.h>
+#include <log.h>
+#include <mapmem.h>
+#include <watchdog.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of image hashes which can be tracked */
+#define FIT_LOAD_HASH_MAX	16
+
+/**
+ * struct fit_load_hash - hash of the data of a FIT image
+ *
+ * @addr:	address of the data
+ * @size:	size of the data in bytes
+ * @algo:	hash algorithm
+ * @ctx:	hash context while the data is being hashed, else NULL
+ * @value:	digest, once the data has been hashed
+ * @valid:	true if @value holds the digest
+ * @loading:	true if the image is part of the current load
+ */
+struct fit_load_hash {
+	ulong addr;
+	ulong size;
+	struct hash_algo *algo;
+	void *ctx;
+	u8 value[HASH_MAX_DIGEST_SIZE];
+	bool valid;
+	bool loading;
+};
+
+static struct fit_load_hash fit_load_hash[FIT_LOAD_HASH_MAX];
+
+/* Address of the current load */
+static ulong fit_load_addr;
+/* Number of bytes of the current load which have been hashed */
+static ulong fit_load_done;
+/* The current load may be a FIT */
+static bool fit_load_active;
+/* The images of the current load have been found */
+static bool fit_load_parsed;
+
+static void fit_load_hash_drop(struct fit_load_hash *h)
+{
+	/* finishing frees the context */
+	if (h->ctx)
+		h->algo->hash_finish(h->algo, h->ctx, h->value,
+				     sizeof(h->value));
+	h->ctx = NULL;
+	h->valid = false;
+	h->loading = false;
+}
+
+/* Find a free entry, else reuse one from an earlier load */
+static struct fit_load_hash *fit_load_hash_alloc(void)
+{
+	struct fit_load_hash *h, *old = NULL;
+
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (h->loading)
+			continue;
+		if (!h->valid)
+			return h;
+		old = h;
+	}
+	if (old)
+		fit_load_hash_drop(old);
+
+	return old;
+}
+
+/* Set up hashing of each image of the FIT at @fit which has a hash node */
+static int fit_load_hash_parse(const void *fit)
+{
+	struct fit_load_hash *h;
+	struct hash_algo *algo;
+	const char *algo_name;
+	int images, node, noffset;
+	const void *data;
+	size_t size;
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (images < 0)
+		return -ENOENT;
+
+	fdt_for_each_subnode(node, fit, images) {
+		if (fit_image_get_data_and_size(fit, node, &data, &size) ||
+		    !size || data < fit)
+			continue;
+
+		fdt_for_each_subnode(noffset, fit, node) {
+			if (strncmp(fit_get_name(fit, noffset, NULL),
+				    FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)))
+				continue;
+			if (fit_image_hash_get_algo(fit, noffset, &algo_name) ||
+			    hash_progressive_lookup_algo(algo_name, &algo))
+				continue;
+
+			/* the others are hashed when verified */
+			h = fit_load_hash_alloc();
+			if (!h)
+				return 0;
+			if (algo->hash_init(algo, &h->ctx)) {
+				h->ctx = NULL;
+				continue;
+			}
+			h->addr = map_to_sysmem(data);
+			h->size = size;
+			h->algo = algo;
+			h->loading = true;
+			log_debug("image %s at %lx, %s\n",
+				  fit_get_name(fit, node, NULL), h->addr,
+				  algo_name);
+		}
+	}
+
+	return 0;
+}
+
+/* Hash the data of @h from @from to @to, offsets in the load */
+static void fit_load_hash_data(struct fit_load_hash *h, ulong from, ulong to)
+{
+	ulong end = h->addr - fit_load_addr + h->size;
+	const u8 *buf = map_sysmem(fit_load_addr + from, to - from);
+	ulong chunk;
+
+	for (; from < to; from += chunk, buf += chunk) {
+		chunk = min_t(ulong, to - from, h->algo->chunk_size);
+		if (h->algo->hash_update(h->algo, h->ctx, buf, chunk,
+					 from + chunk == end)) {
+			/* the context has been freed */
+			h->ctx = NULL;
+			return;
+		}
+		schedule();
+	}
+	if (to == end) {
+		h->valid = !h->algo->hash_finish(h->algo, h->ctx, h->value,
+						 sizeof(h->value));
+		h->ctx = NULL;
+	}
+}
+
+/* Hash the current load up to offset @end */
+static void fit_load_hash_advance(ulong end)
+{
+	const void *fit = map_sysmem(fit_load_addr, 0);
+	ulong from = fit_load_done;
+	struct fit_load_hash *h;
+	ulong start, stop;
+
+	if (!fit_load_parsed) {
+		if (end >= sizeof(struct fdt_header) &&
+		    fdt_magic(fit) != FDT_MAGIC) {
+			fit_load_active = false;
+			return;
+		}
+		if (end < sizeof(struct fdt_header) ||
+		    end < fdt_totalsize(fit)) {
+			fit_load_done = end;
+			return;
+		}
+		if (fit_load_hash_parse(fit)) {
+			fit_load_active = false;
+			return;
+		}
+		fit_load_parsed = true;
+		/* the embedded data has been loaded already */
+		from = 0;
+	}
+
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (!h->loading || !h->ctx)
+			continue;
+		start = max(h->addr - fit_load_addr, from);
+		stop = min(h->addr - fit_load_addr + h->size, end);
+		if (start < stop)
+			fit_load_hash_data(h, start, stop);
+	}
+	fit_load_done = end;
+}
+
+void fit_load_hash_forget(ulong addr, ulong len)
+{
+	struct fit_load_hash *h;
+
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (h->valid && !h->loading && addr < h->addr + h->size &&
+		    h->addr < addr + len)
+			fit_load_hash_drop(h);
+	}
+}
+
+void fit_load_hash_start(ulong addr)
+{
+	struct fit_load_hash *h;
+
+	/* abandon the images of an unfinished load */
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (h->loading)
+			fit_load_hash_drop(h);
+	}
+	fit_load_addr = addr;
+	fit_load_done = 0;
+	fit_load_active = true;
+	fit_load_parsed = false;
+}
+
+void fit_load_hash_update(ulong addr, ulong len)
+{
+	fit_load_hash_forget(addr, len);
+	if (!fit_load_active || addr < fit_load_addr ||
+	    addr > fit_load_addr + fit_load_done)
+		return;
+	if (addr + len > fit_load_addr + fit_load_done)
+		fit_load_hash_advance(addr + len - fit_load_addr);
+}
+
+void fit_load_hash_end(bool ok, ulong size)
+{
+	struct fit_load_hash *h;
+
+	if (ok) {
+		fit_load_hash_forget(fit_load_addr, size);
+		if (fit_load_active && size > fit_load_done)
+			fit_load_hash_advance(size);
+	}
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (!h->loading)
+			continue;
+		/* images not loaded completely are dropped */
+		if (!ok || h->ctx)
+			fit_load_hash_drop(h);
+		h->loading = false;
+	}
+	fit_load_active = false;
+}
+
+bool fit_load_hash_active(void)
+{
+	struct fit_load_hash *h;
+
+	if (!fit_load_active || !fit_load_parsed)
+		return fit_load_active;
+
+	/* the rest of the load holds no image which is being hashed */
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (h->loading && h->ctx)
+			return true;
+	}
+
+	return false;
+}
+
+/* Check whether the control devicetree has a key which a FIT must use */
+static bool fit_load_hash_sig_required(void)
+{
+	const void *blob = gd_fdt_blob();
+	int sig, key;
+
+	if (!IS_ENABLED(CONFIG_FIT_SIGNATURE) || !blob)
+		return false;
+	sig = fdt_subnode_offset(blob, 0, FIT_SIG_NODENAME);
+	if (sig < 0)
+		return false;
+	fdt_for_each_subnode(key, blob, sig) {
+		if (fdt_getprop(blob, key, FIT_KEY_REQUIRED, NULL))
+			return true;
+	}
+
+	return false;
+}
+
+int fit_load_hash_get(const void *data, ulong size, const char *algo,
+		      uint8_t *value, int *value_len)
+{
+	ulong addr = map_to_sysmem(data);
+	struct fit_load_hash *h;
+
+	if (fit_load_hash_sig_required())
+		return -ENOENT;
+
+	for (h = fit_load_hash; h < fit_load_hash + FIT_LOAD_HASH_MAX; h++) {
+		if (h->valid && h->addr == addr && h->size == size &&
+		    !strcmp(h->algo->name, algo)) {
+			memcpy(value, h->value, h->algo->digest_size);
+			*value_len = h->algo->digest_size;
+			/* the data may change before it is verified again */
+			fit_load_hash_drop(h);
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Reading the parts of a FIT with external data which a configuration uses
+ *
+ * A FIT built with external data (mkimage -E) holds the devicetree describing
+ * the images first, followed by the data of all the images. Loading the whole
+ * file reads the data of every configuration, and fit_image_load() then
+ * copies each image from there to its load address.
+ *
+ * Instead, fit_read() reads the devicetree, then only the images used by the
+ * selected configuration. An image which is not compressed or encrypted and
+ * has a load address is read straight to that address, and its data-offset
+ * or data-position property is adjusted in the copy of the devicetree in
+ * memory, so that fit_image_load() finds the data already in place. Other
+ * images are read to the place they would have in a copy of the whole file.
+ *
+ * The properties giving the position of the data are not covered by
+ * configuration signatures, so verified boot works as usual.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <image.h>
+#include <log.h>
+#include <mapmem.h>
+#include <linux/errno.h>
+#include <linux/libfdt.h>
+
+/* Maximum number of images used by one configuration */
+#define FIT_READ_MAX_IMAGES	32
+
+/**
+ * struct fit_read_image - an image to be read
+ *
+ * @node:	offset of the image node
+ * @pos:	position of the data in the FIT
+ * @size:	size of the data
+ * @load:	true if the data is read to the load address
+ * @dst:	load address, if @load is true
+ */
+struct fit_read_image {
+	int node;
+	ulong pos;
+	ulong size;
+	bool load;
+	ulong dst;
+};
+
+static int fit_read_data(struct fit_read_info *info, ulong pos, ulong size,
+			 void *buf)
+{
+	long ret;
+
+	ret = info->read(info, pos, size, buf);
+	if (ret < 0)
+		return ret;
+	if (ret != size)
+		return -EIO;
+
+	return 0;
+}
+
+/* Find the data of an image; return 0 if the data is embedded */
+static int fit_read_get_pos(const void *fit, struct fit_read_image *img)
+{
+	int pos, size;
+
+	if (fit_image_get_data_position(fit, img->node, &pos)) {
+		if (fit_image_get_data_offset(fit, img->node, &pos))
+			return 0;
+		pos += ALIGN(fdt_totalsize(fit), 4);
+	}
+	if (fit_image_get_data_size(fit, img->node, &size) || pos < 0 ||
+	    size < 0)
+		return -EBADF;
+	img->pos = pos;
+	img->size = size;
+
+	return 1;
+}
+
+/*
+ * Check whether image @idx can be read straight to its load address, given
+ * the images before it, which are already placed
+ */
+static bool fit_read_to_load(const void *fit, struct fit_read_image *imgs,
+			     int idx, ulong addr, ulong end, void **bufp)
+{
+	struct fit_read_image *img = &imgs[idx];
+	int node = img->node;
+	ulong size = img->size;
+	ulong load;
+	void *buf;
+	u8 comp;
+	long diff;
+	int i;
+
+	if (fit_image_get_load(fit, node, &load) || !load)
+		return false;
+	if (!fit_image_get_comp(fit, node, &comp) && comp != IH_COMP_NONE)
+		return false;
+	if (fdt_subnode_offset(fit, node, FIT_CIPHER_NODENAME) >= 0)
+		return false;
+
+	/* keep clear of the devicetree and the images staged after it */
+	if (load < end && load + size > addr)
+		return false;
+
+	/* and of the images already read to their load addresses */
+	for (i = 0; i < idx; i++) {
+		if (imgs[i].load && load < imgs[i].dst + imgs[i].size &&
+		    load + size > imgs[i].dst)
+			return false;
+	}
+
+	/* the property giving the position of the data is 32 bits, signed */
+	buf = map_sysmem(load, size);
+	diff = (char *)buf - (char *)fit;
+	if (diff != (int)diff)
+		return false;
+	img->dst = load;
+	*bufp = buf;
+
+	return true;
+}
+
+/* Point the image at data which is not where the FIT says it is */
+static int fit_read_move(void *fit, struct fit_read_image *img, void *buf)
+{
+	int offset, pos;
+
+	offset = (char *)buf - (char *)fit;
+	if (!fit_image_get_data_position(fit, img->node, &pos))
+		return fdt_setprop_inplace_u32(fit, img->node,
+					       FIT_DATA_POSITION_PROP, offset);
+
+	offset -= ALIGN(fdt_totalsize(fit), 4);
+
+	return fdt_setprop_inplace_u32(fit, img->node, FIT_DATA_OFFSET_PROP,
+				       offset);
+}
+
+/* Collect the images with external data used by a configuration */
+static int fit_read_find_images(const void *fit, int conf,
+				struct fit_read_image *imgs)
+{
+	int images, prop, node, count = 0;
+	const char *name, *uname;
+	int i, j, ret;
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (images < 0)
+		return images;
+
+	fdt_for_each_property_offset(prop, fit, conf) {
+		fdt_getprop_by_offset(fit, prop, &name, NULL);
+		for (i = 0;
+		     (uname = fdt_stringlist_get(fit, conf, name, i, NULL));
+		     i++) {
+			node = fdt_subnode_offset(fit, images, uname);
+			if (node < 0)
+				continue;
+			for (j = 0; j < count && imgs[j].node != node; j++)
+				;
+			if (j < count)
+				continue;
+			if (count == FIT_READ_MAX_IMAGES)
+				return -E2BIG;
+			imgs[count].node = node;
+			ret = fit_read_get_pos(fit, &imgs[count]);
+			if (ret < 0)
+				return ret;
+			if (ret)
+				count++;
+		}
+	}
+
+	return count;
+}
+
+int fit_read(struct fit_read_info *info, ulong addr, const char *conf_name,
+	     ulong *sizep)
+{
+	struct fit_read_image imgs[FIT_READ_MAX_IMAGES];
+	ulong hdr_size, total, end;
+	void *fit, *buf;
+	int conf, count, i, ret;
+
+	fit = map_sysmem(addr, sizeof(struct fdt_header));
+	ret = fit_read_data(info, 0, sizeof(struct fdt_header), fit);
+	if (ret)
+		return ret;
+	if (fdt_magic(fit) != FDT_MAGIC) {
+		log_err("Not a FIT\n");
+		return -ENOEXEC;
+	}
+	hdr_size = fdt_totalsize(fit);
+	if (hdr_size < sizeof(struct fdt_header))
+		return -ENOEXEC;
+	unmap_sysmem(fit);
+
+	fit = map_sysmem(addr, hdr_size);
+	ret = fit_read_data(info, sizeof(struct fdt_header),
+			    hdr_size - sizeof(struct fdt_header),
+			    fit + sizeof(struct fdt_header));
+	if (ret)
+		return ret;
+	fit_load_hash_update(addr, hdr_size);
+	if (fit_check_format(fit, hdr_size)) {
+		log_err("Bad FIT format\n");
+		return -ENOEXEC;
+	}
+
+	conf = fit_conf_get_node(fit, conf_name);
+	if (conf < 0) {
+		log_err("Configuration '%s' not found\n",
+			conf_name ? conf_name : "(default)");
+		return -ENOENT;
+	}
+	count = fit_read_find_images(fit, conf, imgs);
+	if (count < 0) {
+		log_err("Cannot find the images of the configuration (err=%d)\n",
+			count);
+		return count;
+	}
+
+	/* the part of memory used by a copy of the whole FIT, as far as read */
+	total = hdr_size;
+	for (i = 0; i < count; i++)
+		total = max(total, imgs[i].pos + imgs[i].size);
+	end = addr + total;
+
+	total = hdr_size;
+	for (i = 0; i < count; i++) {
+		struct fit_read_image *img = &imgs[i];
+
+		img->load = fit_read_to_load(fit, imgs, i, addr, end, &buf);
+		if (!img->load) {
+			buf = map_sysmem(addr + img->pos, img->size);
+			total = max(total, img->pos + img->size);
+		}
+		log_debug("%s: %lx bytes at %lx to %lx\n",
+			  fit_get_name(fit, img->node, NULL), img->size,
+			  img->pos, (ulong)map_to_sysmem(buf));
+
+		ret = fit_read_data(info, img->pos, img->size, buf);
+		if (ret) {
+			log_err("Cannot read image '%s' (err=%d)\n",
+				fit_get_name(fit, img->node, NULL), ret);
+			return ret;
+		}
+		fit_load_hash_update(map_to_sysmem(buf), img->size);
+		if (img->load) {
+			ret = fit_read_move(fit, img, buf);
+			if (ret)
+				return -EINVAL;
+		}
+	}
+	*sizep = total;
+
+	return 0;
+}
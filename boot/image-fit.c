@@ -642,6 +642,18 @@ int fit_get_timestamp(const void *fit, int noffset, time_t *timestamp)
 	return 0;
 }
 
+/* Find the /images or /configurations node, using the index if possible */
+static int fit_path_offset(const void *fit, const char *path)
+{
+	int node;
+
+	node = fit_index_path(fit, path);
+	if (node >= 0)
+		return node;
+
+	return fdt_path_offset(fit, path);
+}
+
 /**
  * fit_image_get_node - get node offset for component image of a given unit name
  * @fit: pointer to the FIT format image header
@@ -659,7 +671,11 @@ int fit_image_get_node(const void *fit, const char *image_uname)
 {
 	int noffset, images_noffset;
 
-	images_noffset = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	noffset = fit_index_image(fit, image_uname);
+	if (noffset >= 0)
+		return noffset;
+
+	images_noffset = fit_path_offset(fit, FIT_IMAGES_PATH);
 	if (images_noffset < 0) {
 		debug("Can't find images parent node '%s' (%s)\n",
 		      FIT_IMAGES_PATH, fdt_strerror(images_noffset));
@@ -1326,7 +1342,9 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	/* the data may have been hashed while it was loaded */
+	if (fit_load_hash_get(data, size, algo, value, &value_len) &&
+	    calculate_hash(data, size, algo, value, &value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1652,6 +1670,60 @@ static int fdt_check_no_at(const void *fit, int parent)
 	return 0;
 }
 
+/**
+ * fit_check_node() - Check a node of a FIT and its subnodes
+ *
+ * This does the checks of fit_check_format() for one part of the FIT, for
+ * use with CONFIG_FIT_CHECK_USED
+ *
+ * @fit: FIT to check
+ * @node: Node to check
+ * Return: 0 if OK, -EADDRNOTAVAIL if a node has a name containing '@' and
+ * signatures are enabled, -EINVAL if the node is not valid
+ */
+static int fit_check_node(const void *fit, int node)
+{
+	int offset, nextoffset = node;
+	const char *name;
+	int depth = 0;
+	uint32_t tag;
+	int len;
+
+	do {
+		offset = nextoffset;
+		tag = fdt_next_tag(fit, offset, &nextoffset);
+		if (nextoffset < 0)
+			return -EINVAL;
+
+		switch (tag) {
+		case FDT_NOP:
+			break;
+		case FDT_BEGIN_NODE:
+			depth++;
+			name = fdt_get_name(fit, offset, NULL);
+			if (!name)
+				return -EINVAL;
+			if (CONFIG_IS_ENABLED(FIT_SIGNATURE) &&
+			    strchr(name, '@'))
+				return -EADDRNOTAVAIL;
+			break;
+		case FDT_END_NODE:
+			if (!depth)
+				return -EINVAL;
+			depth--;
+			break;
+		case FDT_PROP:
+			if (!fdt_getprop_by_offset(fit, offset, &name, &len))
+				return -EINVAL;
+			break;
+		default:
+			return -EINVAL;
+		}
+	} while (depth);
+
+	return 0;
+}
+
 int fit_check_format(const void *fit, ulong size)
 {
 	int ret;
@@ -1664,7 +1736,37 @@ int fit_check_format(const void *fit, ulong size)
 		return -ENOEXEC;
 	}
 
-	if (CONFIG_IS_ENABLED(FIT_FULL_CHECK)) {
+	/*
+	 * An unchanged FIT which was checked before need not be checked again.
+	 * The index notices changes with a CRC32, which can be forged, so this
+	 * is not enough when the full check is wanted, e.g. for verified boot
+	 */
+	if (!CONFIG_IS_ENABLED(FIT_FULL_CHECK) &&
+	    !CONFIG_IS_ENABLED(FIT_SIGNATURE) &&
+	    (size == IMAGE_SIZE_INVAL || size >= fdt_totalsize(fit)) &&
+	    !fit_index_check(fit))
+		return 0;
+
+	if (CONFIG_IS_ENABLED(FIT_CHECK_USED)) {
+		/*
+		 * fit_image_load() checks the nodes it uses. Check here that
+		 * the top-level nodes have no unit address, as in
+		 * fdt_check_no_at()
+		 */
+		if (size != IMAGE_SIZE_INVAL && size < fdt_totalsize(fit))
+			return -EINVAL;
+		if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
+			int node;
+
+			fdt_for_each_subnode(node, fit, 0) {
+				const char *name = fdt_get_name(fit, node,
+								NULL);
+
+				if (!name || strchr(name, '@'))
+					return -EADDRNOTAVAIL;
+			}
+		}
+	} else if (CONFIG_IS_ENABLED(FIT_FULL_CHECK)) {
 		/*
 		 * If we are not given the size, make do wtih calculating it.
 		 * This is not as secure, so we should consider a flag to
@@ -1716,6 +1818,7 @@ int fit_check_format(const void *fit, ulong size)
 		log_debug("Wrong FIT format: no images parent node\n");
 		return -ENOENT;
 	}
+	fit_index_add(fit);
 
 	return 0;
 }
@@ -1729,8 +1832,12 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 	int best_match_offset = 0;
 	int best_match_pos = 0;
 
-	confs_noffset = fdt_path_offset(fit, FIT_CONFS_PATH);
-	images_noffset = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	noffset = fit_index_get_compat(fit, fdt);
+	if (noffset != -ENOENT)
+		return noffset;
+
+	confs_noffset = fit_path_offset(fit, FIT_CONFS_PATH);
+	images_noffset = fit_path_offset(fit, FIT_IMAGES_PATH);
 	if (confs_noffset < 0 || images_noffset < 0) {
 		debug("Can't find configurations or images nodes.\n");
 		return -1;
@@ -1816,8 +1923,9 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 	}
 	if (!best_match_offset) {
 		debug("No match found.\n");
-		return -1;
+		best_match_offset = -1;
 	}
+	fit_index_set_compat(fit, fdt, best_match_offset);
 
 	return best_match_offset;
 }
@@ -1829,7 +1937,7 @@ int fit_conf_get_node(const void *fit, const char *conf_uname)
 	const char *s;
 	char *conf_uname_copy = NULL;
 
-	confs_noffset = fdt_path_offset(fit, FIT_CONFS_PATH);
+	confs_noffset = fit_path_offset(fit, FIT_CONFS_PATH);
 	if (confs_noffset < 0) {
 		debug("Can't find configurations parent node '%s' (%s)\n",
 		      FIT_CONFS_PATH, fdt_strerror(confs_noffset));
@@ -2110,6 +2218,16 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 					BOOTSTAGE_SUB_NO_UNIT_NAME);
 			return -ENOENT;
 		}
+		if (CONFIG_IS_ENABLED(FIT_CHECK_USED)) {
+			ret = fit_check_node(fit, cfg_noffset);
+			if (ret) {
+				printf("Bad FIT configuration node (err=%d)\n",
+				       ret);
+				bootstage_error(bootstage_id +
+						BOOTSTAGE_SUB_FORMAT);
+				return ret;
+			}
+		}
 
 		fit_base_uname_config = fdt_get_name(fit, cfg_noffset, NULL);
 		printf("   Using '%s' configuration\n", fit_base_uname_config);
@@ -2119,7 +2237,10 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 
 		if (FIT_IMAGE_ENABLE_VERIFY && images->verify) {
 			puts("   Verifying Hash Integrity ... ");
-			if (fit_config_verify(fit, cfg_noffset)) {
+			bootstage_start(BOOTSTAGE_ID_ACCUM_VERIFY, "verify");
+			ret = fit_config_verify(fit, cfg_noffset);
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_VERIFY);
+			if (ret) {
 				puts("Bad Data Hash\n");
 				bootstage_error(bootstage_id +
 					BOOTSTAGE_SUB_HASH);
@@ -2139,10 +2260,21 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 		bootstage_error(bootstage_id + BOOTSTAGE_SUB_SUBNODE);
 		return -ENOENT;
 	}
+	if (CONFIG_IS_ENABLED(FIT_CHECK_USED)) {
+		ret = fit_check_node(fit, noffset);
+		if (ret) {
+			printf("Bad FIT %s image node (err=%d)\n", prop_name,
+			       ret);
+			bootstage_error(bootstage_id + BOOTSTAGE_SUB_FORMAT);
+			return ret;
+		}
+	}
 
 	printf("   Trying '%s' %s subimage\n", fit_uname, prop_name);
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_VERIFY, "verify");
 	ret = fit_image_select(fit, noffset, images->verify);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_VERIFY);
 	if (ret) {
 		bootstage_error(bootstage_id + BOOTSTAGE_SUB_HASH);
 		return ret;
@@ -55,6 +55,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
 
 #include <abuf.h>
+#include <bootstage.h>
 #include <bzlib.h>
 #include <display_options.h>
 #include <gzip.h>
@@ -62,6 +63,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #include <imximage.h>
 #include <relocate.h>
 #include <linux/lzo.h>
+#include <linux/sizes.h>
 #include <linux/zstd.h>
 #include <lzma/LzmaTypes.h>
 #include <lzma/LzmaDec.h>
@@ -461,6 +463,8 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 	 * this, image_len will be set to the number of uncompressed bytes
 	 * loaded, ret will be non-zero on error.
 	 */
+	if (comp != IH_COMP_NONE)
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decomp");
 	switch (comp) {
 	case IH_COMP_NONE:
 		ret = 0;
@@ -528,6 +532,8 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		}
 		break;
 	}
+	if (comp != IH_COMP_NONE)
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
 	if (ret == -ENOSYS) {
 		printf("Unimplemented compression type %d\n", comp);
 		return ret;
@@ -540,6 +546,69 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 	return 0;
 }
 
+/* Read a little-endian value of @len bytes, which may not be aligned */
+static uint64_t image_get_le(const uint8_t *p, int len)
+{
+	uint64_t val = 0;
+
+	while (len--)
+		val = val << 8 | p[len];
+
+	return val;
+}
+
+int image_decomp_size(int comp, const void *buf, ulong len, ulong *sizep)
+{
+	const uint8_t *p = buf;
+
+	switch (comp) {
+	case IH_COMP_GZIP:
+		/* the trailer has the size modulo 2^32 */
+		if (len < 18)
+			return -EINVAL;
+		*sizep = image_get_le(p + len - 4, 4);
+		return 0;
+	case IH_COMP_LZ4:
+		/* the frame header may have the size, after the FLG/BD bytes */
+		if (len < 15 || image_get_le(p, 4) != LZ4F_MAGIC)
+			return -EINVAL;
+		if (!(p[4] & 0x08))
+			return -ENOENT;
+		*sizep = image_get_le(p + 6, 8);
+		return 0;
+	case IH_COMP_ZSTD:
+		if (!tools_build() && CONFIG_IS_ENABLED(ZSTD)) {
+			zstd_frame_header hdr;
+
+			if (zstd_get_frame_header(&hdr, buf, len))
+				return -EINVAL;
+			if (hdr.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+				return -ENOENT;
+			*sizep = hdr.frameContentSize;
+			return 0;
+		}
+		break;
+	}
+
+	return -ENOSYS;
+}
+
+ulong image_decomp_margin(int comp, ulong size)
+{
+	/*
+	 * This is the bound used by Linux for decompressing itself in place:
+	 * 1/256 of the size plus the largest block, which is 128KB for zstd.
+	 * zstd may also put the literals of a block up to two blocks ahead
+	 * of the output, so allow for that.
+	 */
+	ulong margin = (size >> 8) + SZ_128K;
+
+	if (comp == IH_COMP_ZSTD)
+		margin += 2 * SZ_128K;
+
+	return ALIGN(margin, SZ_4K);
+}
+
 const table_entry_t *get_table_entry(const table_entry_t *table, int id)
 {
 	for (; table->id >= 0; ++table) {
@@ -11,8 +11,47 @@
 #include <common.h>
 #include <blk.h>
 #include <command.h>
+#include <image.h>
 #include <mapmem.h>
 
+/*
+ * Read blocks to memory. With FIT_HASH_ON_LOAD, a FIT is read in pieces so
+ * that its images are hashed while they are still in the cache.
+ */
+static ulong blk_common_read(struct blk_desc *desc, lbaint_t blk, ulong cnt,
+			     phys_addr_t paddr)
+{
+	ulong chunk = cnt, n = 0, got;
+	void *vaddr;
+
+#if CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD)
+	chunk = max_t(ulong, CONFIG_FIT_HASH_ON_LOAD_CHUNK / desc->blksz, 1);
+	fit_load_hash_start(paddr);
+#endif
+	while (n < cnt) {
+		if (!fit_load_hash_active())
+			chunk = cnt - n;
+		chunk = min(chunk, cnt - n);
+		vaddr = map_sysmem(paddr + n * desc->blksz,
+				   desc->blksz * chunk);
+		got = blk_dread(desc, blk + n, chunk, vaddr);
+		unmap_sysmem(vaddr);
+		if (got > chunk) {
+			/* error */
+			fit_load_hash_end(false, 0);
+			return got;
+		}
+		fit_load_hash_update(paddr + n * desc->blksz,
+				     got * desc->blksz);
+		n += got;
+		if (got != chunk)
+			break;
+	}
+	fit_load_hash_end(n == cnt, n * desc->blksz);
+
+	return n;
+}
+
 int blk_common_cmd(int argc, char *const argv[], enum uclass_id uclass_id,
 		   int *cur_devnump)
 {
@@ -68,7 +107,6 @@ int blk_common_cmd(int argc, char *const argv[], enum uclass_id uclass_id,
 			lbaint_t blk = hextoul(argv[3], NULL);
 			ulong cnt = hextoul(argv[4], NULL);
 			struct blk_desc *desc;
-			void *vaddr;
 			ulong n;
 			int ret;
 
@@ -78,9 +116,7 @@ int blk_common_cmd(int argc, char *const argv[], enum uclass_id uclass_id,
 			ret = blk_get_desc(uclass_id, *cur_devnump, &desc);
 			if (ret)
 				return CMD_RET_FAILURE;
-			vaddr = map_sysmem(paddr, desc->blksz * cnt);
-			n = blk_dread(desc, blk, cnt, vaddr);
-			unmap_sysmem(vaddr);
+			n = blk_common_read(desc, blk, cnt, paddr);
 
 			printf("%ld blocks read: %s\n", n,
 			       n == cnt ? "OK" : "ERROR");
@@ -172,6 +172,19 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		boot = true;
 	}
 
+	/* try the bootflow found during the autoboot countdown first */
+	if (IS_ENABLED(CONFIG_BOOTSTD_PREP) && boot && !menu && !dev &&
+	    !label) {
+		struct bootflow *prep_bflow = bootflow_prep_take();
+
+		if (prep_bflow) {
+			if (list)
+				printf("Booting prepared bootflow '%s'\n",
+				       prep_bflow->name);
+			bootflow_run_boot(NULL, prep_bflow);
+		}
+	}
+
 	std->cur_bootflow = NULL;
 
 	flags = 0;
@@ -58,6 +58,20 @@ static int do_cyclic_demo(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static void list_tasks(void)
+{
+#if CONFIG_IS_ENABLED(CYCLIC_TASK)
+	struct cyclic_task *task;
+
+	list_for_each_entry(task, cyclic_task_get_list(), sibling) {
+		printf("task: %s, cpu-time: %lld us, steps: %lld, %s\n",
+		       task->name, task->cpu_time_us, task->run_cnt,
+		       task->wq ? "waiting" : task->wake_us ? "sleeping" :
+		       "ready");
+	}
+#endif
+}
+
 static int do_cyclic_list(struct cmd_tbl *cmdtp, int flag, int argc,
 			  char *const argv[])
 {
@@ -72,13 +86,14 @@ static int do_cyclic_list(struct cmd_tbl *cmdtp, int flag, int argc,
 		       cyclic->name, cyclic->cpu_time_us,
 		       lldiv(freq, 100), do_div(freq, 100));
 	}
+	list_tasks();
 
 	return 0;
 }
 
 U_BOOT_LONGHELP(cyclic,
 	"demo <cycletime_ms> <delay_us> - register cyclic demo function\n"
-	"cyclic list - list cyclic functions\n");
+	"cyclic list - list cyclic functions and tasks\n");
 
 U_BOOT_CMD_WITH_SUBCMDS(cyclic, "Cyclic", cyclic_help_text,
 	U_BOOT_SUBCMD_MKENT(demo, 3, 1, do_cyclic_demo),
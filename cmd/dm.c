@@ -48,6 +48,38 @@ static int do_dm_dump_mem(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 #endif /* DM_STATS */
 
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+static int do_dm_dump_times(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	bool all = false, stash = false;
+	int ret;
+
+	for (; argc > 1; argc--, argv++) {
+		if (!strcmp(argv[1], "-a")) {
+			all = true;
+		} else if (!strcmp(argv[1], "-b")) {
+			stash = true;
+		} else {
+			printf("Unknown parameter: %s\n", argv[1]);
+			return CMD_RET_USAGE;
+		}
+	}
+
+	if (stash) {
+		ret = dm_stash_times();
+		if (ret) {
+			printf("Cannot write bloblist record (err=%d)\n", ret);
+			return CMD_RET_FAILURE;
+		}
+		return 0;
+	}
+	dm_dump_times(all);
+
+	return 0;
+}
+#endif
+
 static int do_dm_dump_static_driver_info(struct cmd_tbl *cmdtp, int flag,
 					 int argc, char * const argv[])
 {
@@ -112,12 +144,28 @@ static int do_dm_dump_uclass(struct cmd_tbl *cmdtp, int flag, int argc,
 #define DM_MEM
 #endif
 
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+#define DM_PROBE_STATS_HELP	"dm probe-stats   Same as 'dm times'\n"
+#define DM_PROBE_STATS	U_BOOT_SUBCMD_MKENT(probe-stats, 3, 1, \
+					    do_dm_dump_times),
+#define DM_TIMES_HELP	"dm times [-a][-b]  Show time, memory and probe state of each device\n" \
+			"                 (-a=include unprobed, -b=write bloblist record)\n"
+#define DM_TIMES	U_BOOT_SUBCMD_MKENT(times, 3, 1, do_dm_dump_times),
+#else
+#define DM_PROBE_STATS_HELP
+#define DM_PROBE_STATS
+#define DM_TIMES_HELP
+#define DM_TIMES
+#endif
+
 U_BOOT_LONGHELP(dm,
 	"compat        Dump list of drivers with compatibility strings\n"
 	"dm devres        Dump list of device resources for each device\n"
 	"dm drivers       Dump list of drivers with uclass and instances\n"
 	DM_MEM_HELP
+	DM_PROBE_STATS_HELP
 	"dm static        Dump list of drivers with static platform data\n"
+	DM_TIMES_HELP
 	"dm tree [-s][-e][name]   Dump tree of driver model devices (-s=sort)\n"
 	"dm uclass [-e][name]     Dump list of instances for each uclass");
 
@@ -126,6 +174,8 @@ U_BOOT_CMD_WITH_SUBCMDS(dm, "Driver model low level access", dm_help_text,
 	U_BOOT_SUBCMD_MKENT(devres, 1, 1, do_dm_dump_devres),
 	U_BOOT_SUBCMD_MKENT(drivers, 1, 1, do_dm_dump_drivers),
 	DM_MEM
+	DM_PROBE_STATS
 	U_BOOT_SUBCMD_MKENT(static, 1, 1, do_dm_dump_static_driver_info),
+	DM_TIMES
 	U_BOOT_SUBCMD_MKENT(tree, 4, 1, do_dm_dump_tree),
 	U_BOOT_SUBCMD_MKENT(uclass, 3, 1, do_dm_dump_uclass));
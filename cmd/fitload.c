@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Loading only the used parts of a FIT with external data
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <bootstage.h>
+#include <command.h>
+#include <env.h>
+#include <fs.h>
+#include <image.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <memalign.h>
+#include <part.h>
+#include <linux/errno.h>
+
+/* Size of the buffer for reads which are not block-aligned */
+#define FITLOAD_BOUNCE_SIZE	(64 * 1024)
+
+struct fitload_fs {
+	const char *ifname;
+	const char *dev_part;
+	const char *filename;
+};
+
+struct fitload_blk {
+	struct blk_desc *desc;
+	lbaint_t start;
+	lbaint_t count;
+	u8 *bounce;
+};
+
+static long fitload_fs_read(struct fit_read_info *info, ulong pos, ulong size,
+			    void *buf)
+{
+	struct fitload_fs *priv = info->priv;
+	loff_t actread;
+	int ret;
+
+	/* each filesystem operation needs the device to be set again */
+	if (fs_set_blk_dev(priv->ifname, priv->dev_part, FS_TYPE_ANY))
+		return -ENODEV;
+	ret = fs_read(priv->filename, map_to_sysmem(buf), pos, size, &actread);
+	if (ret)
+		return -EIO;
+
+	return actread;
+}
+
+static long fitload_blk_read(struct fit_read_info *info, ulong pos, ulong size,
+			     void *buf)
+{
+	struct fitload_blk *priv = info->priv;
+	ulong blksz = priv->desc->blksz;
+	lbaint_t blk = priv->start + pos / blksz;
+	ulong skip = pos % blksz;
+	ulong done = 0, bounce_blks = FITLOAD_BOUNCE_SIZE / blksz;
+	lbaint_t cnt;
+	ulong n;
+
+	if ((u64)pos + size > (u64)priv->count * blksz)
+		return -ENOSPC;
+
+	while (done < size) {
+		if (!skip && size - done >= blksz &&
+		    IS_ALIGNED((ulong)buf + done, ARCH_DMA_MINALIGN)) {
+			/* read whole blocks straight to their place */
+			cnt = (size - done) / blksz;
+			if (blk_dread(priv->desc, blk, cnt, buf + done) != cnt)
+				return -EIO;
+			n = cnt * blksz;
+		} else {
+			cnt = min_t(lbaint_t, bounce_blks,
+				    DIV_ROUND_UP(skip + size - done, blksz));
+			if (blk_dread(priv->desc, blk, cnt, priv->bounce) != cnt)
+				return -EIO;
+			n = min(cnt * blksz - skip, size - done);
+			memcpy(buf + done, priv->bounce + skip, n);
+			skip = 0;
+		}
+		blk += cnt;
+		done += n;
+	}
+
+	return size;
+}
+
+static int do_fitload(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	struct fit_read_info info;
+	struct fitload_fs fs;
+	struct fitload_blk blk;
+	struct disk_partition part;
+	const char *conf_name;
+	ulong addr, size, time;
+	bool is_fs;
+	int ret;
+
+	if (argc < 5)
+		return CMD_RET_USAGE;
+	is_fs = !strcmp(argv[1], "fs");
+	if (!is_fs && strcmp(argv[1], "blk"))
+		return CMD_RET_USAGE;
+	if (argc > (is_fs ? 7 : 6))
+		return CMD_RET_USAGE;
+	addr = hextoul(argv[4], NULL);
+	conf_name = argc > (is_fs ? 6 : 5) ? argv[argc - 1] : NULL;
+
+	if (is_fs) {
+		if (argc < 6)
+			return CMD_RET_USAGE;
+		fs.ifname = argv[2];
+		fs.dev_part = argv[3];
+		fs.filename = argv[5];
+		info.priv = &fs;
+		info.read = fitload_fs_read;
+	} else {
+		if (blk_get_device_part_str(argv[2], argv[3], &blk.desc, &part,
+					    1) < 0)
+			return CMD_RET_FAILURE;
+		blk.start = part.start;
+		blk.count = part.size;
+		blk.bounce = memalign(ARCH_DMA_MINALIGN,
+				      max_t(ulong, FITLOAD_BOUNCE_SIZE,
+					    blk.desc->blksz));
+		if (!blk.bounce)
+			return CMD_RET_FAILURE;
+		info.priv = &blk;
+		info.read = fitload_blk_read;
+	}
+
+	time = get_timer(0);
+	bootstage_start(BOOTSTAGE_ID_ACCUM_LOAD, "load");
+	ret = fit_read(&info, addr, conf_name, &size);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_LOAD);
+	time = get_timer(time);
+	if (!is_fs)
+		free(blk.bounce);
+	if (ret) {
+		printf("Failed to load FIT (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+	printf("FIT loaded in %lu ms\n", time);
+
+	image_load_addr = addr;
+	env_set_hex("fileaddr", addr);
+	env_set_hex("filesize", size);
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	fitload, 7, 0, do_fitload,
+	"load the parts of a FIT used by a configuration",
+	"fs <interface> <dev[:part]> <addr> <filename> [<config>]\n"
+	"    - load from a file\n"
+	"fitload blk <interface> <dev[:part]> <addr> [<config>]\n"
+	"    - load from the start of a partition or device"
+);
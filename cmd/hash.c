@@ -26,6 +26,14 @@ static int do_hash(struct cmd_tbl *cmdtp, int flag, int argc,
 	char *s;
 	int flags = HASH_FLAG_ENV;
 
+	if (IS_ENABLED(CONFIG_CMD_HASH_BENCH) && argc >= 4 &&
+	    !strcmp(argv[1], "bench")) {
+		if (hash_bench(argc > 4 ? argv[4] : NULL,
+			       hextoul(argv[2], NULL), hextoul(argv[3], NULL)))
+			return CMD_RET_FAILURE;
+		return 0;
+	}
+
 	if (argc < (HARGS - 1))
 		return CMD_RET_USAGE;
 
@@ -54,4 +62,8 @@ U_BOOT_CMD(
 		"    - verify message digest of memory area to immediate value, \n"
 		"      env var or *address"
 #endif
+#if IS_ENABLED(CONFIG_CMD_HASH_BENCH)
+	"\nhash bench address count [algorithm]\n"
+		"    - measure the speed of one or all algorithms"
+#endif
 );
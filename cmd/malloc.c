@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show information about malloc()
+ */
+
+#include <common.h>
+#include <command.h>
+#include <display_options.h>
+#include <malloc.h>
+
+static int do_malloc_info(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	printf("Heap:     %08lx-%08lx, ", mem_malloc_start, mem_malloc_end);
+	print_size(mem_malloc_end - mem_malloc_start, "\n");
+	printf("Top:      %08lx, ", mem_malloc_brk);
+	print_size(mem_malloc_brk - mem_malloc_start, " taken by dlmalloc\n");
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+	malloc_trace_info();
+#endif
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+	printf("\n");
+	malloc_pool_info();
+#endif
+
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+static int do_malloc_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	bool since_mark = false;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "-m"))
+			return CMD_RET_USAGE;
+		since_mark = true;
+	}
+	if (malloc_trace_dump(since_mark)) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_malloc_mark(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	malloc_trace_mark();
+
+	return 0;
+}
+#endif
+
+U_BOOT_LONGHELP(malloc,
+	"info - show heap usage and the usage of each pool\n"
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+	"malloc dump [-m] - show live allocations by caller\n"
+	"   -m - only show those made since the last 'malloc mark'\n"
+	"malloc mark - note the time and reset the high-water mark\n"
+#endif
+	);
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "Show malloc() information", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(info, 1, 1, do_malloc_info),
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+	U_BOOT_SUBCMD_MKENT(dump, 2, 1, do_malloc_dump),
+	U_BOOT_SUBCMD_MKENT(mark, 1, 1, do_malloc_mark),
+#endif
+	);
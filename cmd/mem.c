@@ -21,6 +21,7 @@
 #include <flash.h>
 #endif
 #include <hash.h>
+#include <image.h>
 #include <log.h>
 #include <mapmem.h>
 #include <rand.h>
@@ -177,6 +178,7 @@ static int do_mem_mw(struct cmd_tbl *cmdtp, int flag, int argc,
 		buf += size;
 	}
 	unmap_sysmem(start);
+	fit_load_hash_forget(addr, bytes);
 	return 0;
 }
 
@@ -360,6 +362,7 @@ static int do_mem_cp(struct cmd_tbl *cmdtp, int flag, int argc,
 #endif
 
 	memmove(dst, src, count * size);
+	fit_load_hash_forget(dest, count * size);
 
 	unmap_sysmem(src);
 	unmap_sysmem(dst);
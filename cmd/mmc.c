@@ -9,6 +9,7 @@
 #include <command.h>
 #include <console.h>
 #include <display_options.h>
+#include <image.h>
 #include <memalign.h>
 #include <mmc.h>
 #include <part.h>
@@ -366,6 +367,7 @@ static int do_mmc_read(struct cmd_tbl *cmdtp, int flag,
 	       curr_device, blk, cnt);
 
 	n = blk_dread(mmc_get_blk_desc(mmc), blk, cnt, addr);
+	fit_load_hash_forget((ulong)addr, cnt * mmc_get_blk_desc(mmc)->blksz);
 	printf("%d blocks read: %s\n", n, (n == cnt) ? "OK" : "ERROR");
 
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
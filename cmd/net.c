@@ -11,6 +11,7 @@
  */
 #include <common.h>
 #include <bootstage.h>
+#include <blk.h>
 #include <command.h>
 #include <dm.h>
 #include <dm/devres.h>
@@ -19,9 +20,14 @@
 #include <log.h>
 #include <net.h>
 #include <net6.h>
+#include <part.h>
+#include <spi_flash.h>
 #include <net/udp.h>
 #include <net/sntp.h>
 #include <net/ncsi.h>
+#include <net/pktbuf.h>
+#include <net/sink.h>
+#include <net/wget.h>
 
 static int netboot_common(enum proto_t, struct cmd_tbl *, int, char * const []);
 
@@ -198,13 +204,31 @@ U_BOOT_CMD(
 #if defined(CONFIG_CMD_WGET)
 static int do_wget(struct cmd_tbl *cmdtp, int flag, int argc, char * const argv[])
 {
+	ulong start = 0, end = 0;
+	char *ep;
+
+	if (argc > 2 && !strcmp(argv[1], "-r")) {
+		start = hextoul(argv[2], &ep);
+		if (*ep != '-')
+			return CMD_RET_USAGE;
+		if (ep[1]) {
+			end = hextoul(ep + 1, &ep);
+			if (*ep || end < start)
+				return CMD_RET_USAGE;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+	wget_set_range(start, end);
+
 	return netboot_common(WGET, cmdtp, argc, argv);
 }
 
 U_BOOT_CMD(
-	wget,   3,      1,      do_wget,
+	wget,   5,      1,      do_wget,
 	"boot image via network using HTTP protocol",
-	"[loadAddress] [[hostIPaddr:]path and image name]"
+	"[-r start-[end]] [loadAddress] [[hostIPaddr:]path and image name]\n"
+	"    - -r: fetch only the given byte range (hex) of the file"
 );
 #endif
 
@@ -387,7 +411,7 @@ static int netboot_common(enum proto_t proto, struct cmd_tbl *cmdtp, int argc,
 {
 	char *s;
 	int   rcode = 0;
-	int   size;
+	ulong size;
 
 	net_boot_file_name_explicit = false;
 	*net_boot_file_name = '\0';
@@ -428,8 +452,7 @@ static int netboot_common(enum proto_t proto, struct cmd_tbl *cmdtp, int argc,
 		}
 	}
 
-	size = net_loop(proto);
-	if (size < 0) {
+	if (net_loop_size(proto, &size) < 0) {
 		bootstage_error(BOOTSTAGE_ID_NET_NETLOOP_OK);
 		return CMD_RET_FAILURE;
 	}
@@ -677,6 +700,99 @@ U_BOOT_CMD(
 
 #endif  /* CONFIG_CMD_LINK_LOCAL */
 
+#if defined(CONFIG_NET_SINK)
+static int netsink_blk(int argc, char *const argv[], bool gz)
+{
+	struct blk_desc *desc;
+	struct disk_partition info;
+	u64 start;
+	int ret;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+	if (blk_get_device_part_str(argv[1], argv[2], &desc, &info, 1) < 0)
+		return CMD_RET_FAILURE;
+	start = (u64)info.start * desc->blksz +
+		simple_strtoull(argv[3], NULL, 16);
+
+	if (gz && IS_ENABLED(CONFIG_CMD_UNZIP))
+		ret = net_sink_gzwrite(desc, start);
+	else if (!gz)
+		ret = net_sink_blk(desc, start);
+	else
+		return CMD_RET_USAGE;
+	if (ret) {
+		printf("Cannot stream to %s %s (err=%d)\n", argv[1], argv[2],
+		       ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+#if defined(CONFIG_SPI_FLASH)
+static int netsink_sf(int argc, char *const argv[])
+{
+	struct spi_flash *flash;
+	int ret;
+
+	if (argc != 2)
+		return CMD_RET_USAGE;
+	flash = spi_flash_probe(CONFIG_SF_DEFAULT_BUS, CONFIG_SF_DEFAULT_CS,
+				CONFIG_SF_DEFAULT_SPEED, CONFIG_SF_DEFAULT_MODE);
+	if (!flash) {
+		printf("Failed to initialize SPI flash\n");
+		return CMD_RET_FAILURE;
+	}
+	ret = net_sink_sf(flash, hextoul(argv[1], NULL));
+	if (ret) {
+		printf("Cannot stream to SPI flash (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+static int do_netsink(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	if (argc < 2) {
+		printf("Downloads %s\n", net_sink_active() ?
+		       "are streamed to storage" : "go to memory");
+		return CMD_RET_SUCCESS;
+	}
+
+	if (IS_ENABLED(CONFIG_BLK) && !strcmp(argv[1], "blk"))
+		return netsink_blk(argc - 1, argv + 1, false);
+	if (IS_ENABLED(CONFIG_BLK) && !strcmp(argv[1], "gz"))
+		return netsink_blk(argc - 1, argv + 1, true);
+#if defined(CONFIG_SPI_FLASH)
+	if (!strcmp(argv[1], "sf"))
+		return netsink_sf(argc - 1, argv + 1);
+#endif
+	if (!strcmp(argv[1], "off")) {
+		net_sink_clear();
+		return CMD_RET_SUCCESS;
+	}
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	netsink,	5,	0,	do_netsink,
+	"stream the next network download to storage",
+	"blk <interface> <dev[:part]> <offset>\n"
+	"    - write the download to a block device, at a hex byte offset\n"
+	"netsink gz <interface> <dev[:part]> <offset>\n"
+	"    - decompress a gzip download to a block device\n"
+	"netsink sf <offset>\n"
+	"    - erase and write SPI flash\n"
+	"netsink off - store the next download in memory again\n"
+	"netsink - show where downloads go"
+);
+#endif  /* CONFIG_NET_SINK */
+
 static int do_net_list(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	const struct udevice *current = eth_get_dev();
@@ -741,9 +857,25 @@ err_free_strings:
 	return CMD_RET_FAILURE;
 }
 
+static int do_net_pool(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
+{
+	struct pktbuf_stats stats;
+
+	pktbuf_get_stats(&stats);
+	printf("Packet buffers: %d x %d bytes, headroom %d\n", stats.total,
+	       stats.size, stats.headroom);
+	printf("  in use: %d\n", stats.in_use);
+	printf("  peak: %d\n", stats.peak);
+	printf("  allocations: %lu\n", stats.allocs);
+	printf("  failures: %lu\n", stats.fails);
+
+	return CMD_RET_SUCCESS;
+}
+
 static struct cmd_tbl cmd_net[] = {
 	U_BOOT_CMD_MKENT(list, 1, 0, do_net_list, "", ""),
 	U_BOOT_CMD_MKENT(stats, 2, 0, do_net_stats, "", ""),
+	U_BOOT_CMD_MKENT(pool, 1, 0, do_net_pool, "", ""),
 };
 
 static int do_net(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
@@ -769,6 +901,7 @@ U_BOOT_CMD(
 	"NET sub-system",
 	"list - list available devices\n"
 	"stats <device> - dump statistics for specified device\n"
+	"pool - show usage of the packet buffer pool\n"
 );
 
 #if defined(CONFIG_CMD_NCSI)
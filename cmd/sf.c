@@ -10,6 +10,7 @@
 #include <display_options.h>
 #include <div64.h>
 #include <dm.h>
+#include <image.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
@@ -317,10 +318,12 @@ static int do_spi_flash_read_write(int argc, char *const argv[])
 		int read;
 
 		read = strncmp(argv[0], "read", 4) == 0;
-		if (read)
+		if (read) {
 			ret = spi_flash_read(flash, offset, len, buf);
-		else
+			fit_load_hash_forget(addr, len);
+		} else {
 			ret = spi_flash_write(flash, offset, len, buf);
+		}
 
 		printf("SF: %zu bytes @ %#x %s: ", (size_t)len, (u32)offset,
 		       read ? "Read" : "Written");
@@ -5,33 +5,77 @@
  */
 
 #include <common.h>
+#include <abuf.h>
 #include <command.h>
 #include <env.h>
 #include <gzip.h>
 #include <mapmem.h>
 #include <part.h>
+#include <linux/zstd.h>
+#include <asm/unaligned.h>
+
+/* Check for a Zstandard frame, which unzip also accepts */
+static bool unzip_is_zstd(const void *src)
+{
+	return CONFIG_IS_ENABLED(ZSTD) &&
+		get_unaligned_le32(src) == ZSTD_MAGICNUMBER;
+}
 
 static int do_unzip(struct cmd_tbl *cmdtp, int flag, int argc,
 		    char *const argv[])
 {
 	unsigned long src, dst;
 	unsigned long src_len = ~0UL, dst_len = ~0UL;
+	u64 offset = 0;
+	bool seek = false;
+	int ret;
 
-	switch (argc) {
-		case 4:
-			dst_len = hextoul(argv[3], NULL);
-			/* fall through */
-		case 3:
-			src = hextoul(argv[1], NULL);
-			dst = hextoul(argv[2], NULL);
-			break;
-		default:
+	if (argc > 2 && !strcmp(argv[1], "-o")) {
+		offset = simple_strtoull(argv[2], NULL, 16);
+		seek = true;
+		argc -= 2;
+		argv += 2;
+	}
+
+	/* a seek parses member headers, so it must know where the data ends */
+	if (seek) {
+		if (argc != 4 && argc != 5)
 			return CMD_RET_USAGE;
+		src = hextoul(argv[1], NULL);
+		src_len = hextoul(argv[2], NULL);
+		dst = hextoul(argv[3], NULL);
+		if (argc == 5)
+			dst_len = hextoul(argv[4], NULL);
+	} else if (argc == 3 || argc == 4) {
+		src = hextoul(argv[1], NULL);
+		dst = hextoul(argv[2], NULL);
+		if (argc == 4)
+			dst_len = hextoul(argv[3], NULL);
+	} else {
+		return CMD_RET_USAGE;
 	}
 
-	if (gunzip(map_sysmem(dst, dst_len), dst_len, map_sysmem(src, 0),
-		   &src_len) != 0)
+	if (seek) {
+		ret = gzip_read(map_sysmem(src, src_len), src_len, offset,
+				map_sysmem(dst, dst_len), &dst_len);
+		if (ret) {
+			printf("Cannot read at %llx (err=%d)\n", offset, ret);
+			return 1;
+		}
+		src_len = dst_len;
+	} else if (unzip_is_zstd(map_sysmem(src, 0))) {
+		struct abuf in, out;
+
+		abuf_init_set(&in, map_sysmem(src, 0), src_len);
+		abuf_init_set(&out, map_sysmem(dst, dst_len), dst_len);
+		ret = zstd_decompress(&in, &out);
+		if (ret < 0)
+			return 1;
+		src_len = ret;
+	} else if (gunzip(map_sysmem(dst, dst_len), dst_len, map_sysmem(src, 0),
+			  &src_len) != 0) {
 		return 1;
+	}
 
 	printf("Uncompressed size: %lu = 0x%lX\n", src_len, src_len);
 	env_set_hex("filesize", src_len);
@@ -40,9 +84,13 @@ static int do_unzip(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 
 U_BOOT_CMD(
-	unzip,	4,	1,	do_unzip,
+	unzip,	7,	1,	do_unzip,
 	"unzip a memory region",
-	"srcaddr dstaddr [dstsize]"
+	"srcaddr dstaddr [dstsize]\n"
+	"\tgzip data, or Zstandard data if supported\n"
+	"unzip -o offset srcaddr srcsize dstaddr [dstsize]\n"
+	"\tread from offset (hex) of the uncompressed data of an indexed\n"
+	"\tgzip file of srcsize bytes, decompressing only what is needed"
 );
 
 static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
@@ -55,6 +103,24 @@ static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 	unsigned long writebuf = 1<<20;
 	u64 startoffs = 0;
 	u64 szexpected = 0;
+	ulong resume = 0;
+	uint flags = 0;
+
+	while (argc > 1 && argv[1][0] == '-') {
+		if (!strcmp(argv[1], "-s")) {
+			flags |= GZWRITE_SKIP_ZERO;
+		} else if (!strcmp(argv[1], "-e")) {
+			flags |= GZWRITE_ERASE_ZERO;
+		} else if (!strcmp(argv[1], "-r") && argc > 2) {
+			resume = hextoul(argv[2], NULL);
+			argc--;
+			argv++;
+		} else {
+			return CMD_RET_USAGE;
+		}
+		argc--;
+		argv++;
+	}
 
 	if (argc < 5)
 		return CMD_RET_USAGE;
@@ -62,8 +128,8 @@ static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 	if (ret < 0)
 		return CMD_RET_FAILURE;
 
-	addr = (unsigned char *)hextoul(argv[3], NULL);
 	length = hextoul(argv[4], NULL);
+	addr = map_sysmem(hextoul(argv[3], NULL), length);
 
 	if (5 < argc) {
 		writebuf = hextoul(argv[5], NULL);
@@ -75,19 +141,72 @@ static int do_gzwrite(struct cmd_tbl *cmdtp, int flag,
 		}
 	}
 
-	ret = gzwrite(addr, length, bdev, writebuf, startoffs, szexpected);
+	ret = gzwrite_resume(addr, length, bdev, writebuf, startoffs,
+			     szexpected, flags, resume);
 
 	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
 }
 
 U_BOOT_CMD(
-	gzwrite, 8, 0, do_gzwrite,
+	gzwrite, 12, 0, do_gzwrite,
 	"unzip and write memory to block device",
-	"<interface> <dev> <addr> length [wbuf=1M [offs=0 [outsize=0]]]\n"
+	"[-s | -e] [-r resume] <interface> <dev> <addr> length [wbuf=1M [offs=0 [outsize=0]]]\n"
+	"\t-s skips blocks of zeroes, for a device which is already zeroed\n"
+	"\t-e erases blocks of zeroes, for a device reading erased blocks as zero\n"
+	"\t-r resumes an interrupted write at offset (hex) of the output;\n"
+	"\t\tthis needs an indexed gzip file, see tools/pgzip.py\n"
 	"\twbuf is the size in bytes (hex) of write buffer\n"
 	"\t\tand should be padded to erase size for SSDs\n"
 	"\toffs is the output start offset in bytes (hex)\n"
 	"\toutsize is the size of the expected output (hex bytes)\n"
 	"\t\tand is required for files with uncompressed lengths\n"
-	"\t\t4 GiB or larger\n"
+	"\t\t4 GiB or larger, or made of several members without an index\n"
+);
+
+#if CONFIG_IS_ENABLED(ZSTD)
+static int do_zstdwrite(struct cmd_tbl *cmdtp, int flag,
+			int argc, char *const argv[])
+{
+	struct blk_desc *bdev;
+	int ret;
+	ulong addr;
+	ulong length;
+	ulong writebuf = 1 << 20;
+	u64 startoffs = 0;
+	u64 szexpected = 0;
+
+	if (argc < 5)
+		return CMD_RET_USAGE;
+	ret = blk_get_device_by_str(argv[1], argv[2], &bdev);
+	if (ret < 0)
+		return CMD_RET_FAILURE;
+
+	addr = hextoul(argv[3], NULL);
+	length = hextoul(argv[4], NULL);
+
+	if (5 < argc) {
+		writebuf = hextoul(argv[5], NULL);
+		if (6 < argc) {
+			startoffs = simple_strtoull(argv[6], NULL, 16);
+			if (7 < argc)
+				szexpected = simple_strtoull(argv[7],
+							     NULL, 16);
+		}
+	}
+
+	ret = zstd_write(map_sysmem(addr, length), length, bdev, writebuf,
+			 startoffs, szexpected);
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	zstdwrite, 8, 0, do_zstdwrite,
+	"decompress Zstandard data and write it to block device",
+	"<interface> <dev> <addr> length [wbuf=1M [offs=0 [outsize=0]]]\n"
+	"\twbuf is the size in bytes (hex) of write buffer\n"
+	"\toffs is the output start offset in bytes (hex)\n"
+	"\toutsize is the size of the expected output (hex bytes),\n"
+	"\t\tby default the sizes recorded in the frames\n"
 );
+#endif
@@ -6,6 +6,7 @@
 
 #include <common.h>
 #include <autoboot.h>
+#include <bootflow.h>
 #include <bootretry.h>
 #include <cli.h>
 #include <command.h>
@@ -426,6 +427,29 @@ static int abortboot(int bootdelay)
 	return abort;
 }
 
+/**
+ * abortboot_prep() - Count down to autoboot, preparing to boot meanwhile
+ *
+ * With CONFIG_BOOTSTD_PREP, bootdevs are set up and scanned in the background
+ * while waiting for a key. This is stopped if the countdown is interrupted.
+ *
+ * @bootdelay: Delay in seconds
+ * Return: 1 if the countdown was interrupted, 0 if not
+ */
+static int abortboot_prep(int bootdelay)
+{
+	bool prep = false;
+	int abort;
+
+	if (IS_ENABLED(CONFIG_BOOTSTD_PREP) && bootdelay > 0)
+		prep = !bootflow_prep_start();
+	abort = abortboot(bootdelay);
+	if (prep)
+		bootflow_prep_finish(abort);
+
+	return abort;
+}
+
 static void process_fdt_options(void)
 {
 #ifdef CONFIG_TEXT_BASE
@@ -489,7 +513,8 @@ void autoboot_command(const char *s)
 	debug("### main_loop: bootcmd=\"%s\"\n", s ? s : "<UNDEFINED>");
 
 	if (s && (stored_bootdelay == -2 ||
-		 (stored_bootdelay != -1 && !abortboot(stored_bootdelay)))) {
+		 (stored_bootdelay != -1 &&
+		  !abortboot_prep(stored_bootdelay)))) {
 		bool lock;
 		int prev;
 		int ret;
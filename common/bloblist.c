@@ -62,6 +62,8 @@ static struct tag_name {
 	{ BLOBLISTT_U_BOOT_SPL_HANDOFF, "SPL hand-off" },
 	{ BLOBLISTT_VBE, "VBE" },
 	{ BLOBLISTT_U_BOOT_VIDEO, "SPL video handoff" },
+	{ BLOBLISTT_U_BOOT_LIVE_TREE, "SPL live tree" },
+	{ BLOBLISTT_U_BOOT_DM_TIMES, "DM device stats" },
 
 	/* BLOBLISTT_VENDOR_AREA */
 };
@@ -367,7 +367,9 @@ static int initr_flash(void)
 static int initr_nand(void)
 {
 	puts("NAND:  ");
+	bootstage_start(BOOTSTAGE_ID_ACCUM_STORAGE, "storage");
 	nand_init();
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_STORAGE);
 	printf("%lu MiB\n", nand_size() / 1024);
 	return 0;
 }
@@ -387,7 +389,9 @@ static int initr_onenand(void)
 static int initr_mmc(void)
 {
 	puts("MMC:   ");
+	bootstage_start(BOOTSTAGE_ID_ACCUM_STORAGE, "storage");
 	mmc_initialize(gd->bd);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_STORAGE);
 	return 0;
 }
 #endif
@@ -426,10 +430,12 @@ static int should_load_env(void)
 static int initr_env(void)
 {
 	/* initialize environment */
+	bootstage_start(BOOTSTAGE_ID_ACCUM_ENV, "env");
 	if (should_load_env())
 		env_relocate();
 	else
 		env_set_default(NULL, 0);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_ENV);
 
 	env_import_fdt();
 
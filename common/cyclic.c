@@ -96,6 +96,7 @@ void cyclic_run(void)
 			}
 		}
 	}
+	cyclic_task_run();
 	gd->flags &= ~GD_FLG_CYCLIC_RUNNING;
 }
 
@@ -118,6 +119,7 @@ int cyclic_unregister_all(void)
 	struct cyclic_info *cyclic;
 	struct hlist_node *tmp;
 
+	cyclic_task_stop_all();
 	hlist_for_each_entry_safe(cyclic, tmp, cyclic_get_list(), list)
 		cyclic_unregister(cyclic);
 
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cooperative tasks run from schedule()
+ *
+ * A task is a function which does its work in short steps, returning between
+ * them when it has to wait for a time or for a wait queue. Each time
+ * cyclic_run() is called, the next step of each task which is ready is run,
+ * so several tasks can make progress while the main flow of U-Boot waits, e.g.
+ * in udelay() or while polling for a key.
+ *
+ * Tasks have no stack of their own, so this works the same on every
+ * architecture. The list of tasks is a static variable, so tasks can only be
+ * started after relocation.
+ */
+
+#include <common.h>
+#include <cyclic.h>
+#include <log.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <linux/list.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static LIST_HEAD(task_list);
+
+/* Number of times the tasks have been run, used to poll each queue once */
+static ulong task_runs;
+
+struct list_head *cyclic_task_get_list(void)
+{
+	return &task_list;
+}
+
+int cyclic_task_start(struct cyclic_task *task, cyclic_task_func_t func,
+		      const char *name, void *ctx)
+{
+	if (!(gd->flags & GD_FLG_RELOC))
+		return -EPERM;
+
+	memset(task, '\0', sizeof(*task));
+	task->func = func;
+	task->ctx = ctx;
+	task->name = name;
+	task->start_time_us = timer_get_us();
+	list_add_tail(&task->sibling, &task_list);
+
+	return 0;
+}
+
+int cyclic_task_yield(struct cyclic_task *task)
+{
+	task->wq = NULL;
+	task->wake_us = 0;
+	task->timed_out = false;
+
+	return CYCLIC_TASK_WAIT;
+}
+
+int cyclic_task_sleep(struct cyclic_task *task, uint64_t delay_us)
+{
+	cyclic_task_yield(task);
+	task->wake_us = (timer_get_us() + delay_us) ? : 1;
+
+	return CYCLIC_TASK_WAIT;
+}
+
+int cyclic_task_wait(struct cyclic_task *task, struct cyclic_waitq *wq,
+		     uint64_t timeout_us)
+{
+	cyclic_task_yield(task);
+	task->wq = wq;
+	task->wait_seq = wq->seq;
+	if (timeout_us)
+		task->wake_us = (timer_get_us() + timeout_us) ? : 1;
+
+	return CYCLIC_TASK_WAIT;
+}
+
+void cyclic_task_wake(struct cyclic_waitq *wq)
+{
+	wq->seq++;
+}
+
+void cyclic_task_cancel(struct cyclic_task *task)
+{
+	task->cancel = true;
+}
+
+static void task_finish(struct cyclic_task *task, int ret)
+{
+	list_del(&task->sibling);
+	task->wq = NULL;
+	task->ret = ret;
+	task->done = true;
+	log_debug("task %s done, ret %d\n", task->name, ret);
+}
+
+int cyclic_task_join(struct cyclic_task *task, uint64_t timeout_us)
+{
+	uint64_t start;
+
+	if (gd->flags & GD_FLG_CYCLIC_RUNNING)
+		return -EDEADLK;
+
+	start = timer_get_us();
+	while (!task->done) {
+		if (timeout_us && timer_get_us() - start >= timeout_us)
+			return -ETIMEDOUT;
+		schedule();
+	}
+
+	return task->ret;
+}
+
+/* Check if a task should run now, polling its queue if needed */
+static bool task_ready(struct cyclic_task *task, uint64_t now)
+{
+	struct cyclic_waitq *wq = task->wq;
+
+	if (task->cancel)
+		return true;
+	if (wq) {
+		if (wq->poll && wq->polled != task_runs) {
+			wq->polled = task_runs;
+			if (wq->poll(wq->ctx))
+				wq->seq++;
+		}
+		if (wq->seq != task->wait_seq)
+			return true;
+	}
+	if (task->wake_us) {
+		if (!time_after_eq64(now, task->wake_us))
+			return false;
+		task->timed_out = wq != NULL;
+
+		return true;
+	}
+
+	return !wq;
+}
+
+void cyclic_task_run(void)
+{
+	struct cyclic_task *task, *tmp;
+	uint64_t now, cpu_time;
+	int ret;
+
+	if (!(gd->flags & GD_FLG_RELOC) || list_empty(&task_list))
+		return;
+
+	task_runs++;
+	list_for_each_entry_safe(task, tmp, &task_list, sibling) {
+		now = timer_get_us();
+		if (!task_ready(task, now))
+			continue;
+		task->wq = NULL;
+		task->wake_us = 0;
+		ret = task->func(task, task->ctx);
+		task->run_cnt++;
+		cpu_time = timer_get_us() - now;
+		task->cpu_time_us += cpu_time;
+		if (cpu_time > CONFIG_CYCLIC_MAX_CPU_TIME_US &&
+		    !task->already_warned) {
+			pr_err("task %s took too long: %lldus vs %dus max\n",
+			       task->name, cpu_time,
+			       CONFIG_CYCLIC_MAX_CPU_TIME_US);
+			task->already_warned = true;
+		}
+		if (ret != CYCLIC_TASK_WAIT)
+			task_finish(task, ret);
+	}
+}
+
+void cyclic_task_stop_all(void)
+{
+	struct cyclic_task *task, *tmp;
+	int ret;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+
+	list_for_each_entry_safe(task, tmp, &task_list, sibling) {
+		task->cancel = true;
+		ret = task->func(task, task->ctx);
+		task_finish(task, ret == CYCLIC_TASK_WAIT ? -ECANCELED : ret);
+	}
+}
@@ -32,6 +32,100 @@ void malloc_stats();
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+/*
+ * With tracing, the public functions here record each call and use the
+ * allocator below, which is built under other names. Its internal calls to
+ * itself are not traced.
+ */
+static Void_t *untraced_malloc(size_t bytes);
+static void untraced_free(Void_t *mem);
+static Void_t *untraced_realloc(Void_t *oldmem, size_t bytes);
+static Void_t *untraced_memalign(size_t alignment, size_t bytes);
+static Void_t *untraced_valloc(size_t bytes);
+static Void_t *untraced_pvalloc(size_t bytes);
+static Void_t *untraced_calloc(size_t n, size_t elem_size);
+
+Void_t *mALLOc(size_t bytes)
+{
+	Void_t *mem = untraced_malloc(bytes);
+
+	malloc_trace_alloc(mem, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+void fREe(Void_t *mem)
+{
+	malloc_trace_free(mem);
+	untraced_free(mem);
+}
+
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes)
+{
+	Void_t *mem = untraced_realloc(oldmem, bytes);
+
+	if (mem) {
+		if (mem != oldmem)
+			malloc_trace_free(oldmem);
+		malloc_trace_alloc(mem, bytes, __builtin_return_address(0));
+	}
+
+	return mem;
+}
+
+Void_t *mEMALIGn(size_t alignment, size_t bytes)
+{
+	Void_t *mem = untraced_memalign(alignment, bytes);
+
+	malloc_trace_alloc(mem, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+Void_t *vALLOc(size_t bytes)
+{
+	Void_t *mem = untraced_valloc(bytes);
+
+	malloc_trace_alloc(mem, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+Void_t *pvALLOc(size_t bytes)
+{
+	Void_t *mem = untraced_pvalloc(bytes);
+
+	malloc_trace_alloc(mem, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+Void_t *cALLOc(size_t n, size_t elem_size)
+{
+	Void_t *mem = untraced_calloc(n, elem_size);
+
+	malloc_trace_alloc(mem, n * elem_size, __builtin_return_address(0));
+
+	return mem;
+}
+
+#undef mALLOc
+#undef fREe
+#undef rEALLOc
+#undef mEMALIGn
+#undef vALLOc
+#undef pvALLOc
+#undef cALLOc
+#define mALLOc		untraced_malloc
+#define fREe		untraced_free
+#define rEALLOc		untraced_realloc
+#define mEMALIGn	untraced_memalign
+#define vALLOc		untraced_valloc
+#define pvALLOc		untraced_pvalloc
+#define cALLOc		untraced_calloc
+#endif
+
 /*
   Emulation of sbrk for WIN32
   All code within the ifdef WIN32 is untested by me.
@@ -608,6 +702,18 @@ void *sbrk(ptrdiff_t increment)
 
 void mem_malloc_init(ulong start, ulong size)
 {
+	__maybe_unused ulong taken;
+
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+	taken = malloc_trace_init(start, size);
+	start += taken;
+	size -= taken;
+#endif
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+	taken = malloc_pool_init(start, size);
+	start += taken;
+	size -= taken;
+#endif
 	mem_malloc_start = start;
 	mem_malloc_end = start + size;
 	mem_malloc_brk = start;
@@ -1583,6 +1689,9 @@ void fREe(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+  if (CONFIG_IS_ENABLED(SYS_MALLOC_POOL) && malloc_pool_free(mem))
+    return;
+
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -1742,6 +1851,11 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 	}
 #endif
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+  if (malloc_pool_usable_size(oldmem))
+    return malloc_pool_realloc(oldmem, bytes);
+#endif
+
   newp    = oldp    = mem2chunk(oldmem);
   newsize = oldsize = chunksize(oldp);
 
@@ -2200,7 +2314,7 @@ void cfree(Void_t *mem)
 void cfree(mem) Void_t *mem;
 #endif
 {
-  fREe(mem);
+  free(mem);
 }
 #endif
 
@@ -2307,6 +2421,10 @@ size_t malloc_usable_size(mem) Void_t* mem;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+  else if (malloc_pool_usable_size(mem))
+    return malloc_pool_usable_size(mem);
+#endif
   else
   {
     p = mem2chunk(mem);
@@ -2357,6 +2475,10 @@ static void malloc_update_mallinfo(void)
 
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+  /* the pools are set aside from the heap, so count what is in use there */
+  current_mallinfo.uordblks += malloc_pool_in_use();
+#endif
   current_mallinfo.fordblks = avail;
   current_mallinfo.hblks = n_mmaps;
   current_mallinfo.hblkhd = mmapped_mem;
@@ -2475,6 +2597,11 @@ void malloc_disable_testing(void)
 	malloc_testing = false;
 }
 
+bool malloc_testing_active(void)
+{
+	return CONFIG_IS_ENABLED(UNIT_TEST) && malloc_testing;
+}
+
 /*
 
 History:
@@ -48,6 +48,7 @@ const char *const type_name[] = {
 
 	/* main loop events */
 	"main_loop",
+	"dm_probe_deferred",
 };
 
 _Static_assert(ARRAY_SIZE(type_name) == EVT_COUNT, "event type_name size");
@@ -21,6 +21,7 @@
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <linux/errno.h>
+#include <linux/math64.h>
 #else
 #include "mkimage.h"
 #include <linux/compiler_attributes.h>
@@ -619,4 +620,45 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 	return 0;
 }
 #endif /* CONFIG_CMD_HASH || CONFIG_CMD_SHA1SUM || CONFIG_CMD_CRC32) */
+
+#ifdef CONFIG_CMD_HASH_BENCH
+static void hash_bench_one(struct hash_algo *algo, const void *buf, ulong len)
+{
+	u8 output[HASH_MAX_DIGEST_SIZE];
+	ulong start, us;
+
+	start = timer_get_us();
+	algo->hash_func_ws(buf, len, output, algo->chunk_size);
+	us = timer_get_us() - start;
+
+	printf("%-12s %10lu us", algo->name, us);
+	if (us)
+		printf(" %10llu KiB/s", div_u64((u64)len * 1000000 / 1024, us));
+	printf("\n");
+}
+
+int hash_bench(const char *algo_name, ulong addr, ulong len)
+{
+	struct hash_algo *algo;
+	void *buf;
+	int i;
+
+	if (algo_name && hash_lookup_algo(algo_name, &algo)) {
+		printf("Unknown hash algorithm '%s'\n", algo_name);
+		return -EPROTONOSUPPORT;
+	}
+
+	printf("Hashing %lu bytes at %08lx\n", len, addr);
+	buf = map_sysmem(addr, len);
+	if (algo_name) {
+		hash_bench_one(algo, buf, len);
+	} else {
+		for (i = 0; i < ARRAY_SIZE(hash_algo); i++)
+			hash_bench_one(&hash_algo[i], buf, len);
+	}
+	unmap_sysmem(buf);
+
+	return 0;
+}
+#endif /* CONFIG_CMD_HASH_BENCH */
 #endif /* !USE_HOSTCC */
@@ -20,6 +20,7 @@
 #include <net.h>
 #include <version_string.h>
 #include <efi_loader.h>
+#include <dm/root.h>
 
 static void run_preboot_environment_command(void)
 {
@@ -80,6 +81,10 @@ void main_loop(void)
 		panic("Failed to boot");
 	}
 
+	/* autoboot did not happen, so bring up what was left for later */
+	if (IS_ENABLED(CONFIG_DM_DEFERRED_PROBE))
+		dm_probe_deferred();
+
 	cli_loop();
 
 	panic("No CLI available");
@@ -0,0 +1,266 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Pools for small allocations
+ *
+ * Driver model makes many small allocations of a few sizes: devices, their
+ * private data, uclasses and devres records. In dlmalloc each of these costs a
+ * chunk header and a search of the bins, and freeing them fragments the heap.
+ *
+ * The pools serve these from slabs of POOL_SLAB_SIZE bytes, each holding
+ * objects of one size class, with a list of free objects for each class. Both
+ * allocating and freeing take constant time and objects have no header. Slabs
+ * come from a region at the start of the malloc() area, set aside by
+ * mem_malloc_init(), and are never given back. When a class has no free
+ * object and there are no slabs left, the allocation falls back to calloc().
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define POOL_SLAB_SHIFT		12
+#define POOL_SLAB_SIZE		(1UL << POOL_SLAB_SHIFT)
+#define POOL_SLABS		(CONFIG_SYS_MALLOC_POOL_SIZE >> POOL_SLAB_SHIFT)
+
+/* Object size of each class, a multiple of the malloc() alignment */
+static const u16 pool_sizes[] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+#define POOL_CLASSES		ARRAY_SIZE(pool_sizes)
+
+/**
+ * struct pool_class - State of one size class
+ *
+ * @free: First free object, each of which holds a pointer to the next
+ * @in_use: Number of objects allocated
+ * @peak: Highest value of @in_use
+ * @slabs: Number of slabs used by this class
+ * @fallbacks: Number of allocations passed to calloc() since no slab was left
+ */
+struct pool_class {
+	void *free;
+	uint in_use;
+	uint peak;
+	uint slabs;
+	uint fallbacks;
+};
+
+/**
+ * struct malloc_pool - State of the pools
+ *
+ * @base: Start of the region for slabs, or 0 if the pools are not set up
+ * @end: End of the region
+ * @next: Next slab to give to a class
+ * @slab_class: Class of each slab which has been given out
+ * @cls: State of each class
+ */
+static struct malloc_pool {
+	ulong base;
+	ulong end;
+	ulong next;
+	u8 slab_class[POOL_SLABS];
+	struct pool_class cls[POOL_CLASSES];
+} pool;
+
+ulong malloc_pool_init(ulong start, ulong size)
+{
+	ulong base = ALIGN(start, POOL_SLAB_SIZE);
+	ulong taken = base - start + CONFIG_SYS_MALLOC_POOL_SIZE;
+
+	memset(&pool, '\0', sizeof(pool));
+	if (taken > size / 2) {
+		log_warning("Malloc pools do not fit, size %lx\n", size);
+		return 0;
+	}
+	pool.base = base;
+	pool.next = base;
+	pool.end = base + CONFIG_SYS_MALLOC_POOL_SIZE;
+
+	return taken;
+}
+
+static int pool_class_of(size_t size)
+{
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++) {
+		if (size <= pool_sizes[i])
+			return i;
+	}
+
+	return -1;
+}
+
+/* Give a new slab to a class and add its objects to the free list */
+static bool pool_grow(int idx)
+{
+	struct pool_class *cls = &pool.cls[idx];
+	uint size = pool_sizes[idx];
+	char *slab, *obj;
+
+	if (pool.next == pool.end)
+		return false;
+	slab = (char *)pool.next;
+	pool.slab_class[(pool.next - pool.base) >> POOL_SLAB_SHIFT] = idx;
+	pool.next += POOL_SLAB_SIZE;
+	cls->slabs++;
+
+	/* add them in reverse so that they are handed out in order */
+	for (obj = slab + (POOL_SLAB_SIZE / size - 1) * size; obj >= slab;
+	     obj -= size) {
+		*(void **)obj = cls->free;
+		cls->free = obj;
+	}
+
+	return true;
+}
+
+static bool pool_active(void)
+{
+	return (gd->flags & GD_FLG_FULL_MALLOC_INIT) && pool.base;
+}
+
+static void *pool_alloc(size_t nmemb, size_t size)
+{
+	struct pool_class *cls;
+	size_t total;
+	void *ptr;
+	int idx;
+
+	if (!pool_active() || malloc_testing_active() ||
+	    (size && nmemb > (size_t)-1 / size))
+		return calloc(nmemb, size);
+
+	total = nmemb * size;
+	idx = pool_class_of(total);
+	if (idx < 0)
+		return calloc(nmemb, size);
+
+	cls = &pool.cls[idx];
+	if (!cls->free && !pool_grow(idx)) {
+		cls->fallbacks++;
+		return calloc(nmemb, size);
+	}
+	ptr = cls->free;
+	cls->free = *(void **)ptr;
+	if (++cls->in_use > cls->peak)
+		cls->peak = cls->in_use;
+	memset(ptr, '\0', total);
+
+	return ptr;
+}
+
+void *pool_calloc(size_t nmemb, size_t size)
+{
+	void *ptr = pool_alloc(nmemb, size);
+
+	malloc_trace_alloc(ptr, nmemb * size, __builtin_return_address(0));
+
+	return ptr;
+}
+
+/* Get the class of an object, or -1 if it is not from the pools */
+static int pool_class_of_ptr(const void *ptr)
+{
+	ulong addr = (ulong)ptr;
+
+	if (!pool_active() || addr < pool.base || addr >= pool.next)
+		return -1;
+
+	return pool.slab_class[(addr - pool.base) >> POOL_SLAB_SHIFT];
+}
+
+bool malloc_pool_free(void *ptr)
+{
+	struct pool_class *cls;
+	int idx;
+
+	idx = pool_class_of_ptr(ptr);
+	if (idx < 0)
+		return false;
+	cls = &pool.cls[idx];
+	*(void **)ptr = cls->free;
+	cls->free = ptr;
+	cls->in_use--;
+
+	return true;
+}
+
+size_t malloc_pool_usable_size(const void *ptr)
+{
+	int idx = pool_class_of_ptr(ptr);
+
+	return idx < 0 ? 0 : pool_sizes[idx];
+}
+
+void *malloc_pool_realloc(void *ptr, size_t size)
+{
+	size_t old_size = malloc_pool_usable_size(ptr);
+	void *new;
+
+	if (size <= old_size)
+		return ptr;
+	new = malloc(size);
+	if (!new)
+		return NULL;
+	memcpy(new, ptr, old_size);
+	malloc_pool_free(ptr);
+
+	return new;
+}
+
+ulong malloc_pool_in_use(void)
+{
+	ulong total = 0;
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++)
+		total += pool.cls[i].in_use * pool_sizes[i];
+
+	return total;
+}
+
+int malloc_pool_get_stats(struct malloc_pool_stats *stats, int max)
+{
+	int i;
+
+	for (i = 0; i < POOL_CLASSES && i < max; i++) {
+		struct malloc_pool_stats *st = &stats[i];
+
+		st->size = pool_sizes[i];
+		st->in_use = pool.cls[i].in_use;
+		st->peak = pool.cls[i].peak;
+		st->slabs = pool.cls[i].slabs;
+		st->fallbacks = pool.cls[i].fallbacks;
+	}
+
+	return i;
+}
+
+void malloc_pool_info(void)
+{
+	struct pool_class *cls;
+	uint slabs = 0;
+	int i;
+
+	if (!pool.base) {
+		printf("Pools not set up\n");
+		return;
+	}
+	printf("Size  In use    Peak   Slabs  Fallbacks\n");
+	printf("----  ------  ------  ------  ---------\n");
+	for (i = 0; i < POOL_CLASSES; i++) {
+		cls = &pool.cls[i];
+		printf("%4u  %6u  %6u  %6u  %9u\n", pool_sizes[i], cls->in_use,
+		       cls->peak, cls->slabs, cls->fallbacks);
+		slabs += cls->slabs;
+	}
+	printf("\nSlabs used %u of %lu (%lu KiB each), %lu bytes in use\n",
+	       slabs, (pool.end - pool.base) >> POOL_SLAB_SHIFT,
+	       POOL_SLAB_SIZE / 1024, malloc_pool_in_use());
+}
@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tracing of live malloc() allocations
+ *
+ * Each allocation made after relocation is recorded with its caller, size and
+ * time, until it is freed. Records are kept in a hash table keyed by address,
+ * using linear probing, in a region set aside at the start of the malloc()
+ * area by mem_malloc_init(). Nothing is allocated while tracing, so the table
+ * can be updated from within malloc() and free().
+ *
+ * The public allocation functions in dlmalloc.c and pool_calloc() call
+ * malloc_trace_alloc() and malloc_trace_free(). Internal calls between them
+ * are not traced, or are traced again by the outer function, so each record
+ * holds the caller outside the allocator.
+ */
+
+#include <common.h>
+#include <kallsyms.h>
+#include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define TRACE_COUNT		CONFIG_MALLOC_TRACE_COUNT
+
+/**
+ * struct malloc_trace - State of tracing
+ *
+ * @recs: Hash table of records, with a @ptr of 0 for an empty slot, or NULL
+ *	if tracing is not set up
+ * @stats: Totals for the live allocations
+ */
+static struct malloc_trace {
+	struct malloc_trace_rec *recs;
+	struct malloc_trace_stats stats;
+} trace;
+
+ulong malloc_trace_init(ulong start, ulong size)
+{
+	ulong base = ALIGN(start, sizeof(ulong));
+	ulong taken = base - start + TRACE_COUNT * sizeof(*trace.recs);
+
+	memset(&trace, '\0', sizeof(trace));
+	if (taken > size / 2) {
+		log_warning("Malloc trace records do not fit, size %lx\n",
+			    size);
+		return 0;
+	}
+	trace.recs = (struct malloc_trace_rec *)base;
+	memset(trace.recs, '\0', TRACE_COUNT * sizeof(*trace.recs));
+
+	return taken;
+}
+
+static bool trace_active(void)
+{
+	return (gd->flags & GD_FLG_FULL_MALLOC_INIT) && trace.recs;
+}
+
+static ulong trace_time(void)
+{
+#ifdef CONFIG_TIMER
+	/* reading the timer before it is set up would probe it */
+	if (!gd->timer && !IS_ENABLED(CONFIG_TIMER_EARLY))
+		return 0;
+#endif
+
+	return timer_get_us() ? : 1;
+}
+
+static uint trace_hash(ulong ptr)
+{
+	/* the low bits are always the same due to alignment */
+	return (uint)((ptr >> 4) * 0x9e3779b1UL) % TRACE_COUNT;
+}
+
+/* Find the slot for @ptr, or the empty slot where it would go */
+static struct malloc_trace_rec *trace_slot(ulong ptr)
+{
+	uint i = trace_hash(ptr);
+	uint n;
+
+	for (n = 0; n < TRACE_COUNT; n++) {
+		struct malloc_trace_rec *rec = &trace.recs[i];
+
+		if (!rec->ptr || rec->ptr == ptr)
+			return rec;
+		if (++i == TRACE_COUNT)
+			i = 0;
+	}
+
+	return NULL;
+}
+
+void malloc_trace_alloc(void *ptr, size_t size, void *caller)
+{
+	struct malloc_trace_stats *st = &trace.stats;
+	struct malloc_trace_rec *rec;
+
+	if (!ptr || !trace_active())
+		return;
+	st->allocs++;
+	rec = trace_slot((ulong)ptr);
+	if (!rec) {
+		st->dropped++;
+		return;
+	}
+	if (rec->ptr) {
+		st->bytes -= rec->size;
+	} else {
+		/* keep one slot empty so that searches end */
+		if (st->count == TRACE_COUNT - 1) {
+			st->dropped++;
+			return;
+		}
+		st->count++;
+	}
+	rec->ptr = (ulong)ptr;
+	rec->caller = (ulong)caller;
+	rec->time_us = trace_time();
+	rec->size = size;
+	st->bytes += size;
+	if (st->bytes > st->peak_bytes) {
+		st->peak_bytes = st->bytes;
+		st->peak_count = st->count;
+		st->peak_us = rec->time_us;
+	}
+}
+
+void malloc_trace_free(void *ptr)
+{
+	struct malloc_trace_rec *rec;
+	uint gap, i, home;
+
+	if (!ptr || !trace_active())
+		return;
+	rec = trace_slot((ulong)ptr);
+	if (!rec || !rec->ptr)
+		return;
+	trace.stats.count--;
+	trace.stats.bytes -= rec->size;
+
+	/*
+	 * Move later records in the same run back into the gap, unless that
+	 * would put them before their home slot
+	 */
+	gap = rec - trace.recs;
+	for (i = gap;;) {
+		if (++i == TRACE_COUNT)
+			i = 0;
+		rec = &trace.recs[i];
+		if (!rec->ptr)
+			break;
+		home = trace_hash(rec->ptr);
+		if (i > gap ? home <= gap || home > i :
+		    home <= gap && home > i) {
+			trace.recs[gap] = *rec;
+			gap = i;
+		}
+	}
+	memset(&trace.recs[gap], '\0', sizeof(*rec));
+}
+
+const struct malloc_trace_rec *malloc_trace_find(const void *ptr)
+{
+	struct malloc_trace_rec *rec;
+
+	if (!ptr || !trace_active())
+		return NULL;
+	rec = trace_slot((ulong)ptr);
+
+	return rec && rec->ptr ? rec : NULL;
+}
+
+void malloc_trace_get_stats(struct malloc_trace_stats *stats)
+{
+	*stats = trace.stats;
+}
+
+void malloc_trace_mark(void)
+{
+	struct malloc_trace_stats *st = &trace.stats;
+
+	st->mark_us = trace_time();
+	st->peak_bytes = st->bytes;
+	st->peak_count = st->count;
+	st->peak_us = st->mark_us;
+}
+
+/**
+ * struct trace_caller - Live allocations made from one place
+ *
+ * @caller: Address the allocations were made from
+ * @count: Number of allocations
+ * @bytes: Total size of the allocations
+ * @oldest_us: Time of the oldest allocation
+ */
+struct trace_caller {
+	ulong caller;
+	ulong count;
+	ulong bytes;
+	ulong oldest_us;
+};
+
+static int h_cmp_caller(const void *v1, const void *v2)
+{
+	const struct trace_caller *c1 = v1, *c2 = v2;
+
+	return c1->caller < c2->caller ? -1 : c1->caller > c2->caller;
+}
+
+static int h_cmp_bytes(const void *v1, const void *v2)
+{
+	const struct trace_caller *c1 = v1, *c2 = v2;
+
+	return c1->bytes > c2->bytes ? -1 : c1->bytes < c2->bytes;
+}
+
+static void print_caller(ulong caller)
+{
+	ulong addr = caller - gd->reloc_off;
+	const char *name;
+	ulong base;
+
+	name = symbol_lookup(addr, &base);
+	if (name)
+		printf("%s+%#lx\n", name, addr - base);
+	else
+		printf("%08lx\n", addr);
+}
+
+int malloc_trace_dump(bool since_mark)
+{
+	struct malloc_trace_stats *st = &trace.stats;
+	struct trace_caller *callers, *cur;
+	ulong bytes = 0, count = 0;
+	int i, j, num = 0, max;
+
+	if (!trace.recs) {
+		printf("Tracing not set up\n");
+		return 0;
+	}
+
+	/* allow for the record of this allocation */
+	max = st->count + 1;
+	callers = malloc(max * sizeof(*callers));
+	if (!callers)
+		return -ENOMEM;
+
+	for (i = 0; i < TRACE_COUNT && num < max; i++) {
+		struct malloc_trace_rec *rec = &trace.recs[i];
+
+		if (!rec->ptr || rec->ptr == (ulong)callers)
+			continue;
+		if (since_mark && rec->time_us < st->mark_us)
+			continue;
+		cur = &callers[num++];
+		cur->caller = rec->caller;
+		cur->count = 1;
+		cur->bytes = rec->size;
+		cur->oldest_us = rec->time_us;
+	}
+
+	/* combine the allocations from each caller */
+	qsort(callers, num, sizeof(*callers), h_cmp_caller);
+	for (i = 1, j = 0; i < num; i++) {
+		cur = &callers[j];
+		if (callers[i].caller == cur->caller) {
+			cur->count++;
+			cur->bytes += callers[i].bytes;
+			cur->oldest_us = min(cur->oldest_us,
+					     callers[i].oldest_us);
+		} else {
+			callers[++j] = callers[i];
+		}
+	}
+	if (num)
+		num = j + 1;
+	qsort(callers, num, sizeof(*callers), h_cmp_bytes);
+
+	printf("   Bytes   Count  Oldest (s)  Caller\n");
+	printf("--------  ------  ----------  ------\n");
+	for (i = 0; i < num; i++) {
+		cur = &callers[i];
+		printf("%8lu  %6lu  %6lu.%03lu  ", cur->bytes, cur->count,
+		       cur->oldest_us / 1000000, cur->oldest_us / 1000 % 1000);
+		print_caller(cur->caller);
+		bytes += cur->bytes;
+		count += cur->count;
+	}
+	printf("\n%lu bytes in %lu allocations from %d callers\n", bytes,
+	       count, num);
+	free(callers);
+
+	return 0;
+}
+
+void malloc_trace_info(void)
+{
+	struct malloc_trace_stats *st = &trace.stats;
+
+	if (!trace.recs) {
+		printf("Tracing not set up\n");
+		return;
+	}
+	printf("Live:     %lu bytes in %lu allocations\n", st->bytes,
+	       st->count);
+	printf("Peak:     %lu bytes in %lu allocations at %lu.%03lu s\n",
+	       st->peak_bytes, st->peak_count, st->peak_us / 1000000,
+	       st->peak_us / 1000 % 1000);
+	printf("Allocs:   %lu since start", st->allocs);
+	if (st->dropped)
+		printf(", %lu not traced", st->dropped);
+	printf("\n");
+	if (st->mark_us)
+		printf("Mark:     %lu.%03lu s\n", st->mark_us / 1000000,
+		       st->mark_us / 1000 % 1000);
+}
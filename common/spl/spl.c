@@ -26,6 +26,7 @@
 #include <asm/u-boot.h>
 #include <nand.h>
 #include <fat.h>
+#include <of_live.h>
 #include <u-boot/crc.h>
 #if CONFIG_IS_ENABLED(BANNER_PRINT)
 #include <timestamp.h>
@@ -802,6 +803,13 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 				       dev->name, rc);
 		}
 	}
+	if (IS_ENABLED(CONFIG_OF_LIVE_HANDOFF) && spl_phase() == PHASE_SPL &&
+	    os == IH_OS_U_BOOT && spl_image_fdt_addr(&spl_image)) {
+		ret = of_live_stash_handoff(spl_image_fdt_addr(&spl_image));
+		if (ret)
+			printf(SPL_TPL_PROMPT
+			       "Live tree hand-off failed (err=%d)\n", ret);
+	}
 	if (CONFIG_IS_ENABLED(HANDOFF)) {
 		ret = write_spl_handoff();
 		if (ret)
@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/sections.h>
+#include <linux/sizes.h>
 #include <spl.h>
 
 #include <lzma/LzmaTypes.h>
@@ -82,34 +83,66 @@ int spl_parse_legacy_header(struct spl_image_info *spl_image,
 	return 0;
 }
 
+/* Compressed data read at a time when decompressing */
+#define SPL_LZMA_CHUNK	SZ_16K
+
+/**
+ * struct spl_lzma_reader - state for reading compressed data in pieces
+ *
+ * @load:	loader to read with
+ * @base:	offset of the compressed data on the device
+ * @buf:	buffer for a piece of the data
+ * @size:	size of @buf, a multiple of the block length
+ */
+struct spl_lzma_reader {
+	struct spl_load_info *load;
+	ulong base;
+	void *buf;
+	ulong size;
+};
+
+static const unsigned char *spl_lzma_read(void *priv, SizeT offset,
+					  SizeT *lenp)
+{
+	struct spl_lzma_reader *rd = priv;
+	ulong pos = rd->base + offset;
+	ulong start = ALIGN_DOWN(pos, spl_get_bl_len(rd->load));
+	ulong count;
+
+	count = rd->load->read(rd->load, start, rd->size, rd->buf);
+	if (count <= pos - start)
+		return NULL;
+	*lenp = count - (pos - start);
+
+	return rd->buf + (pos - start);
+}
+
 int spl_load_legacy_lzma(struct spl_image_info *spl_image,
 			 struct spl_load_info *load, ulong offset)
 {
 	SizeT lzma_len = LZMA_LEN;
-	void *src;
-	ulong dataptr, overhead, size;
+	struct spl_lzma_reader rd;
 	int ret;
 
-	/* dataptr points to compressed payload  */
-	dataptr = ALIGN_DOWN(sizeof(struct legacy_img_hdr),
-			     spl_get_bl_len(load));
-	overhead = sizeof(struct legacy_img_hdr) - dataptr;
-	size = ALIGN(spl_image->size + overhead, spl_get_bl_len(load));
-	dataptr += offset;
-
-	debug("LZMA: Decompressing %08lx to %08lx\n",
-	      dataptr, spl_image->load_addr);
-	src = malloc(size);
-	if (!src) {
-		printf("Unable to allocate %d bytes for LZMA\n",
-		       spl_image->size);
+	/*
+	 * Read the compressed payload a piece at a time while decompressing
+	 * it, rather than reading all of it into a buffer first
+	 */
+	rd.load = load;
+	rd.base = offset + sizeof(struct legacy_img_hdr);
+	rd.size = ALIGN(SPL_LZMA_CHUNK, spl_get_bl_len(load));
+	rd.buf = malloc(rd.size);
+	if (!rd.buf) {
+		printf("Unable to allocate %lu bytes for LZMA\n", rd.size);
 		return -ENOMEM;
 	}
 
-	load->read(load, dataptr, size, src);
-	ret = lzmaBuffToBuffDecompress(map_sysmem(spl_image->load_addr,
-						  spl_image->size), &lzma_len,
-				       src + overhead, spl_image->size);
+	debug("LZMA: Decompressing %08lx to %08lx\n", rd.base,
+	      spl_image->load_addr);
+	ret = lzmaStreamDecompress(map_sysmem(spl_image->load_addr,
+					      spl_image->size), &lzma_len,
+				   spl_lzma_read, &rd, spl_image->size);
+	free(rd.buf);
 	if (ret) {
 		printf("LZMA decompression error: %d\n", ret);
 		return ret;
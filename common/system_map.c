@@ -5,4 +5,10 @@
  * Licensed under the GPL-2 or later.
  */
 
-const char const system_map[] = SYSTEM_MAP;
+/*
+ * This is generated from the first link of U-Boot, one line per function, each
+ * holding its address in hex followed by its name
+ */
+const char system_map[] =
+#include <generated/system_map.h>
+;
@@ -155,6 +155,10 @@ void device_free(struct udevice *dev)
 	dev_bic_flags(dev, DM_FLAG_PLATDATA_VALID);
 
 	devres_release_probe(dev);
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	dev->stats.priv_bytes = 0;
+	dev->stats.devres_bytes = 0;
+#endif
 }
 
 /**
@@ -199,6 +203,7 @@ static int flags_remove(uint flags, uint drv_flags)
 int device_remove(struct udevice *dev, uint flags)
 {
 	const struct driver *drv;
+	__maybe_unused ulong start;
 	int ret;
 
 	if (!dev)
@@ -232,6 +237,7 @@ int device_remove(struct udevice *dev, uint flags)
 		return ret;
 	}
 
+	start = dev_stats_time();
 	ret = uclass_pre_remove_device(dev);
 	if (ret)
 		return ret;
@@ -259,6 +265,10 @@ int device_remove(struct udevice *dev, uint flags)
 	device_free(dev);
 
 	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	if (start)
+		dev->stats.remove_us = dev_stats_time() - start;
+#endif
 
 	ret = device_notify(dev, EVT_DM_POST_REMOVE);
 	if (ret)
@@ -33,6 +33,7 @@
 #include <linux/err.h>
 #include <linux/list.h>
 #include <power-domain.h>
+#include <time.h>
 #include <linux/printk.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -46,6 +47,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	struct uclass *uc;
 	int size, ret = 0;
 	bool auto_seq = true;
+	__maybe_unused ulong start;
 	void *ptr;
 
 	if (CONFIG_IS_ENABLED(OF_PLATDATA_NO_BIND))
@@ -62,7 +64,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		return ret;
 	}
 
-	dev = calloc(1, sizeof(struct udevice));
+	start = dev_stats_time();
+	dev = pool_calloc(1, sizeof(struct udevice));
 	if (!dev)
 		return -ENOMEM;
 
@@ -116,7 +119,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		}
 		if (alloc) {
 			dev_or_flags(dev, DM_FLAG_ALLOC_PDATA);
-			ptr = calloc(1, drv->plat_auto);
+			ptr = pool_calloc(1, drv->plat_auto);
 			if (!ptr) {
 				ret = -ENOMEM;
 				goto fail_alloc1;
@@ -135,7 +138,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	size = uc->uc_drv->per_device_plat_auto;
 	if (size) {
 		dev_or_flags(dev, DM_FLAG_ALLOC_UCLASS_PDATA);
-		ptr = calloc(1, size);
+		ptr = pool_calloc(1, size);
 		if (!ptr) {
 			ret = -ENOMEM;
 			goto fail_alloc2;
@@ -149,7 +152,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			size = parent->uclass->uc_drv->per_child_plat_auto;
 		if (size) {
 			dev_or_flags(dev, DM_FLAG_ALLOC_PARENT_PDATA);
-			ptr = calloc(1, size);
+			ptr = pool_calloc(1, size);
 			if (!ptr) {
 				ret = -ENOMEM;
 				goto fail_alloc3;
@@ -186,6 +189,10 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	if (devp)
 		*devp = dev;
 
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	if (start)
+		dev->stats.bind_us = dev_stats_time() - start;
+#endif
 	dev_or_flags(dev, DM_FLAG_BOUND);
 
 	return 0;
@@ -332,12 +339,20 @@ static void *alloc_priv(int size, uint flags)
 			flush_dcache_range((ulong)priv, (ulong)priv + size);
 		}
 	} else {
-		priv = calloc(1, size);
+		priv = pool_calloc(1, size);
 	}
 
 	return priv;
 }
 
+/* Count the memory allocated for the private data of a device */
+static void device_count_priv(struct udevice *dev, int size)
+{
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	dev->stats.priv_bytes += size;
+#endif
+}
+
 /**
  * device_alloc_priv() - Allocate priv/plat data required by the device
  *
@@ -359,6 +374,7 @@ static int device_alloc_priv(struct udevice *dev)
 		if (!ptr)
 			return -ENOMEM;
 		dev_set_priv(dev, ptr);
+		device_count_priv(dev, drv->priv_auto);
 	}
 
 	/* Allocate private data if requested and not reentered */
@@ -368,6 +384,7 @@ static int device_alloc_priv(struct udevice *dev)
 		if (!ptr)
 			return -ENOMEM;
 		dev_set_uclass_priv(dev, ptr);
+		device_count_priv(dev, size);
 	}
 
 	/* Allocate parent data for this child */
@@ -380,6 +397,7 @@ static int device_alloc_priv(struct udevice *dev)
 			if (!ptr)
 				return -ENOMEM;
 			dev_set_parent_priv(dev, ptr);
+			device_count_priv(dev, size);
 		}
 	}
 
@@ -478,9 +496,23 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+ulong dev_stats_time(void)
+{
+#ifdef CONFIG_TIMER
+	/* reading the timer before it is set up would probe it */
+	if (!gd->timer && !IS_ENABLED(CONFIG_TIMER_EARLY))
+		return 0;
+#endif
+
+	return timer_get_us() ? : 1;
+}
+#endif
+
 int device_probe(struct udevice *dev)
 {
 	const struct driver *drv;
+	__maybe_unused ulong start;
 	int ret;
 
 	if (!dev)
@@ -516,6 +548,7 @@ int device_probe(struct udevice *dev)
 			return 0;
 	}
 
+	start = dev_stats_time();
 	dev_or_flags(dev, DM_FLAG_ACTIVATED);
 
 	if (CONFIG_IS_ENABLED(POWER_DOMAIN) && dev->parent &&
@@ -601,6 +634,11 @@ int device_probe(struct udevice *dev)
 	if (ret)
 		goto fail_event;
 
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	if (start)
+		dev->stats.probe_us = dev_stats_time() - start;
+#endif
+
 	return 0;
 fail_event:
 fail_uclass:
@@ -47,6 +47,8 @@ struct devres {
 	enum devres_phase		phase;
 #ifdef CONFIG_DEBUG_DEVRES
 	const char			*name;
+#endif
+#if defined(CONFIG_DEBUG_DEVRES) || CONFIG_IS_ENABLED(DM_PROBE_STATS)
 	size_t				size;
 #endif
 	unsigned long long		data[];
@@ -70,6 +72,18 @@ static void devres_log(struct udevice *dev, struct devres *dr,
 #define devres_log(dev, dr, op)		do {} while (0)
 #endif
 
+/*
+ * Keep track of the memory allocated while reading in or probing a device,
+ * for the stats shown by 'dm times'
+ */
+static void devres_count(struct udevice *dev, struct devres *dr, int sign)
+{
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	if (dr->phase != DEVRES_PHASE_BIND)
+		dev->stats.devres_bytes += sign * (int)dr->size;
+#endif
+}
+
 #if CONFIG_DEBUG_DEVRES
 void *__devres_alloc(dr_release_t release, size_t size, gfp_t gfp,
 		     const char *name)
@@ -80,13 +94,16 @@ void *_devres_alloc(dr_release_t release, size_t size, gfp_t gfp)
 	size_t tot_size = sizeof(struct devres) + size;
 	struct devres *dr;
 
-	dr = kmalloc(tot_size, gfp);
+	dr = pool_calloc(1, tot_size);
 	if (unlikely(!dr))
 		return NULL;
 
 	INIT_LIST_HEAD(&dr->entry);
 	dr->release = release;
 	set_node_dbginfo(dr, name, size);
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	dr->size = size;
+#endif
 
 	return dr->data;
 }
@@ -114,6 +131,7 @@ void devres_add(struct udevice *dev, void *res)
 	else
 		dr->phase = DEVRES_PHASE_BIND;
 	list_add_tail(&dr->entry, &dev->devres_head);
+	devres_count(dev, dr, 1);
 }
 
 void *devres_find(struct udevice *dev, dr_release_t release,
@@ -159,6 +177,7 @@ void *devres_remove(struct udevice *dev, dr_release_t release,
 		struct devres *dr = container_of(res, struct devres, data);
 
 		list_del_init(&dr->entry);
+		devres_count(dev, dr, -1);
 		devres_log(dev, dr, "REM");
 	}
 
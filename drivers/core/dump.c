@@ -4,7 +4,9 @@
  */
 
 #include <common.h>
+#include <bloblist.h>
 #include <dm.h>
+#include <errno.h>
 #include <malloc.h>
 #include <mapmem.h>
 #include <sort.h>
@@ -357,3 +359,162 @@ void dm_dump_mem(struct dm_stats *stats)
 	printf("Drop device name (not SRAM): %x (%d)\n", stats->dev_name_size,
 	       stats->dev_name_size);
 }
+
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+static int h_cmp_probe_time(const void *d1, const void *d2)
+{
+	const struct udevice *const *dev1 = d1;
+	const struct udevice *const *dev2 = d2;
+
+	if ((*dev1)->stats.probe_us != (*dev2)->stats.probe_us)
+		return (*dev1)->stats.probe_us < (*dev2)->stats.probe_us ? 1 : -1;
+
+	return 0;
+}
+
+static int add_devices(struct udevice *dev, struct udevice **devs, int count)
+{
+	struct udevice *child;
+
+	devs[count++] = dev;
+	device_foreach_child(child, dev)
+		count = add_devices(child, devs, count);
+
+	return count;
+}
+
+/**
+ * get_devices_by_probe_time() - Get a list of all devices, slowest first
+ *
+ * @devsp: Returns an allocated list of devices, which the caller must free
+ * Return: number of devices, or -ENOMEM if out of memory
+ */
+static int get_devices_by_probe_time(struct udevice ***devsp)
+{
+	int dev_count, uclasses, count;
+	struct udevice **devs;
+
+	dm_get_stats(&dev_count, &uclasses);
+	devs = calloc(dev_count, sizeof(struct udevice *));
+	if (!devs)
+		return -ENOMEM;
+	count = add_devices(dm_root(), devs, 0);
+	qsort(devs, count, sizeof(struct udevice *), h_cmp_probe_time);
+	*devsp = devs;
+
+	return count;
+}
+
+/* Get the probe state of a device, as shown by dm_dump_times() */
+static const char *probe_state(struct udevice *dev)
+{
+	u32 flags = dev_get_flags(dev);
+
+	if (flags & DM_FLAG_PROBE_DEFERRED)
+		return flags & DM_FLAG_ACTIVATED ? "deferred" : "pending";
+
+	return flags & DM_FLAG_ACTIVATED ? "probed" : "-";
+}
+
+void dm_dump_times(bool all)
+{
+	int count, shown, probed, deferred, i;
+	struct dm_dev_stats total;
+	struct udevice **devs;
+
+	count = get_devices_by_probe_time(&devs);
+	if (count < 0) {
+		printf("(out of memory)\n");
+		return;
+	}
+
+	memset(&total, '\0', sizeof(total));
+	printf("    Bind    Probe   Remove     Priv   Devres  State     Uclass      Name\n");
+	printf("--------  -------  -------  -------  -------  --------  ----------  --------------------\n");
+	for (i = 0, shown = 0, probed = 0, deferred = 0; i < count; i++) {
+		struct udevice *dev = devs[i];
+		const struct dm_dev_stats *st = &dev->stats;
+		u32 flags = dev_get_flags(dev);
+
+		total.bind_us += st->bind_us;
+		total.probe_us += st->probe_us;
+		total.remove_us += st->remove_us;
+		total.priv_bytes += st->priv_bytes;
+		total.devres_bytes += st->devres_bytes;
+		probed += !!(flags & DM_FLAG_ACTIVATED);
+		deferred += !!(flags & DM_FLAG_PROBE_DEFERRED);
+
+		/* devices waiting for a deferred probe are always shown */
+		if (!all && !(flags & (DM_FLAG_ACTIVATED |
+				       DM_FLAG_PROBE_DEFERRED)))
+			continue;
+		printf("%8u  %7u  %7u  %7u  %7u  %-8s  %-10.10s  %s\n",
+		       st->bind_us, st->probe_us, st->remove_us,
+		       st->priv_bytes, st->devres_bytes, probe_state(dev),
+		       dev->uclass->uc_drv->name, dev->name);
+		shown++;
+	}
+	printf("--------  -------  -------  -------  -------\n");
+	printf("%8u  %7u  %7u  %7u  %7u  Total for %d devices\n",
+	       total.bind_us, total.probe_us, total.remove_us,
+	       total.priv_bytes, total.devres_bytes, count);
+	printf("Probed %d of %d devices (%d deferred)\n", probed, count,
+	       deferred);
+	if (shown < count)
+		printf("(%d devices not probed are not shown)\n", count - shown);
+	free(devs);
+}
+
+int dm_stash_times(void)
+{
+	struct dm_times_hdr *hdr;
+	struct dm_times_rec *rec;
+	struct udevice **devs;
+	int count, active, size, ret, i;
+
+	if (!CONFIG_IS_ENABLED(BLOBLIST))
+		return -ENOSYS;
+	count = get_devices_by_probe_time(&devs);
+	if (count < 0)
+		return count;
+	for (i = 0, active = 0; i < count; i++)
+		active += device_active(devs[i]);
+
+	size = sizeof(*hdr) + active * sizeof(*rec);
+	if (bloblist_find(BLOBLISTT_U_BOOT_DM_TIMES, 0)) {
+		ret = bloblist_resize(BLOBLISTT_U_BOOT_DM_TIMES, size);
+		if (ret)
+			goto err;
+	}
+	ret = bloblist_ensure_size(BLOBLISTT_U_BOOT_DM_TIMES, size, 0,
+				   (void **)&hdr);
+	if (ret)
+		goto err;
+
+	hdr->version = DM_TIMES_VERSION;
+	hdr->hdr_size = sizeof(*hdr);
+	hdr->rec_size = sizeof(*rec);
+	hdr->count = active;
+	rec = (struct dm_times_rec *)(hdr + 1);
+	for (i = 0; i < count; i++) {
+		struct udevice *dev = devs[i];
+
+		if (!device_active(dev))
+			continue;
+		memset(rec, '\0', sizeof(*rec));
+		strlcpy(rec->name, dev->name, sizeof(rec->name));
+		rec->uclass_id = device_get_uclass_id(dev);
+		rec->bind_us = dev->stats.bind_us;
+		rec->probe_us = dev->stats.probe_us;
+		rec->remove_us = dev->stats.remove_us;
+		rec->priv_bytes = dev->stats.priv_bytes;
+		rec->devres_bytes = dev->stats.devres_bytes;
+		rec++;
+	}
+	ret = 0;
+err:
+	free(devs);
+
+	return ret;
+}
+#endif
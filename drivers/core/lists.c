@@ -11,6 +11,8 @@
 #include <common.h>
 #include <errno.h>
 #include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -19,6 +21,9 @@
 #include <dm/util.h>
 #include <fdtdec.h>
 #include <linux/compiler.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 struct driver *lists_driver_lookup_name(const char *name)
 {
@@ -181,11 +186,112 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   struct driver *drv, bool pre_reloc_only)
+/**
+ * struct compat_entry - Entry in the index of compatible strings
+ *
+ * @compat:	Compatible string, NULL if the entry is unused
+ * @drv:	First driver which has this string in its of_match table
+ * @id:		Entry in @drv's of_match table with this string
+ */
+struct compat_entry {
+	const char *compat;
+	struct driver *drv;
+	const struct udevice_id *id;
+};
+
+/* Hash table of compatible strings, built on first use after relocation */
+static struct compat_entry *compat_index;
+static uint compat_index_mask;
+
+static uint compat_hash(const char *str)
+{
+	uint hash = 2166136261U;
+
+	while (*str)
+		hash = (hash ^ (u8)*str++) * 16777619;
+
+	return hash;
+}
+
+static int compat_index_build(void)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id;
+	struct compat_entry *ent;
+	struct driver *entry;
+	uint count = 0, size, slot;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++)
+			count++;
+	}
+	size = __roundup_pow_of_two(max(count * 2, 2U));
+	compat_index = calloc(size, sizeof(*compat_index));
+	if (!compat_index)
+		return log_msg_ret("idx", -ENOMEM);
+	compat_index_mask = size - 1;
+
+	/* drivers are added in order, so the first one for a string wins */
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			slot = compat_hash(id->compatible) & compat_index_mask;
+			for (ent = &compat_index[slot]; ent->compat;
+			     ent = &compat_index[slot]) {
+				if (!strcmp(ent->compat, id->compatible))
+					break;
+				slot = (slot + 1) & compat_index_mask;
+			}
+			if (ent->compat)
+				continue;
+			ent->compat = id->compatible;
+			ent->drv = entry;
+			ent->id = id;
+		}
+	}
+	log_debug("Indexed %u compatible strings in %u entries\n", count,
+		  size);
+
+	return 0;
+}
+
+struct driver *lists_driver_lookup_compat(const char *compat,
+					  const struct udevice_id **idp)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+	uint slot;
+
+	/* the index uses BSS and malloc(), so is not available before then */
+	if (CONFIG_IS_ENABLED(DM_COMPAT_INDEX) && (gd->flags & GD_FLG_RELOC) &&
+	    (compat_index || !compat_index_build())) {
+		const struct compat_entry *ent;
+
+		slot = compat_hash(compat) & compat_index_mask;
+		for (ent = &compat_index[slot]; ent->compat;
+		     ent = &compat_index[slot]) {
+			if (!strcmp(ent->compat, compat)) {
+				*idp = ent->id;
+				return ent->drv;
+			}
+			slot = (slot + 1) & compat_index_mask;
+		}
+
+		return NULL;
+	}
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   struct driver *drv, bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -223,20 +329,16 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 			  compat);
 
 		id = NULL;
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			if (drv) {
-				if (drv != entry)
-					continue;
-				if (!entry->of_match)
-					break;
-			}
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
+		if (drv) {
+			entry = drv;
+			if (entry->of_match &&
+			    driver_check_compatible(entry->of_match, &id, compat))
+				continue;
+		} else {
+			entry = lists_driver_lookup_compat(compat, &id);
+			if (!entry)
+				continue;
 		}
-		if (entry == driver + n_ents)
-			continue;
 
 		if (pre_reloc_only) {
 			if (!ofnode_pre_reloc(node) &&
@@ -29,6 +29,7 @@
 #include <linux/ctype.h>
 #include <linux/err.h>
 #include <linux/ioport.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -38,6 +39,11 @@ static LIST_HEAD(aliases_lookup);
 /* "/aliaes" node */
 static struct device_node *of_aliases;
 
+/* hash table of the nodes in gd->of_root which have a phandle */
+static struct device_node **phandle_index;
+static struct device_node *phandle_index_root;
+static uint phandle_index_mask;
+
 /* "/chosen" node */
 static struct device_node *of_chosen;
 
@@ -445,6 +451,44 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
 	return np;
 }
 
+void of_reset_phandle_index(void)
+{
+	free(phandle_index);
+	phandle_index = NULL;
+	phandle_index_root = NULL;
+}
+
+static int of_build_phandle_index(void)
+{
+	struct device_node *np;
+	uint count = 0, size, i;
+
+	for_each_of_allnodes(np) {
+		if (np->phandle)
+			count++;
+	}
+	size = __roundup_pow_of_two(max(count * 2, 2U));
+	phandle_index = calloc(size, sizeof(*phandle_index));
+	if (!phandle_index)
+		return log_msg_ret("idx", -ENOMEM);
+	phandle_index_mask = size - 1;
+
+	/* if two nodes have the same phandle, the first one wins */
+	for_each_of_allnodes(np) {
+		if (!np->phandle)
+			continue;
+		i = np->phandle & phandle_index_mask;
+		while (phandle_index[i] &&
+		       phandle_index[i]->phandle != np->phandle)
+			i = (i + 1) & phandle_index_mask;
+		if (!phandle_index[i])
+			phandle_index[i] = np;
+	}
+	phandle_index_root = gd->of_root;
+
+	return 0;
+}
+
 struct device_node *of_find_node_by_phandle(struct device_node *root,
 					    phandle handle)
 {
@@ -453,6 +497,24 @@ struct device_node *of_find_node_by_phandle(struct device_node *root,
 	if (!handle)
 		return NULL;
 
+	if (CONFIG_IS_ENABLED(OF_PHANDLE_INDEX) && !root && gd->of_root) {
+		if (phandle_index_root != gd->of_root) {
+			of_reset_phandle_index();
+			of_build_phandle_index();
+		}
+		if (phandle_index) {
+			uint i;
+
+			for (i = handle & phandle_index_mask;
+			     (np = phandle_index[i]);
+			     i = (i + 1) & phandle_index_mask) {
+				if (np->phandle == handle)
+					return np;
+			}
+			/* a node added since may not be indexed, so keep looking */
+		}
+	}
+
 	for_each_of_allnodes_from(root, np)
 		if (np->phandle == handle)
 			break;
@@ -881,7 +943,7 @@ int of_alias_scan(void)
 			continue;
 
 		/* Allocate an alias_prop with enough space for the stem */
-		ap = malloc(sizeof(*ap) + len + 1);
+		ap = pool_calloc(1, sizeof(*ap) + len + 1);
 		if (!ap)
 			return -ENOMEM;
 		memset(ap, 0, sizeof(*ap) + len + 1);
@@ -956,7 +1018,7 @@ int of_write_prop(struct device_node *np, const char *propname, int len,
 	}
 
 	/* Property does not exist -> append new property */
-	new = malloc(sizeof(struct property));
+	new = pool_calloc(1, sizeof(struct property));
 	if (!new)
 		return -ENOMEM;
 
@@ -1000,7 +1062,7 @@ int of_add_subnode(struct device_node *parent, const char *name, int len,
 	}
 
 	/* Subnode does not exist -> append new subnode */
-	new = calloc(1, sizeof(struct device_node));
+	new = pool_calloc(1, sizeof(struct device_node));
 	if (!new)
 		return -ENOMEM;
 
@@ -1016,7 +1078,7 @@ int of_add_subnode(struct device_node *parent, const char *name, int len,
 	 * its full path
 	 */
 	parent_fnl = *parent->name ? strlen(parent->full_name) : 0;
-	full_name = calloc(1, parent_fnl + 1 + len + 1);
+	full_name = pool_calloc(1, parent_fnl + 1 + len + 1);
 	if (!full_name) {
 		free(new_name);
 		free(new);
@@ -1092,6 +1154,7 @@ int of_remove_node(struct device_node *to_remove)
 		prev->sibling = np->sibling;
 	else
 		parent->child = np->sibling;
+	of_reset_phandle_index();
 
 	/*
 	 * don't free it, since if this is an unflattened tree, all the memory
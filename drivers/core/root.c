@@ -10,6 +10,7 @@
 
 #include <common.h>
 #include <errno.h>
+#include <event.h>
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
@@ -281,7 +282,15 @@ void *dm_priv_to_rw(void *priv)
 }
 #endif
 
-static int dm_probe_devices(struct udevice *dev, bool pre_reloc_only)
+/* Check whether probing @dev after bind may be left until it is used */
+static bool dm_probe_may_defer(struct udevice *dev)
+{
+	return (dev_get_flags(dev) | dev->driver->flags) &
+		DM_FLAG_PROBE_MAY_DEFER ||
+		dev->uclass->uc_drv->flags & DM_UC_FLAG_PROBE_MAY_DEFER;
+}
+
+int dm_probe_devices(struct udevice *dev, bool pre_reloc_only)
 {
 	ofnode node = dev_ofnode(dev);
 	struct udevice *child;
@@ -293,6 +302,12 @@ static int dm_probe_devices(struct udevice *dev, bool pre_reloc_only)
 		goto probe_children;
 
 	if (dev_get_flags(dev) & DM_FLAG_PROBE_AFTER_BIND) {
+		/* after relocation, leave it until it is needed, if allowed */
+		if (CONFIG_IS_ENABLED(DM_DEFERRED_PROBE) && !pre_reloc_only &&
+		    dm_probe_may_defer(dev) && !device_active(dev)) {
+			dev_or_flags(dev, DM_FLAG_PROBE_DEFERRED);
+			goto probe_children;
+		}
 		ret = device_probe(dev);
 		if (ret)
 			return ret;
@@ -305,6 +320,30 @@ probe_children:
 	return 0;
 }
 
+static void dm_probe_deferred_children(struct udevice *dev)
+{
+	struct udevice *child;
+	int ret;
+
+	if ((dev_get_flags(dev) & DM_FLAG_PROBE_DEFERRED) &&
+	    !device_active(dev)) {
+		ret = device_probe(dev);
+		if (ret)
+			log_warning("Deferred probe of '%s' failed (err=%d)\n",
+				    dev->name, ret);
+	}
+
+	list_for_each_entry(child, &dev->child_head, sibling_node)
+		dm_probe_deferred_children(child);
+}
+
+void dm_probe_deferred(void)
+{
+	if (gd->dm_root)
+		dm_probe_deferred_children(gd->dm_root);
+	event_notify_null(EVT_DM_PROBE_DEFERRED);
+}
+
 /**
  * dm_scan() - Scan tables to bind devices
  *
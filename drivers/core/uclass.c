@@ -69,13 +69,13 @@ static int uclass_add(enum uclass_id id, struct uclass **ucp)
 		 */
 		return -EPFNOSUPPORT;
 	}
-	uc = calloc(1, sizeof(*uc));
+	uc = pool_calloc(1, sizeof(*uc));
 	if (!uc)
 		return -ENOMEM;
 	if (uc_drv->priv_auto) {
 		void *ptr;
 
-		ptr = calloc(1, uc_drv->priv_auto);
+		ptr = pool_calloc(1, uc_drv->priv_auto);
 		if (!ptr) {
 			ret = -ENOMEM;
 			goto fail_mem;
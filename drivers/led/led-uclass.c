@@ -110,9 +110,12 @@ static int led_post_bind(struct udevice *dev)
 
 	/*
 	 * In case the LED has default-state DT property, trigger
-	 * probe() to configure its default state during startup.
+	 * probe() to configure its default state during startup. Turning
+	 * it off can wait until it is used, with deferred probing.
 	 */
 	dev_or_flags(dev, DM_FLAG_PROBE_AFTER_BIND);
+	if (uc_plat->default_state == LEDST_OFF)
+		dev_or_flags(dev, DM_FLAG_PROBE_MAY_DEFER);
 
 	return 0;
 }
@@ -28,6 +28,7 @@
 #include <linux/delay.h>
 #include <linux/err.h>
 #include <linux/kernel.h>
+#include <net/pktbuf.h>
 #include <asm/io.h>
 #include <power/regulator.h>
 #include "designware.h"
@@ -40,6 +41,19 @@
 #define dma_to_virt(pa)		(pa)
 #endif
 
+/*
+ * Mark the MDIO bus as in use. udelay() calls schedule(), which may poll the
+ * PHY for the link task, so the poll must not start an access of its own
+ */
+static void dw_mdio_set_busy(struct mii_dev *bus, bool busy)
+{
+#if defined(CONFIG_DM_ETH) && CONFIG_IS_ENABLED(CYCLIC_TASK)
+	struct dw_eth_dev *priv = dev_get_priv((struct udevice *)bus->priv);
+
+	priv->mdio_busy = busy;
+#endif
+}
+
 static int dw_mdio_read(struct mii_dev *bus, int addr, int devad, int reg)
 {
 #ifdef CONFIG_DM_ETH
@@ -50,21 +64,25 @@ static int dw_mdio_read(struct mii_dev *bus, int addr, int devad, int reg)
 #endif
 	ulong start;
 	u16 miiaddr;
-	int timeout = CFG_MDIO_TIMEOUT;
+	int ret = -ETIMEDOUT, timeout = CFG_MDIO_TIMEOUT;
 
 	miiaddr = ((addr << MIIADDRSHIFT) & MII_ADDRMSK) |
 		  ((reg << MIIREGSHIFT) & MII_REGMSK);
 
+	dw_mdio_set_busy(bus, true);
 	writel(miiaddr | MII_CLKRANGE_150_250M | MII_BUSY, &mac_p->miiaddr);
 
 	start = get_timer(0);
 	while (get_timer(start) < timeout) {
-		if (!(readl(&mac_p->miiaddr) & MII_BUSY))
-			return readl(&mac_p->miidata);
+		if (!(readl(&mac_p->miiaddr) & MII_BUSY)) {
+			ret = readl(&mac_p->miidata);
+			break;
+		}
 		udelay(10);
 	};
+	dw_mdio_set_busy(bus, false);
 
-	return -ETIMEDOUT;
+	return ret;
 }
 
 static int dw_mdio_write(struct mii_dev *bus, int addr, int devad, int reg,
@@ -80,6 +98,7 @@ static int dw_mdio_write(struct mii_dev *bus, int addr, int devad, int reg,
 	u16 miiaddr;
 	int ret = -ETIMEDOUT, timeout = CFG_MDIO_TIMEOUT;
 
+	dw_mdio_set_busy(bus, true);
 	writel(val, &mac_p->miidata);
 	miiaddr = ((addr << MIIADDRSHIFT) & MII_ADDRMSK) |
 		  ((reg << MIIREGSHIFT) & MII_REGMSK) | MII_WRITE;
@@ -94,6 +113,7 @@ static int dw_mdio_write(struct mii_dev *bus, int addr, int devad, int reg,
 		}
 		udelay(10);
 	};
+	dw_mdio_set_busy(bus, false);
 
 	return ret;
 }
@@ -277,31 +297,61 @@ static void tx_descs_init(struct dw_eth_dev *priv)
 	priv->tx_currdescnum = 0;
 }
 
+/* Release the pool buffer of an Rx descriptor, if it has one */
+static void rx_desc_put_buf(struct dw_eth_dev *priv, u32 idx)
+{
+	if (CONFIG_IS_ENABLED(DM_ETH) && priv->rx_pkts[idx]) {
+		pktbuf_put(priv->rx_pkts[idx]);
+		priv->rx_pkts[idx] = NULL;
+	}
+}
+
+/*
+ * Give an Rx descriptor a buffer. With driver model this comes from the packet
+ * pool, so that the network stack can keep a received packet without copying
+ * it. Otherwise, or if the pool is empty, the descriptor's slot in rxbuffs is
+ * used.
+ */
+static void rx_desc_set_buf(struct dw_eth_dev *priv, u32 idx)
+{
+	struct dmamacdescr *desc_p = &priv->rx_mac_descrtable[idx];
+	uchar *buf = NULL;
+	u32 size;
+
+	if (CONFIG_IS_ENABLED(DM_ETH))
+		buf = pktbuf_alloc();
+	priv->rx_pkts[idx] = buf;
+	if (buf) {
+		size = PKTSIZE_ALIGN;
+	} else {
+		buf = (uchar *)&priv->rxbuffs[idx * CFG_ETH_BUFSIZE];
+		size = MAC_MAX_FRAME_SZ;
+	}
+
+	/* Before passing the buffer to GMAC we need to make sure that no
+	 * dirty cache lines are left in it. Otherwise there's a chance to get
+	 * some of them flushed in RAM when GMAC is already pushing data to RAM
+	 * via DMA. This way incoming from GMAC data will be corrupted. */
+	flush_dcache_range((ulong)buf,
+			   (ulong)buf + roundup(size, ARCH_DMA_MINALIGN));
+
+	desc_p->dmamac_addr = (ulong)virt_to_dma(buf);
+	desc_p->dmamac_cntl = (size & DESC_RXCTRL_SIZE1MASK) |
+			      DESC_RXCTRL_RXCHAIN;
+}
+
 static void rx_descs_init(struct dw_eth_dev *priv)
 {
 	struct eth_dma_regs *dma_p = priv->dma_regs_p;
 	struct dmamacdescr *desc_table_p = &priv->rx_mac_descrtable[0];
-	char *rxbuffs = &priv->rxbuffs[0];
 	struct dmamacdescr *desc_p;
 	u32 idx;
 
-	/* Before passing buffers to GMAC we need to make sure zeros
-	 * written there right after "priv" structure allocation were
-	 * flushed into RAM.
-	 * Otherwise there's a chance to get some of them flushed in RAM when
-	 * GMAC is already pushing data to RAM via DMA. This way incoming from
-	 * GMAC data will be corrupted. */
-	flush_dcache_range((ulong)rxbuffs, (ulong)rxbuffs + RX_TOTAL_BUFSIZE);
-
 	for (idx = 0; idx < CFG_RX_DESCR_NUM; idx++) {
 		desc_p = &desc_table_p[idx];
-		desc_p->dmamac_addr = (ulong)virt_to_dma(&rxbuffs[idx * CFG_ETH_BUFSIZE]);
+		rx_desc_put_buf(priv, idx);
+		rx_desc_set_buf(priv, idx);
 		desc_p->dmamac_next = (ulong)virt_to_dma(&desc_table_p[idx + 1]);
-
-		desc_p->dmamac_cntl =
-			(MAC_MAX_FRAME_SZ & DESC_RXCTRL_SIZE1MASK) |
-				      DESC_RXCTRL_RXCHAIN;
-
 		desc_p->txrx_status = DESC_RXSTS_OWNBYDMA;
 	}
 
@@ -366,13 +416,88 @@ static void _dw_eth_halt(struct dw_eth_dev *priv)
 {
 	struct eth_mac_regs *mac_p = priv->mac_regs_p;
 	struct eth_dma_regs *dma_p = priv->dma_regs_p;
+	u32 idx;
 
 	writel(readl(&mac_p->conf) & ~(RXENABLE | TXENABLE), &mac_p->conf);
 	writel(readl(&dma_p->opmode) & ~(RXSTART | TXSTART), &dma_p->opmode);
 
+	/* DMA is stopped, so the Rx buffers can go back to the pool */
+	for (idx = 0; idx < CFG_RX_DESCR_NUM; idx++)
+		rx_desc_put_buf(priv, idx);
+
 	phy_shutdown(priv->phydev);
 }
 
+#if CONFIG_IS_ENABLED(CYCLIC_TASK)
+/* Check whether autonegotiation is complete, unless the MDIO bus is in use */
+static bool dw_link_poll(void *ctx)
+{
+	struct dw_eth_dev *priv = ctx;
+	int bmsr;
+
+	if (priv->mdio_busy)
+		return false;
+	bmsr = phy_read(priv->phydev, MDIO_DEVAD_NONE, MII_BMSR);
+
+	return bmsr >= 0 && (bmsr & BMSR_ANEGCOMPLETE);
+}
+
+/* Wait for autonegotiation in the background, instead of in phy_startup() */
+static int dw_link_task(struct cyclic_task *task, void *ctx)
+{
+	struct dw_eth_dev *priv = ctx;
+
+	if (task->cancel)
+		return -ECANCELED;
+	if (!task->state++)
+		return cyclic_task_wait(task, &priv->link_wq,
+					PHY_ANEG_TIMEOUT * 1000ULL);
+
+	return task->timed_out ? -ETIMEDOUT : 0;
+}
+
+static void dw_link_start(struct dw_eth_dev *priv, const char *name)
+{
+	if (priv->phydev->autoneg != AUTONEG_ENABLE)
+		return;
+	priv->link_wq = (struct cyclic_waitq)CYCLIC_WAITQ_INIT(dw_link_poll,
+							       priv);
+	if (cyclic_task_start(&priv->link_task, dw_link_task, name, priv))
+		priv->link_task.func = NULL;
+}
+
+/*
+ * Let the link task finish, running other tasks and cyclic functions while
+ * it waits. If this cannot be done, phy_startup() waits as before
+ */
+static void dw_link_wait(struct dw_eth_dev *priv)
+{
+	if (priv->link_task.func && !priv->link_task.done)
+		cyclic_task_join(&priv->link_task, PHY_ANEG_TIMEOUT * 1000ULL);
+}
+
+static void dw_link_stop(struct dw_eth_dev *priv)
+{
+	if (priv->link_task.func && !priv->link_task.done) {
+		cyclic_task_cancel(&priv->link_task);
+		cyclic_task_join(&priv->link_task, 0);
+	}
+}
+#else
+static inline void dw_link_start(struct dw_eth_dev *priv,
+				 const char *name)
+{
+}
+
+static inline void dw_link_wait(struct dw_eth_dev *priv)
+{
+}
+
+static inline void dw_link_stop(struct dw_eth_dev *priv)
+{
+}
+#endif
+
 int designware_eth_init(struct dw_eth_dev *priv, u8 *enetaddr)
 {
 	struct eth_mac_regs *mac_p = priv->mac_regs_p;
@@ -426,6 +551,8 @@ int designware_eth_init(struct dw_eth_dev *priv, u8 *enetaddr)
 	writel((CONFIG_DW_AXI_BURST_LEN & 0x1FF >> 1), &dma_p->axibus);
 #endif
 
+	dw_link_wait(priv);
+
 	/* Start up the PHY */
 	ret = phy_startup(priv->phydev);
 	if (ret) {
@@ -561,13 +688,19 @@ static int _dw_free_pkt(struct dw_eth_dev *priv)
 	ulong desc_end = desc_start +
 		roundup(sizeof(*desc_p), ARCH_DMA_MINALIGN);
 
+	/* The stack kept the packet, so DMA needs another buffer */
+	if (CONFIG_IS_ENABLED(DM_ETH) &&
+	    pktbuf_is_shared(priv->rx_pkts[desc_num])) {
+		rx_desc_put_buf(priv, desc_num);
+		rx_desc_set_buf(priv, desc_num);
+	}
+
 	/*
 	 * Make the current descriptor valid again and go to
 	 * the next one
 	 */
 	desc_p->txrx_status |= DESC_RXSTS_OWNBYDMA;
 
-	/* Flush only status field - others weren't changed */
 	flush_dcache_range(desc_start, desc_end);
 
 	/* Test the wrap-around condition. */
@@ -872,8 +1005,10 @@ int designware_eth_probe(struct udevice *dev)
 
 	ret = dw_phy_init(priv, dev);
 	debug("%s, ret=%d\n", __func__, ret);
-	if (!ret)
+	if (!ret) {
+		dw_link_start(priv, dev->name);
 		return 0;
+	}
 
 	/* continue here for cleanup if no PHY found */
 	err = ret;
@@ -895,6 +1030,7 @@ static int designware_eth_remove(struct udevice *dev)
 {
 	struct dw_eth_dev *priv = dev_get_priv(dev);
 
+	dw_link_stop(priv);
 	free(priv->phydev);
 	mdio_unregister(priv->bus);
 	mdio_free(priv->bus);
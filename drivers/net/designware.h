@@ -8,6 +8,7 @@
 #define _DW_ETH_H
 
 #include <asm/cache.h>
+#include <cyclic.h>
 #include <net.h>
 
 #if CONFIG_IS_ENABLED(DM_GPIO)
@@ -225,6 +226,8 @@ struct dw_eth_dev {
 	struct dmamacdescr rx_mac_descrtable[CFG_RX_DESCR_NUM];
 	char txbuffs[TX_TOTAL_BUFSIZE] __aligned(ARCH_DMA_MINALIGN);
 	char rxbuffs[RX_TOTAL_BUFSIZE] __aligned(ARCH_DMA_MINALIGN);
+	/* pool buffer of each Rx descriptor, NULL if it uses rxbuffs */
+	uchar *rx_pkts[CFG_RX_DESCR_NUM];
 
 	u32 interface;
 	u32 max_speed;
@@ -244,6 +247,11 @@ struct dw_eth_dev {
 	struct udevice *dev;
 	struct phy_device *phydev;
 	struct mii_dev *bus;
+#if CONFIG_IS_ENABLED(CYCLIC_TASK)
+	struct cyclic_task link_task;	/* waits for autonegotiation */
+	struct cyclic_waitq link_wq;	/* polls the PHY status */
+	bool mdio_busy;		/* MDIO access in progress, see dw_link_poll() */
+#endif
 };
 
 int designware_eth_of_to_plat(struct udevice *dev);
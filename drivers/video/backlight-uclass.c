@@ -33,4 +33,5 @@ int backlight_set_brightness(struct udevice *dev, int percent)
 UCLASS_DRIVER(backlight) = {
 	.id		= UCLASS_PANEL_BACKLIGHT,
 	.name		= "backlight",
+	.flags		= DM_UC_FLAG_PROBE_MAY_DEFER,
 };
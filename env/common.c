@@ -12,6 +12,7 @@
 #include <command.h>
 #include <env.h>
 #include <env_internal.h>
+#include <env_table.h>
 #include <log.h>
 #include <sort.h>
 #include <asm/global_data.h>
@@ -304,6 +305,9 @@ int env_get_f(const char *name, char *buf, unsigned len)
 	else
 		env = (const char *)gd->env_addr;
 
+	if (env == default_environment)
+		return env_get_default_into(name, buf, len);
+
 	return env_get_from_linear(env, name, buf, len);
 }
 
@@ -366,11 +370,33 @@ char *env_get_default(const char *name)
  */
 int env_get_default_into(const char *name, char *buf, unsigned int len)
 {
-	return env_get_from_linear(default_environment, name, buf, len);
+	const char *value;
+	unsigned int res;
+
+	if (!CONFIG_IS_ENABLED(ENV_DEFAULT_TABLE))
+		return env_get_from_linear(default_environment, name, buf, len);
+
+	if (!name || !*name)
+		return -1;
+	value = env_table_get(&env_default_table, name);
+	if (!value)
+		return -1;
+
+	res = strlen(value);
+	memcpy(buf, value, min(len, res + 1));
+	if (len <= res) {
+		buf[len - 1] = '\0';
+		printf("env_buf [%u bytes] too small for value of \"%s\"\n",
+		       len, name);
+	}
+
+	return res;
 }
 
 void env_set_default(const char *s, int flags)
 {
+	int ret;
+
 	if (s) {
 		if ((flags & H_INTERACTIVE) == 0) {
 			printf("*** Warning - %s, "
@@ -383,9 +409,13 @@ void env_set_default(const char *s, int flags)
 	}
 
 	flags |= H_DEFAULT;
-	if (himport_r(&env_htab, default_environment,
-			sizeof(default_environment), '\0', flags, 0,
-			0, NULL) == 0) {
+	if (CONFIG_IS_ENABLED(ENV_DEFAULT_TABLE))
+		ret = env_table_import(&env_default_table, &env_htab, flags);
+	else
+		ret = himport_r(&env_htab, default_environment,
+				sizeof(default_environment), '\0', flags, 0,
+				0, NULL);
+	if (!ret) {
 		pr_err("## Error: Environment import failed: errno = %d\n",
 		       errno);
 		return;
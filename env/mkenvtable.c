@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Generate the default environment as a table sorted by name
+ *
+ * This parses the default environment as himport_r() does, i.e. with
+ * comments and leading blanks skipped, backslash escapes removed, and an
+ * entry without a value deleting an earlier one. It writes a C file defining
+ * env_default_table (see env_table.h) with the resulting variables. A variable
+ * whose last entry has no value is kept in a list of variables to delete,
+ * since himport_r() also deletes it from the existing environment when the
+ * import does not clear it first.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* Pull in the current config to define the default environment */
+#include <linux/kconfig.h>
+
+#ifndef __ASSEMBLY__
+#define __ASSEMBLY__ /* get only #defines from config.h */
+#include <config.h>
+#undef	__ASSEMBLY__
+#else
+#include <config.h>
+#endif
+
+#define DEFAULT_ENV_INSTANCE_STATIC
+#include <generated/environment.h>
+#include <env_default.h>
+
+/* A variable, with a NULL value if it is deleted */
+struct var {
+	char *name;
+	char *value;
+};
+
+static struct var *vars;
+static int count;
+
+static int find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!strcmp(vars[i].name, name))
+			return i;
+	}
+
+	return -1;
+}
+
+static void add(char *name, char *value)
+{
+	int i = find(name);
+
+	if (i < 0) {
+		vars = realloc(vars, (count + 1) * sizeof(*vars));
+		if (!vars) {
+			fprintf(stderr, "mkenvtable: out of memory\n");
+			exit(1);
+		}
+		i = count++;
+		vars[i].name = name;
+	}
+	vars[i].value = value;
+}
+
+/* Parse the environment; @env is changed to hold the strings */
+static int parse(char *env, char *end)
+{
+	char *dp = env, *name, *value, *sp;
+
+	while (dp < end && *dp) {
+		while (isblank(*dp))
+			++dp;
+
+		if (*dp == '#') {
+			while (*dp)
+				++dp;
+			++dp;
+			continue;
+		}
+
+		for (name = dp; *dp != '=' && *dp; ++dp)
+			;
+
+		/* "name" and "name=" delete the variable */
+		if (!*dp || !dp[1]) {
+			if (*dp == '=')
+				*dp++ = '\0';
+			*dp++ = '\0';
+			if (!*name) {
+				fprintf(stderr, "mkenvtable: empty variable name\n");
+				return -1;
+			}
+			add(name, NULL);
+			continue;
+		}
+		*dp++ = '\0';
+
+		for (value = sp = dp; *dp; ++dp) {
+			if (*dp == '\\' && dp[1])
+				++dp;
+			*sp++ = *dp;
+		}
+		*sp = '\0';
+		++dp;
+
+		if (!*name) {
+			fprintf(stderr, "mkenvtable: empty variable name\n");
+			return -1;
+		}
+		add(name, value);
+	}
+
+	return 0;
+}
+
+static int cmp_var(const void *a, const void *b)
+{
+	return strcmp(((const struct var *)a)->name,
+		      ((const struct var *)b)->name);
+}
+
+static void print_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			printf("\\%c", *str);
+		else if (isprint((unsigned char)*str))
+			putchar(*str);
+		else
+			printf("\\%03o", (unsigned char)*str);
+	}
+	printf("\\0\"");
+}
+
+/* Write the offsets of the variables which are set, or those deleted */
+static unsigned int print_index(const char *array, bool deleted,
+				unsigned int *offsetp)
+{
+	unsigned int num = 0;
+	int i;
+
+	printf("static const unsigned int %s[] = {\n", array);
+	for (i = 0; i < count; i++) {
+		if (!vars[i].value != deleted)
+			continue;
+		printf("\t%u,\n", *offsetp);
+		*offsetp += strlen(vars[i].name) + 1;
+		if (vars[i].value)
+			*offsetp += strlen(vars[i].value) + 1;
+		num++;
+	}
+	printf("};\n\n");
+
+	return num;
+}
+
+int main(void)
+{
+	unsigned int offset = 0, num, num_deleted;
+	int i;
+
+	if (parse(default_environment,
+		  default_environment + sizeof(default_environment)))
+		return 1;
+	qsort(vars, count, sizeof(*vars), cmp_var);
+
+	printf("/* Generated by env/mkenvtable - do not edit */\n\n");
+	printf("#include <env_table.h>\n\n");
+	/* the variables which are set come first, then those deleted */
+	printf("static const char env_default_strings[] =\n");
+	for (i = 0; i < count; i++) {
+		if (!vars[i].value)
+			continue;
+		printf("\t");
+		print_string(vars[i].name);
+		printf(" ");
+		print_string(vars[i].value);
+		printf("\n");
+	}
+	for (i = 0; i < count; i++) {
+		if (vars[i].value)
+			continue;
+		printf("\t");
+		print_string(vars[i].name);
+		printf("\n");
+	}
+	if (!count)
+		printf("\t\"\"\n");
+	printf(";\n\n");
+
+	num = print_index("env_default_index", false, &offset);
+	num_deleted = print_index("env_default_deleted", true, &offset);
+
+	printf("const struct env_table env_default_table = {\n");
+	printf("\t.strings\t= env_default_strings,\n");
+	printf("\t.size\t\t= sizeof(env_default_strings),\n");
+	printf("\t.index\t\t= env_default_index,\n");
+	printf("\t.count\t\t= %u,\n", num);
+	printf("\t.deleted\t= env_default_deleted,\n");
+	printf("\t.deleted_count\t= %u,\n", num_deleted);
+	printf("};\n");
+
+	return 0;
+}
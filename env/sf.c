@@ -189,18 +189,254 @@ out:
 	return ret;
 }
 #else
-static int env_sf_save(void)
+#ifdef CONFIG_ENV_SF_LOG
+#define ENV_SF_LOG_MAGIC	0x4c766e45	/* "EnvL" */
+
+/**
+ * struct env_sf_log_rec - header of a record in the environment log
+ *
+ * Each save appends one record to the log, holding the variables changed
+ * since the previous save as "name=value" strings and the deleted ones as
+ * "name" strings, each followed by a nul. The data is padded with nuls to a
+ * multiple of 4 bytes, with at least one nul.
+ *
+ * @magic:	ENV_SF_LOG_MAGIC; an erased header ends the log
+ * @size:	size of the data following the header
+ * @base_crc:	crc of the environment at CONFIG_ENV_OFFSET which the record
+ *		applies to
+ * @crc:	CRC32 of the fields above and the data
+ */
+struct env_sf_log_rec {
+	u32 magic;
+	u32 size;
+	u32 base_crc;
+	u32 crc;
+};
+
+/**
+ * struct env_sf_log - state of the environment log
+ *
+ * @valid:	true if the log can be appended to
+ * @base_crc:	crc of the environment at CONFIG_ENV_OFFSET
+ * @end:	offset of the end of the log, within the log area
+ * @saved:	data of the environment held in flash, with the log applied
+ */
+static struct env_sf_log {
+	bool valid;
+	u32 base_crc;
+	u32 end;
+	char *saved;
+} env_sf_log;
+
+static u32 env_sf_log_crc(const struct env_sf_log_rec *rec, const void *data)
 {
-	u32	saved_size = 0, saved_offset = 0, sector;
-	u32	sect_size = CONFIG_ENV_SECT_SIZE;
-	char	*saved_buffer = NULL;
-	int	ret = 1;
-	env_t	env_new;
-	struct spi_flash *env_flash;
+	u32 crc;
 
-	ret = setup_flash_device(&env_flash);
+	crc = crc32(0, (const void *)rec, offsetof(struct env_sf_log_rec, crc));
+
+	return crc32(crc, data, rec->size);
+}
+
+/* Compare the names of two "name=value" strings, as hexport_r() sorts them */
+static int env_sf_log_namecmp(const char *a, const char *b)
+{
+	for (; *a != '=' && *a == *b; a++, b++)
+		;
+
+	return (*a == '=' ? 0 : (u8)*a) - (*b == '=' ? 0 : (u8)*b);
+}
+
+/*
+ * Write the changes from the exported environment @old to @new, to @out if
+ * not NULL. Return the number of bytes needed.
+ */
+static int env_sf_log_diff(const char *old, const char *new, char *out)
+{
+	int size = 0, len, cmp;
+
+	while (*old || *new) {
+		if (!*old)
+			cmp = 1;
+		else if (!*new)
+			cmp = -1;
+		else
+			cmp = env_sf_log_namecmp(old, new);
+
+		if (cmp < 0) {
+			/* deleted: record the name only */
+			len = strchrnul(old, '=') - old;
+			if (out) {
+				memcpy(out + size, old, len);
+				out[size + len] = '\0';
+			}
+			size += len + 1;
+		} else if (cmp > 0 || strcmp(old, new)) {
+			len = strlen(new);
+			if (out)
+				memcpy(out + size, new, len + 1);
+			size += len + 1;
+		}
+		if (cmp <= 0)
+			old += strlen(old) + 1;
+		if (cmp >= 0)
+			new += strlen(new) + 1;
+	}
+
+	return size;
+}
+
+/* Remember the environment now held in flash */
+static int env_sf_log_set_saved(const env_t *env)
+{
+	struct env_sf_log *log = &env_sf_log;
+
+	if (!log->saved) {
+		log->saved = malloc(ENV_SIZE);
+		if (!log->saved)
+			return -ENOMEM;
+	}
+	memcpy(log->saved, env->data, ENV_SIZE);
+
+	return 0;
+}
+
+/*
+ * Apply the log to the environment just imported from @env, then export the
+ * result to @env
+ */
+static void env_sf_log_load(struct spi_flash *env_flash, env_t *env)
+{
+	struct env_sf_log *log = &env_sf_log;
+	struct env_sf_log_rec *rec;
+	u32 pos = 0, size;
+	char *buf;
+
+	log->valid = false;
+	log->base_crc = env->crc;
+	buf = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_SF_LOG_SIZE);
+	if (!buf)
+		return;
+	if (spi_flash_read(env_flash, CONFIG_ENV_SF_LOG_OFFSET,
+			   CONFIG_ENV_SF_LOG_SIZE, buf))
+		goto out;
+
+	while (pos + sizeof(*rec) <= CONFIG_ENV_SF_LOG_SIZE) {
+		rec = (struct env_sf_log_rec *)(buf + pos);
+		if (rec->magic == ~0U)
+			break;
+		size = CONFIG_ENV_SF_LOG_SIZE - pos - sizeof(*rec);
+		/*
+		 * A bad record is from an interrupted save, and records of
+		 * another environment from an interrupted compaction. Either
+		 * way, the log cannot be appended to.
+		 */
+		if (rec->magic != ENV_SF_LOG_MAGIC || rec->size > size ||
+		    rec->crc != env_sf_log_crc(rec, rec + 1) ||
+		    rec->base_crc != log->base_crc) {
+			pos = CONFIG_ENV_SF_LOG_SIZE;
+			break;
+		}
+		if (!himport_r(&env_htab, (char *)(rec + 1), rec->size, '\0',
+			       H_NOCLEAR | H_EXTERNAL, 0, 0, NULL))
+			pr_err("Cannot import environment log: errno = %d\n",
+			       errno);
+		pos += sizeof(*rec) + rec->size;
+	}
+
+	/* the rest must be erased, to be written to */
+	for (size = pos; size < CONFIG_ENV_SF_LOG_SIZE; size++) {
+		if (buf[size] != (char)0xff) {
+			pos = CONFIG_ENV_SF_LOG_SIZE;
+			break;
+		}
+	}
+	log->end = pos;
+
+	if (env_export(env) || env_sf_log_set_saved(env))
+		goto out;
+	log->valid = true;
+out:
+	free(buf);
+}
+
+/*
+ * Append the changes to the log. Return -ENOSPC, or -ENOMEM if there is no
+ * memory for the record, if the whole environment must be written instead.
+ */
+static int env_sf_log_save(struct spi_flash *env_flash, env_t *env_new)
+{
+	struct env_sf_log *log = &env_sf_log;
+	struct env_sf_log_rec *rec;
+	u32 size, total;
+	int ret;
+
+	if (!log->valid)
+		return -ENOSPC;
+	size = env_sf_log_diff(log->saved, (char *)env_new->data, NULL);
+	if (!size) {
+		puts("Unchanged\n");
+		return 0;
+	}
+	size = ALIGN(size + 1, 4);
+	total = sizeof(*rec) + size;
+	if (total > CONFIG_ENV_SF_LOG_SIZE - log->end)
+		return -ENOSPC;
+
+	rec = memalign(ARCH_DMA_MINALIGN, total);
+	if (!rec)
+		return -ENOMEM;
+	memset(rec + 1, '\0', size);
+	env_sf_log_diff(log->saved, (char *)env_new->data, (char *)(rec + 1));
+	rec->magic = ENV_SF_LOG_MAGIC;
+	rec->size = size;
+	rec->base_crc = log->base_crc;
+	rec->crc = env_sf_log_crc(rec, rec + 1);
+
+	puts("Appending to SPI flash...");
+	ret = spi_flash_write(env_flash, CONFIG_ENV_SF_LOG_OFFSET + log->end,
+			      total, rec);
+	free(rec);
+	if (ret) {
+		log->valid = false;
+		return ret;
+	}
+	log->end += total;
+	memcpy(log->saved, env_new->data, ENV_SIZE);
+	puts("done\n");
+
+	return 0;
+}
+
+/* Start a new log, for the environment just written */
+static int env_sf_log_reset(struct spi_flash *env_flash, env_t *env_new)
+{
+	struct env_sf_log *log = &env_sf_log;
+	int ret;
+
+	log->valid = false;
+	puts("Erasing SPI flash log...");
+	ret = spi_flash_erase(env_flash, CONFIG_ENV_SF_LOG_OFFSET,
+			      CONFIG_ENV_SF_LOG_SIZE);
+	if (ret)
+		return ret;
+	ret = env_sf_log_set_saved(env_new);
 	if (ret)
 		return ret;
+	log->base_crc = env_new->crc;
+	log->end = 0;
+	log->valid = true;
+	puts("done\n");
+
+	return 0;
+}
+#endif /* CONFIG_ENV_SF_LOG */
+
+static int env_sf_write(struct spi_flash *env_flash, env_t *env_new)
+{
+	u32	saved_size = 0, saved_offset = 0, sector;
+	u32	sect_size = CONFIG_ENV_SECT_SIZE;
+	char	*saved_buffer = NULL;
+	int	ret;
 
 	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
 		sect_size = env_flash->mtd.erasesize;
@@ -210,10 +446,8 @@ static int env_sf_save(void)
 		saved_size = sect_size - CONFIG_ENV_SIZE;
 		saved_offset = CONFIG_ENV_OFFSET + CONFIG_ENV_SIZE;
 		saved_buffer = malloc(saved_size);
-		if (!saved_buffer) {
-			ret = -ENOMEM;
-			goto done;
-		}
+		if (!saved_buffer)
+			return -ENOMEM;
 
 		ret = spi_flash_read(env_flash, saved_offset,
 			saved_size, saved_buffer);
@@ -221,10 +455,6 @@ static int env_sf_save(void)
 			goto done;
 	}
 
-	ret = env_export(&env_new);
-	if (ret)
-		goto done;
-
 	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, sect_size);
 
 	puts("Erasing SPI flash...");
@@ -235,7 +465,7 @@ static int env_sf_save(void)
 
 	puts("Writing to SPI flash...");
 	ret = spi_flash_write(env_flash, CONFIG_ENV_OFFSET,
-		CONFIG_ENV_SIZE, &env_new);
+		CONFIG_ENV_SIZE, env_new);
 	if (ret)
 		goto done;
 
@@ -250,14 +480,44 @@ static int env_sf_save(void)
 	puts("done\n");
 
 done:
-	spi_flash_free(env_flash);
-
 	if (saved_buffer)
 		free(saved_buffer);
 
 	return ret;
 }
 
+static int env_sf_save(void)
+{
+	int	ret;
+	env_t	env_new;
+	struct spi_flash *env_flash;
+
+	ret = setup_flash_device(&env_flash);
+	if (ret)
+		return ret;
+
+	ret = env_export(&env_new);
+	if (ret)
+		goto done;
+
+#ifdef CONFIG_ENV_SF_LOG
+	ret = env_sf_log_save(env_flash, &env_new);
+	if (ret != -ENOSPC && ret != -ENOMEM)
+		goto done;
+#endif
+
+	ret = env_sf_write(env_flash, &env_new);
+#ifdef CONFIG_ENV_SF_LOG
+	if (!ret)
+		ret = env_sf_log_reset(env_flash, &env_new);
+#endif
+
+done:
+	spi_flash_free(env_flash);
+
+	return ret;
+}
+
 static int env_sf_load(void)
 {
 	int ret;
@@ -284,6 +544,12 @@ static int env_sf_load(void)
 	ret = env_import(buf, 1, H_EXTERNAL);
 	if (!ret)
 		gd->env_valid = ENV_VALID;
+#ifdef CONFIG_ENV_SF_LOG
+	if (!ret)
+		env_sf_log_load(env_flash, (env_t *)buf);
+	else
+		env_sf_log.valid = false;
+#endif
 
 err_read:
 	spi_flash_free(env_flash);
@@ -305,6 +571,9 @@ static int env_sf_erase(void)
 		return ret;
 
 	memset(&env, 0, sizeof(env_t));
+#ifdef CONFIG_ENV_SF_LOG
+	env_sf_log.valid = false;
+#endif
 	ret = spi_flash_write(env_flash, CONFIG_ENV_OFFSET, CONFIG_ENV_SIZE, &env);
 	if (ret)
 		goto done;
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Lookups in, and import of, a read-only table of environment variables
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_table.h>
+#include <search.h>
+#include <linux/errno.h>
+
+const char *env_table_get(const struct env_table *tab, const char *name)
+{
+	unsigned int lo = 0, hi = tab->count;
+
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		const char *key = tab->strings + tab->index[mid];
+		int cmp = strcmp(name, key);
+
+		if (!cmp)
+			return key + strlen(key) + 1;
+		if (cmp < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return NULL;
+}
+
+int env_table_import(const struct env_table *tab, struct hsearch_data *htab,
+		     int flag)
+{
+	struct env_entry e, *rv;
+	unsigned int i;
+
+	if (CONFIG_IS_ENABLED(ENV_APPEND))
+		flag |= H_NOCLEAR;
+
+	if (!(flag & H_NOCLEAR) && htab->table)
+		hdestroy_r(htab);
+
+	/* size the hash table as himport_r() does */
+	if (!htab->table) {
+		int nent = CONFIG_ENV_MIN_ENTRIES + tab->size / 8;
+
+		if (nent > CONFIG_ENV_MAX_ENTRIES)
+			nent = CONFIG_ENV_MAX_ENTRIES;
+		if (!hcreate_r(nent, htab))
+			return 0;
+	}
+
+	for (i = 0; i < tab->count; i++) {
+		e.key = tab->strings + tab->index[i];
+		e.data = (char *)e.key + strlen(e.key) + 1;
+		hsearch_r(e, ENV_ENTER, &rv, htab, flag | H_NOCOPY);
+		if (!rv && !IS_ENABLED(CONFIG_ENV_WRITEABLE_LIST))
+			printf("env_table_import: can't insert \"%s=%s\" into hash table\n",
+			       e.key, e.data);
+	}
+
+	/* when not cleared, remove the variables the table deletes */
+	if (flag & H_NOCLEAR) {
+		for (i = 0; i < tab->deleted_count; i++)
+			hdelete_r(tab->strings + tab->deleted[i], htab, flag);
+	}
+
+	return 1;
+}
@@ -59,6 +59,80 @@ out:
 }
 #endif
 
+#if IS_ENABLED(CONFIG_FS_EROFS_ZIP_ZSTD)
+#include <linux/zstd.h>
+
+/* Decompression context, kept for all the physical clusters */
+static zstd_dctx *z_erofs_zstd_dctx;
+
+static int z_erofs_decompress_zstd(struct z_erofs_decompress_req *rq)
+{
+	int ret = 0;
+	char *dest = rq->out;
+	char *src = rq->in;
+	char *buff = NULL;
+	unsigned int inputmargin = 0;
+	zstd_frame_header fh;
+	size_t wsize, len;
+	void *workspace;
+
+	if (!z_erofs_zstd_dctx) {
+		wsize = zstd_dctx_workspace_bound();
+		workspace = malloc(wsize);
+		if (!workspace)
+			return -ENOMEM;
+		z_erofs_zstd_dctx = zstd_init_dctx(workspace, wsize);
+		if (!z_erofs_zstd_dctx) {
+			free(workspace);
+			return -EIO;
+		}
+	}
+
+	/* the compressed data is always at the end of the pcluster */
+	while (!src[inputmargin & (erofs_blksiz() - 1)])
+		if (!(++inputmargin & (erofs_blksiz() - 1)))
+			break;
+
+	if (inputmargin >= rq->inputsize)
+		return -EFSCORRUPTED;
+
+	if (zstd_get_frame_header(&fh, src + inputmargin,
+				  rq->inputsize - inputmargin) ||
+	    fh.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+	    fh.frameContentSize < rq->decodedlength)
+		return -EFSCORRUPTED;
+
+	/* the whole frame is decoded, though only part may be wanted */
+	if (rq->decodedskip || fh.frameContentSize != rq->decodedlength) {
+		buff = malloc(fh.frameContentSize);
+		if (!buff)
+			return -ENOMEM;
+		dest = buff;
+	}
+
+	len = zstd_decompress_dctx(z_erofs_zstd_dctx, dest, fh.frameContentSize,
+				   src + inputmargin,
+				   rq->inputsize - inputmargin);
+	if (zstd_is_error(len) || len != fh.frameContentSize) {
+		erofs_err("failed to decompress %d in[%u, %u] out[%u]",
+			  zstd_get_error_code(len), rq->inputsize, inputmargin,
+			  rq->decodedlength);
+		ret = -EIO;
+		goto out;
+	}
+
+	if (buff)
+		memcpy(rq->out, dest + rq->decodedskip,
+		       rq->decodedlength - rq->decodedskip);
+
+out:
+	if (buff)
+		free(buff);
+
+	return ret;
+}
+#endif
+
 int z_erofs_decompress(struct z_erofs_decompress_req *rq)
 {
 	if (rq->alg == Z_EROFS_COMPRESSION_INTERLACED) {
@@ -93,6 +167,10 @@ int z_erofs_decompress(struct z_erofs_decompress_req *rq)
 #if IS_ENABLED(CONFIG_LZ4)
 	if (rq->alg == Z_EROFS_COMPRESSION_LZ4)
 		return z_erofs_decompress_lz4(rq);
+#endif
+#if IS_ENABLED(CONFIG_FS_EROFS_ZIP_ZSTD)
+	if (rq->alg == Z_EROFS_COMPRESSION_ZSTD)
+		return z_erofs_decompress_zstd(rq);
 #endif
 	return -EOPNOTSUPP;
 }
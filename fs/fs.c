@@ -5,6 +5,7 @@
 
 #define LOG_CATEGORY LOGC_CORE
 
+#include <bootstage.h>
 #include <command.h>
 #include <config.h>
 #include <display_options.h>
@@ -19,6 +20,7 @@
 #include <ext4fs.h>
 #include <fat.h>
 #include <fs.h>
+#include <image.h>
 #include <sandboxfs.h>
 #include <semihostingfs.h>
 #include <ubifs_uboot.h>
@@ -561,6 +563,51 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 }
 #endif
 
+#if CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD)
+/*
+ * Read a file in pieces, so that the images of a FIT are hashed while they
+ * are still in the cache. Once the file is known not to be a FIT, or all of
+ * its images have been hashed, the rest is read at once.
+ */
+static int fs_read_hashed(struct fstype_info *info, const char *filename,
+			  ulong addr, loff_t len, loff_t *actread)
+{
+	loff_t pos = 0, chunk, got, step;
+	ulong align = SZ_4K;
+	void *buf;
+	int ret;
+
+	if (!len) {
+		ret = info->size(filename, &len);
+		if (ret)
+			return ret;
+	}
+
+	/* filesystems such as ubifs only read from page-aligned offsets */
+	if (fs_dev_desc && fs_dev_desc->blksz > align)
+		align = fs_dev_desc->blksz;
+	step = roundup(CONFIG_FIT_HASH_ON_LOAD_CHUNK, align);
+
+	fit_load_hash_start(addr);
+	do {
+		chunk = len - pos;
+		if (fit_load_hash_active())
+			chunk = min_t(loff_t, chunk, step);
+		buf = map_sysmem(addr + pos, chunk);
+		ret = info->read(filename, buf, pos, chunk, &got);
+		unmap_sysmem(buf);
+		if (ret)
+			break;
+		fit_load_hash_update(addr + pos, got);
+		pos += got;
+	} while (got == chunk && pos < len);
+	fit_load_hash_end(!ret, pos);
+	*actread = pos;
+
+	return ret;
+}
+#endif
+
 static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
@@ -580,9 +627,19 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * We don't actually know how many bytes are being read, since len==0
 	 * means read the whole file.
 	 */
-	buf = map_sysmem(addr, len);
-	ret = info->read(filename, buf, offset, len, actread);
-	unmap_sysmem(buf);
+#if CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD)
+	/* squashfs cannot read from an offset */
+	if (!offset && fs_type != FS_TYPE_SQUASHFS) {
+		ret = fs_read_hashed(info, filename, addr, len, actread);
+	} else
+#endif
+	{
+		buf = map_sysmem(addr, len);
+		ret = info->read(filename, buf, offset, len, actread);
+		unmap_sysmem(buf);
+		if (!ret)
+			fit_load_hash_update(addr, *actread);
+	}
 
 	/* If we requested a specific number of bytes, check we got it */
 	if (ret == 0 && len && *actread != len)
@@ -784,7 +841,9 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 		pos = 0;
 
 	time = get_timer(0);
+	bootstage_start(BOOTSTAGE_ID_ACCUM_LOAD, "load");
 	ret = _fs_read(filename, addr, pos, bytes, 1, &len_read);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_LOAD);
 	time = get_timer(time);
 	if (ret < 0) {
 		log_err("Failed to load '%s'\n", filename);
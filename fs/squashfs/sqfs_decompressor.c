@@ -104,21 +104,24 @@ static void zlib_decompression_status(int ret)
 #endif
 
 #if IS_ENABLED(CONFIG_ZSTD)
-static int sqfs_zstd_decompress(struct squashfs_ctxt *ctxt, void *dest,
-				unsigned long dest_len, void *source, u32 src_len)
+static size_t sqfs_zstd_decompress(struct squashfs_ctxt *ctxt, void *dest,
+				   unsigned long *dest_len, void *source,
+				   u32 src_len)
 {
 	ZSTD_DCtx *ctx;
 	size_t wsize;
-	int ret;
+	size_t ret;
 
 	wsize = zstd_dctx_workspace_bound();
 
 	ctx = zstd_init_dctx(ctxt->zstd_workspace, wsize);
 	if (!ctx)
-		return -EINVAL;
-	ret = zstd_decompress_dctx(ctx, dest, dest_len, source, src_len);
+		return -ZSTD_error_GENERIC;
+	ret = zstd_decompress_dctx(ctx, dest, *dest_len, source, src_len);
+	if (!zstd_is_error(ret))
+		*dest_len = ret;
 
-	return zstd_is_error(ret);
+	return ret;
 }
 #endif /* CONFIG_ZSTD */
 
@@ -163,14 +166,19 @@ int sqfs_decompress(struct squashfs_ctxt *ctxt, void *dest,
 		break;
 #endif
 #if IS_ENABLED(CONFIG_ZSTD)
-	case SQFS_COMP_ZSTD:
-		ret = sqfs_zstd_decompress(ctxt, dest, *dest_len, source, src_len);
-		if (ret) {
-			printf("ZSTD Error code: %d\n", zstd_get_error_code(ret));
+	case SQFS_COMP_ZSTD: {
+		size_t zstd_ret;
+
+		zstd_ret = sqfs_zstd_decompress(ctxt, dest, dest_len, source,
+						src_len);
+		if (zstd_is_error(zstd_ret)) {
+			printf("ZSTD Error code: %d\n",
+			       zstd_get_error_code(zstd_ret));
 			return -EINVAL;
 		}
 
 		break;
+	}
 #endif
 	default:
 		printf("Error: unknown compression type.\n");
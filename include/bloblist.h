@@ -147,6 +147,8 @@ enum bloblist_tag_t {
 	BLOBLISTT_U_BOOT_SPL_HANDOFF	= 0xfff000, /* Hand-off info from SPL */
 	BLOBLISTT_VBE			= 0xfff001, /* VBE per-phase state */
 	BLOBLISTT_U_BOOT_VIDEO		= 0xfff002, /* Video info from SPL */
+	BLOBLISTT_U_BOOT_LIVE_TREE	= 0xfff003, /* Live tree from SPL */
+	BLOBLISTT_U_BOOT_DM_TIMES	= 0xfff004, /* Driver model device stats */
 };
 
 /**
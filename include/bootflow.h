@@ -125,6 +125,8 @@ struct bootflow {
  * before using it
  * @BOOTFLOWIF_ALL: Return bootflows with errors as well
  * @BOOTFLOWIF_HUNT: Hunt for new bootdevs using the bootdrv hunters
+ * @BOOTFLOWIF_SKIP_NET: Don't hunt for or scan network bootdevs, so that
+ * nothing is sent on the network
  *
  * Internal flags:
  * @BOOTFLOWIF_SINGLE_DEV: (internal) Just scan one bootdev
@@ -139,6 +141,7 @@ enum bootflow_iter_flags_t {
 	BOOTFLOWIF_SHOW			= 1 << 1,
 	BOOTFLOWIF_ALL			= 1 << 2,
 	BOOTFLOWIF_HUNT			= 1 << 3,
+	BOOTFLOWIF_SKIP_NET		= 1 << 4,
 
 	/*
 	 * flags used internally by standard boot - do not set these when
@@ -556,4 +559,41 @@ int bootflow_cmdline_get_arg(struct bootflow *bflow, const char *arg,
  */
 int bootflow_cmdline_auto(struct bootflow *bflow, const char *arg);
 
+/**
+ * bootflow_prep_start() - Start preparing to boot in the background
+ *
+ * This starts a cyclic task which probes the Ethernet devices, hunts for
+ * bootdevs and scans them for bootflows until it finds a valid one, leaving out
+ * network bootdevs and global bootmeths. That bootflow becomes the current one
+ * and its files are read, if the bootmeth supports that. The work is done while
+ * U-Boot waits, e.g. for a key during the autoboot countdown.
+ *
+ * Return: 0 if OK, -EALREADY if already started, other -ve on error
+ */
+int bootflow_prep_start(void);
+
+/**
+ * bootflow_prep_finish() - Finish preparing to boot
+ *
+ * This waits for the task started by bootflow_prep_start() to complete. If
+ * @cancel is true, it stops after the current step and any bootflows found are
+ * dropped.
+ *
+ * @cancel: true to stop the preparation, false to let it complete
+ * Return: number of valid bootflows found (0 or 1), -ECANCELED if cancelled,
+ * -ENOENT if not started, other -ve on error
+ */
+int bootflow_prep_finish(bool cancel);
+
+/**
+ * bootflow_prep_take() - Get the bootflow prepared for booting
+ *
+ * This returns the bootflow found by bootflow_prep_start(), once the task has
+ * finished, so that it can be booted without scanning again. It can only be
+ * obtained once and is not returned if it is no-longer the current bootflow.
+ *
+ * Return: bootflow, or NULL if none
+ */
+struct bootflow *bootflow_prep_take(void);
+
 #endif
@@ -29,10 +29,17 @@ enum bootmeth_flags {
  *
  * @desc: A long description of the bootmeth
  * @flags: Flags for this bootmeth (enum bootmeth_flags)
+ * @needs: NULL-terminated list of devices which must be probed before this
+ *	bootmeth boots an OS, or NULL if none. Each is the name of a uclass,
+ *	meaning all its devices, or a devicetree path or alias. The bootmeth's
+ *	bind() method can set this, or it is read from the "u-boot,needs"
+ *	property of the bootmeth's node. This matters for devices which are
+ *	otherwise only set up when used, e.g. with CONFIG_DM_DEFERRED_PROBE
  */
 struct bootmeth_uc_plat {
 	const char *desc;
 	int flags;
+	const char *const *needs;
 };
 
 /** struct bootmeth_ops - Operations for boot methods */
@@ -213,6 +213,12 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_DRAM,
+	BOOTSTAGE_ID_ACCUM_SPL_LOAD,
+	BOOTSTAGE_ID_ACCUM_ENV,
+	BOOTSTAGE_ID_ACCUM_STORAGE,
+	BOOTSTAGE_ID_ACCUM_LOAD,
+	BOOTSTAGE_ID_ACCUM_VERIFY,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -70,6 +70,7 @@ typedef unsigned long ulong;
 
 /* Define these on the host so we can build some target code */
 typedef __u32 u32;
+typedef uint64_t u64;
 
 #define uswap_16(x) \
 	((((x) & 0xff00) >> 8) | \
@@ -51,12 +51,22 @@
 #define STDIN_GPIOBTN ""
 #endif
 
-#ifdef CONFIG_VIDEO
+/*
+ * With deferred probing, the display and USB keyboard are added to the console
+ * when the command line starts, so that autoboot does not wait for them
+ */
+#if defined(CONFIG_VIDEO) && !defined(CONFIG_DM_DEFERRED_PROBE)
 #define CONSOLE_STDOUT_SETTINGS \
 	"splashimage=" __stringify(CONFIG_SYS_LOAD_ADDR) "\0" \
 	"stdin=serial,"STDIN_GPIOBTN",usbkbd\0" \
 	"stdout=serial,vidconsole\0" \
 	"stderr=serial,vidconsole\0"
+#elif defined(CONFIG_VIDEO)
+#define CONSOLE_STDOUT_SETTINGS \
+	"splashimage=" __stringify(CONFIG_SYS_LOAD_ADDR) "\0" \
+	"stdin=serial,"STDIN_GPIOBTN"\0" \
+	"stdout=serial\0" \
+	"stderr=serial\0"
 #else
 #define CONSOLE_STDOUT_SETTINGS \
 	"stdin=serial,"STDIN_GPIOBTN"\0" \
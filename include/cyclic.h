@@ -124,4 +124,206 @@ static inline int cyclic_unregister_all(void)
 }
 #endif
 
+/* Return value of a task function which is waiting to run again */
+#define CYCLIC_TASK_WAIT	1
+
+struct cyclic_task;
+
+/**
+ * typedef cyclic_task_func_t - Function which runs the next step of a task
+ *
+ * A task is a function which is called repeatedly from schedule(), with each
+ * call doing a short step of the work. Tasks do not have their own stack, so
+ * a task records where it is in @task->state (or in its context) and returns
+ * when it needs to wait, using one of cyclic_task_yield(), cyclic_task_sleep()
+ * or cyclic_task_wait(). It must check @task->cancel and finish if it is set.
+ *
+ * @task: Task being run
+ * @ctx: Context passed to cyclic_task_start()
+ * Return: 0 if the task has finished, CYCLIC_TASK_WAIT to be called again
+ * later, or -ve error to finish the task with that error
+ */
+typedef int (*cyclic_task_func_t)(struct cyclic_task *task, void *ctx);
+
+/**
+ * struct cyclic_waitq - Something for tasks to wait on
+ *
+ * Tasks waiting on a queue run again when cyclic_task_wake() is called on it,
+ * or when its @poll function returns true. The poll function is called once
+ * each time the tasks are run while any task is waiting, so it can check the
+ * status of a device for all the tasks waiting on it.
+ *
+ * @poll: Function to check if the tasks should wake, or NULL if woken only by
+ *	cyclic_task_wake()
+ * @ctx: Context to pass to @poll
+ * @seq: Number of times the queue has been woken
+ * @polled: Value of the run counter when @poll was last called
+ */
+struct cyclic_waitq {
+	bool (*poll)(void *ctx);
+	void *ctx;
+	ulong seq;
+	ulong polled;
+};
+
+/**
+ * CYCLIC_WAITQ_INIT() - Set up a wait queue
+ *
+ * @_poll: Function to check if the tasks should wake, or NULL
+ * @_ctx: Context to pass to @_poll
+ */
+#define CYCLIC_WAITQ_INIT(_poll, _ctx)	{ .poll = (_poll), .ctx = (_ctx) }
+
+/**
+ * struct cyclic_task - A cooperative task
+ *
+ * This is provided by the caller of cyclic_task_start(), usually as part of
+ * its context, and must stay valid until the task is done.
+ *
+ * @func: Function to run the next step of the task
+ * @ctx: Context pointer to pass to @func
+ * @name: Name of the task, e.g. shown by 'cyclic list'
+ * @state: Where the task is up to, for use by @func; 0 at the start
+ * @ret: Result of the task once it is done
+ * @done: true once the task has finished
+ * @cancel: true if the task should finish as soon as possible
+ * @timed_out: true if the last wait on a queue timed out
+ * @already_warned: Flag that we've warned about exceeding CPU time usage
+ * @wq: Queue the task is waiting on, or NULL
+ * @wait_seq: Value of @wq->seq when the task started waiting
+ * @wake_us: Time in us at which to run the task again, or 0 if none
+ * @start_time_us: Time in us when the task was started
+ * @cpu_time_us: Total CPU time of this task
+ * @run_cnt: Number of steps run so far
+ * @sibling: Node in the list of tasks
+ */
+struct cyclic_task {
+	cyclic_task_func_t func;
+	void *ctx;
+	const char *name;
+	int state;
+	int ret;
+	bool done;
+	bool cancel;
+	bool timed_out;
+	bool already_warned;
+	struct cyclic_waitq *wq;
+	ulong wait_seq;
+	uint64_t wake_us;
+	uint64_t start_time_us;
+	uint64_t cpu_time_us;
+	uint64_t run_cnt;
+	struct list_head sibling;
+};
+
+#if CONFIG_IS_ENABLED(CYCLIC_TASK)
+/**
+ * cyclic_task_start() - Start a task
+ *
+ * The task runs its first step at the next schedule(). This can only be used
+ * after relocation.
+ *
+ * @task: Task to start, which must not already be running
+ * @func: Function to run each step of the task
+ * @name: Name of the task
+ * @ctx: Context to pass to @func
+ * Return: 0 if OK, -EPERM if called before relocation
+ */
+int cyclic_task_start(struct cyclic_task *task, cyclic_task_func_t func,
+		      const char *name, void *ctx);
+
+/**
+ * cyclic_task_yield() - Run the task again at the next schedule()
+ *
+ * @task: Task to wait
+ * Return: CYCLIC_TASK_WAIT, to be returned by the task function
+ */
+int cyclic_task_yield(struct cyclic_task *task);
+
+/**
+ * cyclic_task_sleep() - Run the task again after a delay
+ *
+ * @task: Task to wait
+ * @delay_us: Time to wait in microseconds
+ * Return: CYCLIC_TASK_WAIT, to be returned by the task function
+ */
+int cyclic_task_sleep(struct cyclic_task *task, uint64_t delay_us);
+
+/**
+ * cyclic_task_wait() - Run the task again when a queue is woken
+ *
+ * If the timeout expires first, @task->timed_out is set when the task runs.
+ *
+ * @task: Task to wait
+ * @wq: Queue to wait on
+ * @timeout_us: Time to wait in microseconds, or 0 to wait until woken
+ * Return: CYCLIC_TASK_WAIT, to be returned by the task function
+ */
+int cyclic_task_wait(struct cyclic_task *task, struct cyclic_waitq *wq,
+		     uint64_t timeout_us);
+
+/**
+ * cyclic_task_wake() - Wake all tasks waiting on a queue
+ *
+ * They run at the next schedule().
+ *
+ * @wq: Queue to wake
+ */
+void cyclic_task_wake(struct cyclic_waitq *wq);
+
+/**
+ * cyclic_task_cancel() - Ask a task to finish
+ *
+ * The task runs at the next schedule() with @task->cancel set, whatever it is
+ * waiting for. Use cyclic_task_join() to wait for it to finish.
+ *
+ * @task: Task to cancel
+ */
+void cyclic_task_cancel(struct cyclic_task *task);
+
+/**
+ * cyclic_task_join() - Wait for a task to finish
+ *
+ * This calls schedule() until the task is done, so other tasks and cyclic
+ * functions keep running. It cannot be used from a task or cyclic function.
+ *
+ * @task: Task to wait for
+ * @timeout_us: Time to wait in microseconds, or 0 to wait until done
+ * Return: result of the task, -ETIMEDOUT if it did not finish in time, or
+ * -EDEADLK if called from a task or cyclic function
+ */
+int cyclic_task_join(struct cyclic_task *task, uint64_t timeout_us);
+
+/**
+ * cyclic_task_run() - Run the next step of each task which is ready
+ *
+ * This is called by cyclic_run().
+ */
+void cyclic_task_run(void);
+
+/**
+ * cyclic_task_stop_all() - Cancel all tasks and finish them
+ *
+ * Each task is run once more with @task->cancel set, so that it can tidy up,
+ * and is then finished, with -ECANCELED if it did not finish by itself. This
+ * is called by cyclic_unregister_all().
+ */
+void cyclic_task_stop_all(void);
+
+/**
+ * cyclic_task_get_list() - Get the list of running tasks
+ *
+ * @return: pointer to the list, linked by &struct cyclic_task.sibling
+ */
+struct list_head *cyclic_task_get_list(void);
+#else
+static inline void cyclic_task_run(void)
+{
+}
+
+static inline void cyclic_task_stop_all(void)
+{
+}
+#endif
+
 #endif
@@ -429,6 +429,21 @@ static inline void devres_release_all(struct udevice *dev)
 
 #endif /* DEVRES */
 
+/**
+ * dev_stats_time() - Get the time to use for device stats
+ *
+ * Return: timer value in microseconds, or 0 if CONFIG_DM_PROBE_STATS is not
+ * enabled or the timer cannot be read yet
+ */
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+ulong dev_stats_time(void);
+#else
+static inline ulong dev_stats_time(void)
+{
+	return 0;
+}
+#endif
+
 static inline int device_notify(const struct udevice *dev, enum event_t type)
 {
 #if CONFIG_IS_ENABLED(DM_EVENT)
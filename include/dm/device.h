@@ -84,6 +84,21 @@ struct driver_info;
 /* Device must be probed after it was bound */
 #define DM_FLAG_PROBE_AFTER_BIND	(1 << 15)
 
+/*
+ * Probing the device after it was bound was deferred until it is used, or
+ * until dm_probe_deferred() is called (see CONFIG_DM_DEFERRED_PROBE)
+ */
+#define DM_FLAG_PROBE_DEFERRED		(1 << 16)
+
+/*
+ * Probing after bind may be left until the device is used (see
+ * CONFIG_DM_DEFERRED_PROBE). Only set this for devices whose probe does not
+ * set up hardware that must be ready before the OS starts, unlike gpio-hogs
+ * or LEDs which default to on. A uclass can allow it for all its devices with
+ * DM_UC_FLAG_PROBE_MAY_DEFER
+ */
+#define DM_FLAG_PROBE_MAY_DEFER		(1 << 17)
+
 /*
  * One or multiple of these flags are passed to device_remove() so that
  * a selective device removal as specified by the remove-stage and the
@@ -112,6 +127,29 @@ enum {
 	DM_REMOVE_NO_PD		= 1 << 1,
 };
 
+/**
+ * struct dm_dev_stats - Time taken by a device and memory allocated for it
+ *
+ * Times are in microseconds and are 0 if the timer was not running yet
+ *
+ * @bind_us: Time taken to bind the device, including any children bound by
+ *	its bind() or post_bind() methods
+ * @probe_us: Time taken by the last successful probe, not including reading
+ *	its device tree node or probing its parents
+ * @remove_us: Time taken by the last removal, not including its children
+ * @priv_bytes: Bytes allocated for the device's private data (priv_auto,
+ *	per_device_auto and per_child_auto), while it is probed
+ * @devres_bytes: Bytes allocated with devres while reading the device tree
+ *	node or probing, and not yet freed by removing the device
+ */
+struct dm_dev_stats {
+	u32 bind_us;
+	u32 probe_us;
+	u32 remove_us;
+	u32 priv_bytes;
+	u32 devres_bytes;
+};
+
 /**
  * struct udevice - An instance of a driver
  *
@@ -166,6 +204,7 @@ enum {
  * @dma_offset: Offset between the physical address space (CPU's) and the
  *		device's bus address space
  * @iommu: IOMMU device associated with this device
+ * @stats: Time taken by the device and memory allocated for it
  */
 struct udevice {
 	const struct driver *driver;
@@ -198,6 +237,9 @@ struct udevice {
 #if CONFIG_IS_ENABLED(IOMMU)
 	struct udevice *iommu;
 #endif
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+	struct dm_dev_stats stats;
+#endif
 };
 
 static inline int dm_udevice_size(void)
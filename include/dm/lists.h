@@ -12,6 +12,8 @@
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 
+struct udevice_id;
+
 /**
  * lists_driver_lookup_name() - Return u_boot_driver corresponding to name
  *
@@ -45,6 +47,20 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id);
  */
 int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 
+/**
+ * lists_driver_lookup_compat() - Find the driver for a compatible string
+ *
+ * This returns the first driver, in linker-list order, which has @compat in
+ * its of_match table. With CONFIG_DM_COMPAT_INDEX this uses a hash table
+ * after relocation, which is built on first use.
+ *
+ * @compat:	Compatible string to look up
+ * @idp:	Returns the matching entry in the driver's of_match table
+ * Return: driver, or NULL if no driver has @compat
+ */
+struct driver *lists_driver_lookup_compat(const char *compat,
+					  const struct udevice_id **idp);
+
 /**
  * lists_bind_fdt() - bind a device tree node
  *
@@ -258,6 +258,9 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
 /**
  * of_find_node_by_phandle() - Find a node given a phandle
  *
+ * With CONFIG_OF_PHANDLE_INDEX, lookups in the default device tree use a
+ * hash table, built on the first lookup and rebuilt if gd->of_root changes
+ *
  * @root:	root node to start from (NULL for default device tree)
  * @handle:	phandle of the node to find
  *
@@ -266,6 +269,14 @@ struct device_node *of_find_node_by_prop_value(struct device_node *from,
 struct device_node *of_find_node_by_phandle(struct device_node *root,
 					    phandle handle);
 
+/**
+ * of_reset_phandle_index() - Drop the index used by of_find_node_by_phandle()
+ *
+ * This must be called when nodes are removed from the default device tree
+ * or it is freed. The index is built again on the next lookup.
+ */
+void of_reset_phandle_index(void);
+
 /**
  * of_read_u8() - Find and read a 8-bit integer from a property
  *
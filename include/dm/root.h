@@ -136,6 +136,35 @@ int dm_scan_other(bool pre_reloc_only);
  */
 int dm_init_and_scan(bool pre_reloc_only);
 
+/**
+ * dm_probe_devices() - Probe devices which must be probed after they are bound
+ *
+ * This probes @dev and its children which ask for it (DM_FLAG_PROBE_AFTER_BIND)
+ * and, if @pre_reloc_only, are used before relocation. With
+ * CONFIG_DM_DEFERRED_PROBE, after relocation, those which allow it
+ * (DM_FLAG_PROBE_MAY_DEFER or DM_UC_FLAG_PROBE_MAY_DEFER) are marked with
+ * DM_FLAG_PROBE_DEFERRED instead. This is called by dm_init_and_scan()
+ *
+ * @dev: Device to start at, normally gd->dm_root
+ * @pre_reloc_only: true if only pre-relocation devices are probed
+ * Return: 0 if OK, -ve on error probing @dev
+ */
+int dm_probe_devices(struct udevice *dev, bool pre_reloc_only);
+
+/**
+ * dm_probe_deferred() - Probe devices whose probing was deferred
+ *
+ * With CONFIG_DM_DEFERRED_PROBE, devices which ask to be probed after they
+ * are bound (DM_FLAG_PROBE_AFTER_BIND) and allow it (DM_FLAG_PROBE_MAY_DEFER)
+ * are instead probed when first used after relocation. This probes any which
+ * have not been used yet, e.g. before the command line is started. Failures
+ * are reported but ignored.
+ *
+ * It then sends EVT_DM_PROBE_DEFERRED, so that boards can start anything
+ * else they left until the command line is needed.
+ */
+void dm_probe_deferred(void);
+
 /**
  * dm_init() - Initialise Driver Model structures
  *
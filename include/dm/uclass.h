@@ -50,6 +50,9 @@ struct udevice;
 /* Same as DM_FLAG_ALLOC_PRIV_DMA */
 #define DM_UC_FLAG_ALLOC_PRIV_DMA		(1 << 5)
 
+/* Same as DM_FLAG_PROBE_MAY_DEFER, for all members of this uclass */
+#define DM_UC_FLAG_PROBE_MAY_DEFER		(1 << 6)
+
 /**
  * struct uclass_driver - Driver for the uclass
  *
@@ -59,6 +59,74 @@ void dm_dump_driver_compat(void);
 /* Dump out a list of drivers with static platform data */
 void dm_dump_static_driver_info(void);
 
+/**
+ * dm_dump_times() - Dump the time taken by each device and its memory use
+ *
+ * This shows the struct dm_dev_stats and the probe state of each device, with
+ * the slowest to probe first, then the totals for all devices. This needs
+ * CONFIG_DM_PROBE_STATS
+ *
+ * @all: true to show all devices, false to show only those which are probed
+ *	or waiting for a deferred probe
+ */
+void dm_dump_times(bool all);
+
+/* Version of the BLOBLISTT_U_BOOT_DM_TIMES record */
+#define DM_TIMES_VERSION	1
+
+/**
+ * struct dm_times_hdr - Header of the BLOBLISTT_U_BOOT_DM_TIMES record
+ *
+ * This is followed by @count records of @rec_size bytes each, so that tools
+ * can read records from a newer version which adds fields at the end
+ *
+ * @version: DM_TIMES_VERSION
+ * @hdr_size: Size of this header in bytes
+ * @rec_size: Size of each struct dm_times_rec in bytes
+ * @count: Number of records
+ */
+struct dm_times_hdr {
+	u32 version;
+	u32 hdr_size;
+	u32 rec_size;
+	u32 count;
+};
+
+/**
+ * struct dm_times_rec - Record for one device in BLOBLISTT_U_BOOT_DM_TIMES
+ *
+ * The fields are as in struct dm_dev_stats
+ *
+ * @name: Device name, truncated if needed and nul-terminated
+ * @uclass_id: Uclass of the device (enum uclass_id)
+ * @bind_us: Time taken to bind the device
+ * @probe_us: Time taken to probe the device
+ * @remove_us: Time taken by the last removal of the device, if any
+ * @priv_bytes: Bytes allocated for the device's private data
+ * @devres_bytes: Bytes allocated with devres while probing
+ */
+struct dm_times_rec {
+	char name[32];
+	u32 uclass_id;
+	u32 bind_us;
+	u32 probe_us;
+	u32 remove_us;
+	u32 priv_bytes;
+	u32 devres_bytes;
+};
+
+/**
+ * dm_stash_times() - Write the stats for each probed device to the bloblist
+ *
+ * This adds a BLOBLISTT_U_BOOT_DM_TIMES record, or replaces the existing one,
+ * with a struct dm_times_hdr followed by a struct dm_times_rec for each device
+ * which is probed, slowest first. This needs CONFIG_DM_PROBE_STATS
+ *
+ * Return: 0 if OK, -ENOSYS if there is no bloblist, -ENOSPC if the bloblist
+ * is too small, -ENOMEM if out of memory
+ */
+int dm_stash_times(void);
+
 /**
  * dm_dump_mem() - Dump stats on memory usage in driver model
  *
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Read-only table of environment variables, sorted by name
+ *
+ * The default environment is normally a list of "name=value" strings, which
+ * is parsed on every boot. With CONFIG_ENV_DEFAULT_TABLE, env/mkenvtable
+ * also turns it into a table at build time, so that the default value of a
+ * variable can be found by a binary search and the environment can refer to
+ * the strings in the table until a variable is changed.
+ */
+
+#ifndef __ENV_TABLE_H
+#define __ENV_TABLE_H
+
+#include <linux/types.h>
+
+struct hsearch_data;
+
+/**
+ * struct env_table - read-only table of environment variables
+ *
+ * @strings:	name and value of each variable, each followed by a nul
+ * @size:	size of @strings in bytes
+ * @index:	offset of the name of each variable in @strings, in the order
+ *		of strcmp() on the names
+ * @count:	number of variables
+ * @deleted:	offset in @strings of the name of each variable which the
+ *		environment deletes, i.e. whose last entry has no value, in the
+ *		order of strcmp() on the names
+ * @deleted_count: number of variables deleted
+ */
+struct env_table {
+	const char *strings;
+	unsigned int size;
+	const unsigned int *index;
+	unsigned int count;
+	const unsigned int *deleted;
+	unsigned int deleted_count;
+};
+
+/* The default environment, generated at build time */
+extern const struct env_table env_default_table;
+
+/**
+ * env_table_get() - Get the value of a variable from a table
+ *
+ * @tab:	table to search
+ * @name:	name of the variable
+ * Return: value of the variable, or NULL if it is not in the table
+ */
+const char *env_table_get(const struct env_table *tab, const char *name);
+
+/**
+ * env_table_import() - Add the variables in a table to a hash table
+ *
+ * This has the same effect as himport_r() on the text the table was built
+ * from, but the hash table refers to the strings in @tab instead of copying
+ * them. They are copied when a variable is changed. With H_NOCLEAR, the
+ * variables which the table deletes are removed from @htab.
+ *
+ * @tab:	table to import
+ * @htab:	hash table to fill
+ * @flag:	flags for himport_r(), e.g. H_NOCLEAR to keep the existing
+ *		variables
+ * Return: 1 if OK, 0 on error, with errno set
+ */
+int env_table_import(const struct env_table *tab, struct hsearch_data *htab,
+		     int flag);
+
+/**
+ * env_table_owns() - Check if a string is part of the default table
+ *
+ * @str:	string to check
+ * Return: true if @str is in env_default_table, so must not be freed
+ */
+static inline bool env_table_owns(const void *str)
+{
+#if CONFIG_IS_ENABLED(ENV_DEFAULT_TABLE)
+	const char *strings = env_default_table.strings;
+
+	return (const char *)str >= strings &&
+	       (const char *)str < strings + env_default_table.size;
+#else
+	return false;
+#endif
+}
+
+#endif /* __ENV_TABLE_H */
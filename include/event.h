@@ -153,6 +153,16 @@ enum event_t {
 	 */
 	EVT_MAIN_LOOP,
 
+	/**
+	 * @EVT_DM_PROBE_DEFERRED:
+	 * This event is triggered by dm_probe_deferred() once devices whose
+	 * probe was deferred have been probed, i.e. when the command line is
+	 * about to start because autoboot did not happen. Boards can use it to
+	 * bring up anything else they left for later. Its parameter is NULL.
+	 * The return value is ignored.
+	 */
+	EVT_DM_PROBE_DEFERRED,
+
 	/**
 	 * @EVT_COUNT:
 	 * This constants holds the maximum event number + 1 and is used when
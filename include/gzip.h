@@ -45,6 +45,64 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 	   int stoponerr, int offset);
 
+/**
+ * struct gzip_member - member of an indexed gzip file
+ *
+ * A gzip file may consist of several members, each a complete gzip stream,
+ * whose decompressed data is concatenated. When every member records its
+ * size in an extra field of its header, a member can be found without
+ * decompressing those before it. Two kinds of fields are recognised:
+ *
+ *	'U','B', 8 bytes: compressed size of the member including its header
+ *		and trailer, then its uncompressed size, both little-endian
+ *		32-bit values. Written by tools/pgzip.py
+ *	'B','C', 2 bytes: compressed size less one, as written by bgzip
+ *
+ * A member with an uncompressed size of zero marks the end of the file.
+ *
+ * @offset:	offset of the member in the compressed data
+ * @size:	size of the member in the compressed data
+ * @uoffset:	offset of the member's data in the uncompressed data
+ * @usize:	size of the member's data
+ */
+struct gzip_member {
+	ulong offset;
+	ulong size;
+	u64 uoffset;
+	ulong usize;
+};
+
+/**
+ * gzip_find_member() - find the member of an indexed gzip file holding data
+ *
+ * @src:	gzip file
+ * @len:	size of @src in bytes
+ * @offset:	offset in the uncompressed data
+ * @m:		returns the member holding @offset
+ * Return: 0 if OK, -ENOENT if a member is not indexed, -EINVAL if the data
+ * is not a gzip file, -ERANGE if @offset is beyond the data, in which case
+ * @m->uoffset is set to the uncompressed size
+ */
+int gzip_find_member(const void *src, ulong len, u64 offset,
+		     struct gzip_member *m);
+
+/**
+ * gzip_read() - read part of the uncompressed data of an indexed gzip file
+ *
+ * Only the members holding the requested data are decompressed, so reading
+ * near the end of a large file is fast. The CRC of each member which is
+ * decompressed completely is checked.
+ *
+ * @src:	gzip file
+ * @len:	size of @src in bytes
+ * @offset:	offset in the uncompressed data to read from
+ * @dst:	buffer for the data
+ * @sizep:	on entry, number of bytes to read; on exit, number of bytes
+ *		read, which is less at the end of the data
+ * Return: 0 if OK, -ve on error, see gzip_find_member()
+ */
+int gzip_read(const void *src, ulong len, u64 offset, void *dst, ulong *sizep);
+
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
  * overrides:
@@ -76,6 +134,118 @@ void gzwrite_progress_finish(int retcode, ulong totalwritten, ulong totalsize,
 int gzwrite(unsigned char *src, int len, struct blk_desc *dev, ulong szwritebuf,
 	    ulong startoffs, ulong szexpected);
 
+/**
+ * enum gzwrite_flags - options for gzwrite_flags()
+ *
+ * @GZWRITE_SKIP_ZERO:	do not write blocks of the output which are all zero.
+ *			Only use this if the destination is known to be
+ *			zeroed, e.g. after erasing it
+ * @GZWRITE_ERASE_ZERO:	erase blocks of the output which are all zero rather
+ *			than writing them, e.g. with eMMC TRIM. Only use this
+ *			if the device reads erased blocks as zero. Blocks are
+ *			written if the device cannot erase them
+ */
+enum gzwrite_flags {
+	GZWRITE_SKIP_ZERO	= 1 << 0,
+	GZWRITE_ERASE_ZERO	= 1 << 1,
+};
+
+/**
+ * gzwrite_flags() - decompress and write gzipped image, with options
+ *
+ * This is gzwrite() with handling of sparse output. The time spent
+ * decompressing and writing is reported separately.
+ *
+ * @src:	compressed image address
+ * @len:	compressed image length in bytes
+ * @dev:	block device descriptor
+ * @szwritebuf:	bytes per write (pad to erase size)
+ * @startoffs:	offset in bytes of first write
+ * @szexpected:	expected uncompressed length, may be zero to use the index
+ *		(see struct gzip_member), or else the gzip trailer for files
+ *		under 4GiB
+ * @flags:	GZWRITE_... flags
+ * Return: 0 if OK, -1 on error
+ */
+int gzwrite_flags(unsigned char *src, int len, struct blk_desc *dev,
+		  ulong szwritebuf, ulong startoffs, ulong szexpected,
+		  uint flags);
+
+/**
+ * gzwrite_resume() - continue an interrupted gzwrite
+ *
+ * This is gzwrite_flags() starting at @offset in the uncompressed data,
+ * which is written at @startoffs + @offset. Only the members from the one
+ * holding @offset on are decompressed, so the file must be indexed (see
+ * struct gzip_member) unless @offset is 0. Files made of several members
+ * are accepted whether or not they are indexed.
+ *
+ * @src:	compressed image address
+ * @len:	compressed image length in bytes
+ * @dev:	block device descriptor
+ * @szwritebuf:	bytes per write (pad to erase size)
+ * @startoffs:	offset in bytes of first write
+ * @szexpected:	expected uncompressed length, may be zero to use the index,
+ *		or else the gzip trailer for files under 4GiB
+ * @flags:	GZWRITE_... flags
+ * @offset:	offset in the uncompressed data to start at, a multiple of the
+ *		block size
+ * Return: 0 if OK, -1 on error
+ */
+int gzwrite_resume(unsigned char *src, int len, struct blk_desc *dev,
+		   ulong szwritebuf, ulong startoffs, ulong szexpected,
+		   uint flags, ulong offset);
+
+struct gzwrite_stream;
+
+/* Longest gzip header accepted by the streaming gzwrite */
+#define GZWRITE_STREAM_HDR_MAX	512
+
+/**
+ * gzwrite_stream_start() - start decompressing a gzip file to a block device
+ *
+ * Unlike gzwrite(), the compressed data is passed in pieces as it becomes
+ * available, with gzwrite_stream_feed(). The data may consist of several
+ * members; the CRC and size of each are checked against its trailer.
+ *
+ * @dev:	block device descriptor
+ * @szwritebuf:	bytes per write (pad to erase size)
+ * @startoffs:	offset in bytes of first write
+ * @szexpected:	expected uncompressed length, 0 if unknown
+ * @flags:	GZWRITE_... flags
+ * Return: stream state, or NULL on error
+ */
+struct gzwrite_stream *gzwrite_stream_start(struct blk_desc *dev,
+					    ulong szwritebuf, ulong startoffs,
+					    ulong szexpected, uint flags);
+
+/**
+ * gzwrite_stream_feed() - decompress and write the next part of a gzip file
+ *
+ * @gs:		stream state
+ * @src:	compressed data
+ * @len:	number of bytes at @src
+ * Return: 0 if OK, -1 on error
+ */
+int gzwrite_stream_feed(struct gzwrite_stream *gs, const void *src, ulong len);
+
+/**
+ * gzwrite_stream_finish() - write the remaining data and check the trailer
+ *
+ * The stream state is freed.
+ *
+ * @gs:		stream state
+ * Return: 0 if OK, -1 if the data is truncated, corrupt or cannot be written
+ */
+int gzwrite_stream_finish(struct gzwrite_stream *gs);
+
+/**
+ * gzwrite_stream_free() - abandon a streaming gzwrite
+ *
+ * @gs:		stream state
+ */
+void gzwrite_stream_free(struct gzwrite_stream *gs);
+
 /**
  * gzip()- Compress data into a buffer using the gzip algorithm
  *
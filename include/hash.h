@@ -120,6 +120,18 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size);
 
+/**
+ * hash_bench() - Measure the speed of hash algorithms
+ *
+ * Hashes a memory area and prints the time taken and the throughput.
+ *
+ * @algo_name:		Hash algorithm to use, or NULL for all algorithms
+ * @addr:		Address of the data to hash
+ * @len:		Length of data to hash in bytes
+ * Return: 0 if ok, -EPROTONOSUPPORT for an unknown algorithm
+ */
+int hash_bench(const char *algo_name, ulong addr, ulong len);
+
 #endif /* !USE_HOSTCC */
 
 /**
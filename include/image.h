@@ -443,8 +443,9 @@ extern struct bootm_headers images;
 #define CHUNKSZ_MD5 (64 * 1024)
 #endif
 
+/* SHA-1 is fast enough that larger chunks still reset the watchdog often */
 #ifndef CHUNKSZ_SHA1
-#define CHUNKSZ_SHA1 (64 * 1024)
+#define CHUNKSZ_SHA1 (256 * 1024)
 #endif
 
 #define uimage_to_cpu(x)		be32_to_cpu(x)
@@ -1022,6 +1023,34 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		 void *load_buf, void *image_buf, ulong image_len,
 		 uint unc_len, ulong *load_end);
 
+/**
+ * image_decomp_size() - find the size of an image once decompressed
+ *
+ * This reads the size recorded in the compressed data, for gzip, lz4 and
+ * zstd. The size is not checked until the image is decompressed.
+ *
+ * @comp:	Compression algorithm that is used (IH_COMP_...)
+ * @buf:	Compressed image
+ * @len:	Size of the compressed image in bytes
+ * @sizep:	Returns the decompressed size in bytes
+ * Return: 0 if OK, -ENOENT if the image does not record its size, -EINVAL if
+ * the image is not valid, -ENOSYS if not supported for @comp
+ */
+int image_decomp_size(int comp, const void *buf, ulong len, ulong *sizep);
+
+/**
+ * image_decomp_margin() - find the space needed to decompress in place
+ *
+ * An image can be decompressed in place if the compressed data ends at least
+ * this many bytes after the end of the decompressed data, so that the output
+ * never catches up with the input which is still to be read.
+ *
+ * @comp:	Compression algorithm that is used (IH_COMP_GZIP, _LZ4 or _ZSTD)
+ * @size:	Size of the decompressed image in bytes
+ * Return: number of bytes needed after the decompressed data
+ */
+ulong image_decomp_margin(int comp, ulong size);
+
 /**
  * Set up properties in the FDT
  *
@@ -1350,6 +1379,145 @@ static inline int fit_config_verify(const void *fit, int conf_noffset)
 #endif
 int fit_all_image_verify(const void *fit);
 int fit_config_decrypt(const void *fit, int conf_noffset);
+
+#if CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD) && !defined(USE_HOSTCC)
+/**
+ * fit_load_hash_start() - start hashing the images of a FIT being loaded
+ *
+ * Loaders call this when they start loading a file. If the data turns out
+ * to be a FIT, the data of its images is hashed as it is loaded, so that
+ * verifying the images later does not have to read it again. See
+ * fit_load_hash_get().
+ *
+ * @addr:	Address the data is loaded to
+ */
+void fit_load_hash_start(ulong addr);
+
+/**
+ * fit_load_hash_update() - report data which has been loaded
+ *
+ * Loaders call this for all data they write to memory, whether or not
+ * hashing was started, so that digests of data which is overwritten are
+ * dropped. Data continuing what was hashed so far is hashed; a loader which
+ * stores data out of order may instead report everything up to the first
+ * gap each time.
+ *
+ * @addr:	Address of the data
+ * @len:	Number of bytes
+ */
+void fit_load_hash_update(ulong addr, ulong len);
+
+/**
+ * fit_load_hash_end() - finish hashing the images of a load
+ *
+ * Data which was loaded out of order and not reported again is hashed now.
+ *
+ * @ok:		true if the load completed, false to drop its digests
+ * @size:	Number of bytes loaded
+ */
+void fit_load_hash_end(bool ok, ulong size);
+
+/**
+ * fit_load_hash_forget() - drop the digests of data which is overwritten
+ *
+ * Code which writes to memory outside a load which is being hashed calls
+ * this, so that the digests of images it overwrites are not used.
+ *
+ * @addr:	Address of the data written
+ * @len:	Number of bytes
+ */
+void fit_load_hash_forget(ulong addr, ulong len);
+
+/**
+ * fit_load_hash_active() - check whether a load is being hashed
+ *
+ * Return: true if the current load may be a FIT whose images are still to be
+ * hashed, false once the rest of the load holds no such image
+ */
+bool fit_load_hash_active(void);
+
+/**
+ * fit_load_hash_get() - get the digest of data hashed while it was loaded
+ *
+ * The digest is dropped once it has been returned, so it is used only once.
+ * No digest is returned if the control devicetree has a required key, since
+ * not all writes to memory are tracked.
+ *
+ * @data:	Image data
+ * @size:	Size of the data in bytes
+ * @algo:	Name of the hash algorithm
+ * @value:	Returns the digest
+ * @value_len:	Returns the size of the digest
+ * Return: 0 if OK, -ENOENT if the data was not hashed with @algo or a
+ * signature is required
+ */
+int fit_load_hash_get(const void *data, ulong size, const char *algo,
+		      uint8_t *value, int *value_len);
+#else
+static inline void fit_load_hash_start(ulong addr)
+{
+}
+
+static inline void fit_load_hash_update(ulong addr, ulong len)
+{
+}
+
+static inline void fit_load_hash_end(bool ok, ulong size)
+{
+}
+
+static inline void fit_load_hash_forget(ulong addr, ulong len)
+{
+}
+
+static inline bool fit_load_hash_active(void)
+{
+	return false;
+}
+
+static inline int fit_load_hash_get(const void *data, ulong size,
+				    const char *algo, uint8_t *value,
+				    int *value_len)
+{
+	return -ENOENT;
+}
+#endif
+
+/**
+ * struct fit_read_info - source of a FIT for fit_read()
+ *
+ * @read:	Read @size bytes at offset @pos in the FIT to @buf. Returns the
+ *		number of bytes read, or -ve on error
+ * @priv:	Private data for @read
+ */
+struct fit_read_info {
+	long (*read)(struct fit_read_info *info, ulong pos, ulong size,
+		     void *buf);
+	void *priv;
+};
+
+/**
+ * fit_read() - read the parts of a FIT used by a configuration
+ *
+ * This reads the devicetree of a FIT to @addr, followed by the external data
+ * of the images used by the configuration. Images which are not compressed
+ * or encrypted and have a load address are read straight to that address,
+ * other images to the position they have in the FIT. The devicetree in
+ * memory is updated so that fit_image_load() finds the data.
+ *
+ * Images with embedded data are read with the devicetree, so this reads all
+ * of a FIT without external data.
+ *
+ * @info:	Source of the FIT
+ * @addr:	Address to read the FIT to
+ * @conf_name:	Name of the configuration, or NULL for the default one
+ * @sizep:	Returns the size of the memory used at @addr
+ * Return: 0 if OK, -ENOEXEC if the data is not a FIT, -ENOENT if the
+ * configuration does not exist, other -ve value on error
+ */
+int fit_read(struct fit_read_info *info, ulong addr, const char *conf_name,
+	     ulong *sizep);
+
 int fit_image_check_os(const void *fit, int noffset, uint8_t os);
 int fit_image_check_arch(const void *fit, int noffset, uint8_t arch);
 int fit_image_check_type(const void *fit, int noffset, uint8_t type);
@@ -1362,7 +1530,11 @@ int fit_image_check_comp(const void *fit, int noffset, uint8_t comp);
  * use, looking for mandatory properties, nodes, etc.
  *
  * If FIT_FULL_CHECK is enabled, it also runs it through libfdt to make
- * sure that there are no strange tags or broken nodes in the FIT.
+ * sure that there are no strange tags or broken nodes in the FIT. With
+ * FIT_CHECK_USED, this is left to fit_image_load(), for the nodes it uses.
+ *
+ * With FIT_INDEX, a FIT which passed the checks and has not changed since is
+ * not checked again, unless FIT_FULL_CHECK or FIT_SIGNATURE is enabled.
  *
  * @fit: pointer to the FIT format image header
  * Return: 0 if OK, -ENOEXEC if not an FDT file, -EINVAL if the full FDT check
@@ -1372,6 +1544,95 @@ int fit_image_check_comp(const void *fit, int noffset, uint8_t comp);
  */
 int fit_check_format(const void *fit, ulong size);
 
+#if CONFIG_IS_ENABLED(FIT_INDEX) && !defined(USE_HOSTCC)
+/**
+ * fit_index_check() - check whether a FIT is indexed and unchanged
+ *
+ * This checks the CRC32 of the devicetree and drops the index if it changed.
+ * The lookup functions below only check the address and header of the FIT.
+ *
+ * @fit:	FIT to check
+ * Return: 0 if the FIT passed fit_check_format() and has not changed since,
+ * -ENOENT otherwise
+ */
+int fit_index_check(const void *fit);
+
+/**
+ * fit_index_add() - index a FIT which passed fit_check_format()
+ *
+ * This replaces the index of any other FIT.
+ *
+ * @fit:	FIT to index
+ */
+void fit_index_add(const void *fit);
+
+/**
+ * fit_index_path() - find the /images or /configurations node in the index
+ *
+ * @fit:	FIT to look in
+ * @path:	FIT_IMAGES_PATH or FIT_CONFS_PATH
+ * Return: node offset, or -ENOENT if it is not in the index
+ */
+int fit_index_path(const void *fit, const char *path);
+
+/**
+ * fit_index_image() - find an image node in the index
+ *
+ * @fit:	FIT to look in
+ * @name:	Name of the image, as for fit_image_get_node()
+ * Return: node offset, or -ENOENT if it is not in the index
+ */
+int fit_index_image(const void *fit, const char *name);
+
+/**
+ * fit_index_get_compat() - get the result of fit_conf_find_compat()
+ *
+ * @fit:	FIT to look in
+ * @fdt:	Devicetree whose compatible strings were matched
+ * Return: result recorded by fit_index_set_compat(), or -ENOENT if none is
+ * recorded for @fdt with its current compatible strings
+ */
+int fit_index_get_compat(const void *fit, const void *fdt);
+
+/**
+ * fit_index_set_compat() - record the result of fit_conf_find_compat()
+ *
+ * @fit:	FIT the configuration is in
+ * @fdt:	Devicetree whose compatible strings were matched
+ * @conf:	Configuration node offset, or -1 if none matched
+ */
+void fit_index_set_compat(const void *fit, const void *fdt, int conf);
+#else
+static inline int fit_index_check(const void *fit)
+{
+	return -ENOENT;
+}
+
+static inline void fit_index_add(const void *fit)
+{
+}
+
+static inline int fit_index_path(const void *fit, const char *path)
+{
+	return -ENOENT;
+}
+
+static inline int fit_index_image(const void *fit, const char *name)
+{
+	return -ENOENT;
+}
+
+static inline int fit_index_get_compat(const void *fit, const void *fdt)
+{
+	return -ENOENT;
+}
+
+static inline void fit_index_set_compat(const void *fit, const void *fdt,
+					int conf)
+{
+}
+#endif
+
 /**
  * fit_conf_find_compat() - find most compatible configuration
  * @fit: pointer to the FIT format image header
@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Builtin symbol table
+ *
+ * With CONFIG_KALLSYMS U-Boot is linked twice, the second time with a table of
+ * the address and name of each function from the first, so that code addresses
+ * can be shown by name.
+ */
+
+#ifndef __KALLSYMS_H
+#define __KALLSYMS_H
+
+/**
+ * symbol_lookup() - Find the function containing an address
+ *
+ * The address is the link-time address, so subtract gd->reloc_off from a
+ * run-time address before calling this.
+ *
+ * @addr: Address to look up
+ * @caddr: Returns the start address of the function, or 0 if none
+ * Return: name of the function, or NULL if not found
+ */
+#if CONFIG_IS_ENABLED(KALLSYMS)
+const char *symbol_lookup(unsigned long addr, unsigned long *caddr);
+#else
+static inline const char *symbol_lookup(unsigned long addr,
+					unsigned long *caddr)
+{
+	*caddr = 0;
+
+	return NULL;
+}
+#endif
+
+#endif /* __KALLSYMS_H */
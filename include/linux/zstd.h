@@ -220,6 +220,26 @@ zstd_dctx *zstd_init_dctx(void *workspace, size_t workspace_size);
 size_t zstd_decompress_dctx(zstd_dctx *dctx, void *dst, size_t dst_capacity,
 	const void *src, size_t src_size);
 
+/**
+ * zstd_decompress_using_dict() - decompress zstd compressed src with a dict
+ * @dctx:         The decompression context.
+ * @dst:          The buffer to decompress src into.
+ * @dst_capacity: The size of the destination buffer.
+ * @src:          The zstd compressed data to decompress.
+ * @src_size:     The exact size of the data to decompress.
+ * @dict:         The dictionary the data was compressed with, either trained
+ *                with `zstd --train` or raw content.
+ * @dict_size:    The size of the dictionary.
+ *
+ * The dictionary is loaded into the context on each call.
+ *
+ * Return:        The decompressed size or an error, which can be checked using
+ *                zstd_is_error().
+ */
+size_t zstd_decompress_using_dict(zstd_dctx *dctx, void *dst,
+	size_t dst_capacity, const void *src, size_t src_size,
+	const void *dict, size_t dict_size);
+
 /* ======   Streaming Buffers   ====== */
 
 /**
@@ -444,15 +464,70 @@ typedef ZSTD_frameHeader zstd_frame_header;
 size_t zstd_get_frame_header(zstd_frame_header *params, const void *src,
 	size_t src_size);
 
+/**
+ * zstd_get_dict_id_from_dict() - returns the ID of a dictionary
+ * @dict:      The dictionary.
+ * @dict_size: The size of the dictionary.
+ *
+ * Return:     The ID of a trained dictionary, or 0 for raw content.
+ */
+unsigned int zstd_get_dict_id_from_dict(const void *dict, size_t dict_size);
+
+/**
+ * zstd_get_dict_id_from_frame() - returns the ID of the dictionary of a frame
+ * @src:      The source buffer. It must point to a zstd frame.
+ * @src_size: The size of the source buffer.
+ *
+ * Return:    The ID of the dictionary needed to decompress the frame, or 0 if
+ *            none is needed, the ID is not recorded or the header is invalid.
+ */
+unsigned int zstd_get_dict_id_from_frame(const void *src, size_t src_size);
+
 struct abuf;
+struct blk_desc;
 
 /**
  * zstd_decompress() - Decompress Zstandard data
  *
+ * Data compressed with a dictionary is decompressed with the built-in
+ * dictionary (CONFIG_ZSTD_DICT_FILE) if it has the ID recorded in the frame.
+ *
  * @in: Input buffer to decompress
  * @out: Output buffer to hold the results (must be large enough)
- * Return: size of the decompressed data, or -ve on error
+ * Return: size of the decompressed data, -ENOKEY if the dictionary needed is
+ * not available, or other -ve on error
  */
 int zstd_decompress(struct abuf *in, struct abuf *out);
 
+/**
+ * zstd_decompress_dict() - Decompress Zstandard data with a dictionary
+ *
+ * @in: Input buffer to decompress
+ * @out: Output buffer to hold the results (must be large enough)
+ * @dict: Dictionary the data was compressed with, or NULL for none
+ * @dict_size: Size of @dict in bytes
+ * Return: size of the decompressed data, or -ve on error
+ */
+int zstd_decompress_dict(struct abuf *in, struct abuf *out, const void *dict,
+			 size_t dict_size);
+
+/**
+ * zstd_write() - Decompress Zstandard data and write it to a block device
+ *
+ * The data is decompressed in pieces of @szwritebuf bytes, so it may be
+ * larger than the available memory. It may consist of several frames, which
+ * are written one after another. Any data after the last frame is ignored.
+ *
+ * @src: Compressed data
+ * @len: Size of @src in bytes
+ * @dev: Block device to write to
+ * @szwritebuf: Bytes per write, a multiple of the block size
+ * @startoffs: Offset in bytes of the first write, a multiple of the block size
+ * @szexpected: Expected uncompressed size, 0 to use the sizes recorded in the
+ *	frames, if any
+ * Return: 0 if OK, -ve on error
+ */
+int zstd_write(const void *src, ulong len, struct blk_desc *dev,
+	       ulong szwritebuf, u64 startoffs, u64 szexpected);
+
 #endif  /* LINUX_ZSTD_H */
@@ -999,6 +999,226 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/**
+ * malloc_testing_active() - Check if malloc() is in test mode
+ *
+ * Return: true if malloc_enable_testing() is in effect
+ */
+bool malloc_testing_active(void);
+
+/**
+ * struct malloc_pool_stats - Usage of one malloc pool size class
+ *
+ * @size: Size of each object in bytes
+ * @in_use: Number of objects allocated
+ * @peak: Highest number of objects allocated at once
+ * @slabs: Number of slabs used by the class
+ * @fallbacks: Number of allocations which used calloc() instead, since there
+ *	were no slabs left
+ */
+struct malloc_pool_stats {
+	uint size;
+	uint in_use;
+	uint peak;
+	uint slabs;
+	uint fallbacks;
+};
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_POOL)
+/**
+ * pool_calloc() - Allocate zeroed memory for a small object
+ *
+ * This is the same as calloc(), but uses the pools if the size is small
+ * enough, which is faster and has no per-object overhead. The memory is
+ * freed with free() as normal.
+ *
+ * @nmemb: Number of elements
+ * @size: Size of each element
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *pool_calloc(size_t nmemb, size_t size);
+
+/**
+ * malloc_pool_init() - Set up the pools at the start of the malloc() area
+ *
+ * @start: Start of the malloc() area
+ * @size: Size of the malloc() area
+ * Return: number of bytes taken from the start of the area for the pools
+ */
+ulong malloc_pool_init(ulong start, ulong size);
+
+/**
+ * malloc_pool_free() - Free an object if it came from the pools
+ *
+ * @ptr: Memory to free
+ * Return: true if freed, false if @ptr is not from the pools
+ */
+bool malloc_pool_free(void *ptr);
+
+/**
+ * malloc_pool_usable_size() - Get the usable size of an object from the pools
+ *
+ * @ptr: Memory to check
+ * Return: size of its class in bytes, or 0 if @ptr is not from the pools
+ */
+size_t malloc_pool_usable_size(const void *ptr);
+
+/**
+ * malloc_pool_realloc() - Resize an object from the pools
+ *
+ * The object stays where it is if @size fits in its class, otherwise it is
+ * moved to memory from malloc()
+ *
+ * @ptr: Object to resize, which must be from the pools
+ * @size: New size in bytes
+ * Return: pointer to the object, or NULL if out of memory
+ */
+void *malloc_pool_realloc(void *ptr, size_t size);
+
+/**
+ * malloc_pool_in_use() - Get the number of bytes allocated from the pools
+ *
+ * Return: total size of the objects allocated, using the size of their class
+ */
+ulong malloc_pool_in_use(void);
+
+/**
+ * malloc_pool_get_stats() - Get the usage of each pool size class
+ *
+ * @stats: Returns the usage of each class, smallest first
+ * @max: Number of entries in @stats
+ * Return: number of entries filled in
+ */
+int malloc_pool_get_stats(struct malloc_pool_stats *stats, int max);
+
+/** malloc_pool_info() - Show the usage of each pool size class */
+void malloc_pool_info(void);
+#else
+static inline void *pool_calloc(size_t nmemb, size_t size)
+{
+	return calloc(nmemb, size);
+}
+
+static inline bool malloc_pool_free(void *ptr)
+{
+	return false;
+}
+#endif
+
+/**
+ * struct malloc_trace_rec - Record of a live allocation
+ *
+ * @ptr: Address of the memory
+ * @caller: Address the allocation was made from
+ * @time_us: Time of the allocation in microseconds, or 0 if the timer was
+ *	not ready
+ * @size: Size requested in bytes
+ */
+struct malloc_trace_rec {
+	ulong ptr;
+	ulong caller;
+	ulong time_us;
+	ulong size;
+};
+
+/**
+ * struct malloc_trace_stats - Totals for the traced allocations
+ *
+ * @count: Number of live allocations
+ * @bytes: Total size of the live allocations
+ * @peak_count: Number of live allocations at the high-water mark
+ * @peak_bytes: Highest value of @bytes
+ * @peak_us: Time at which @peak_bytes was reached
+ * @allocs: Number of allocations since tracing started
+ * @dropped: Number of allocations not traced since all records were in use
+ * @mark_us: Time of the last malloc_trace_mark(), or 0 if none
+ */
+struct malloc_trace_stats {
+	ulong count;
+	ulong bytes;
+	ulong peak_count;
+	ulong peak_bytes;
+	ulong peak_us;
+	ulong allocs;
+	ulong dropped;
+	ulong mark_us;
+};
+
+#if CONFIG_IS_ENABLED(MALLOC_TRACE)
+/**
+ * malloc_trace_init() - Set up tracing at the start of the malloc() area
+ *
+ * @start: Start of the malloc() area
+ * @size: Size of the malloc() area
+ * Return: number of bytes taken from the start of the area for the records
+ */
+ulong malloc_trace_init(ulong start, ulong size);
+
+/**
+ * malloc_trace_alloc() - Record an allocation
+ *
+ * This replaces any existing record for @ptr, so an allocator may record an
+ * allocation which it passes on, leaving its caller to record it again.
+ *
+ * @ptr: Memory allocated, or NULL if the allocation failed
+ * @size: Size requested in bytes
+ * @caller: Address the allocation was made from
+ */
+void malloc_trace_alloc(void *ptr, size_t size, void *caller);
+
+/**
+ * malloc_trace_free() - Remove the record of an allocation
+ *
+ * @ptr: Memory being freed; nothing happens if it has no record
+ */
+void malloc_trace_free(void *ptr);
+
+/**
+ * malloc_trace_find() - Find the record of an allocation
+ *
+ * @ptr: Memory to look up
+ * Return: record, or NULL if @ptr is not traced
+ */
+const struct malloc_trace_rec *malloc_trace_find(const void *ptr);
+
+/**
+ * malloc_trace_get_stats() - Get the totals for the traced allocations
+ *
+ * @stats: Returns the totals
+ */
+void malloc_trace_get_stats(struct malloc_trace_stats *stats);
+
+/**
+ * malloc_trace_mark() - Start a new period for finding leaks
+ *
+ * This notes the time so that malloc_trace_dump() can show only allocations
+ * made since, and resets the high-water mark to the current usage.
+ */
+void malloc_trace_mark(void);
+
+/**
+ * malloc_trace_dump() - Show the live allocations, grouped by caller
+ *
+ * The callers are shown by name if CONFIG_KALLSYMS is enabled, those with the
+ * most memory first.
+ *
+ * @since_mark: true to show only allocations made since malloc_trace_mark()
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int malloc_trace_dump(bool since_mark);
+
+/** malloc_trace_info() - Show the totals and the high-water mark */
+void malloc_trace_info(void);
+#else
+static inline void malloc_trace_alloc(void *ptr, size_t size, void *caller)
+{
+}
+
+static inline void malloc_trace_free(void *ptr)
+{
+}
+#endif
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
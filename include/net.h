@@ -559,7 +559,23 @@ extern int net_ntp_time_offset;			/* offset time from UTC */
 
 /* Initialize the network adapter */
 int net_init(void);
-int net_loop(enum proto_t);
+
+/**
+ * net_loop_size() - run a network protocol until it completes
+ *
+ * @protocol:	protocol to run
+ * @sizep:	returns the number of bytes transferred, if not NULL
+ * Return: 0 if OK, -ve on error
+ */
+int net_loop_size(enum proto_t protocol, ulong *sizep);
+
+/**
+ * net_loop() - run a network protocol until it completes
+ *
+ * Return: number of bytes transferred, -EFBIG if that does not fit in an int,
+ * or other -ve value on error
+ */
+int net_loop(enum proto_t protocol);
 
 /* Load failed.	 Start again. */
 int net_start_again(void);
@@ -681,7 +697,11 @@ int net_send_tcp_packet(int payload_len, int dport, int sport, u8 action,
 int net_send_udp_packet(uchar *ether, struct in_addr dest, int dport,
 			int sport, int payload_len);
 
-/* Processes a received packet */
+/*
+ * Processes a received packet. The packet is only valid until this returns.
+ * A protocol which needs it for longer can keep a pool packet with
+ * pktbuf_get(), see pktbuf_is_pooled(), and must release it with pktbuf_put().
+ */
 void net_process_received_packet(uchar *in_packet, int len);
 
 #if defined(CONFIG_NETCONSOLE) && !defined(CONFIG_SPL_BUILD)
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Reference-counted pool of network packet buffers
+ */
+
+#ifndef __NET_PKTBUF_H__
+#define __NET_PKTBUF_H__
+
+#include <linux/types.h>
+
+/**
+ * struct pktbuf_stats - packet buffer pool statistics
+ *
+ * @total:	number of buffers in the pool
+ * @in_use:	number of buffers currently allocated
+ * @peak:	highest number of buffers allocated at the same time
+ * @allocs:	number of successful allocations
+ * @fails:	number of allocations which failed because the pool was empty
+ * @headroom:	bytes reserved in front of the data of each buffer
+ * @size:	bytes available for packet data in each buffer
+ */
+struct pktbuf_stats {
+	int total;
+	int in_use;
+	int peak;
+	ulong allocs;
+	ulong fails;
+	int headroom;
+	int size;
+};
+
+/**
+ * pktbuf_alloc() - allocate a packet buffer
+ *
+ * The buffer is aligned to PKTALIGN, so that drivers can DMA into it, and
+ * has CONFIG_NET_PKTBUF_HEADROOM bytes free in front of it. Its reference
+ * count is 1.
+ *
+ * Return: pointer to the packet data, or NULL if the pool is empty
+ */
+uchar *pktbuf_alloc(void);
+
+/**
+ * pktbuf_get() - take an additional reference to a packet buffer
+ *
+ * This lets a protocol keep a received packet after its handler returns,
+ * instead of copying it.
+ *
+ * @pkt:	any pointer into the buffer
+ */
+void pktbuf_get(uchar *pkt);
+
+/**
+ * pktbuf_put() - drop a reference to a packet buffer
+ *
+ * The buffer returns to the pool when its last reference is dropped.
+ *
+ * @pkt:	any pointer into the buffer
+ */
+void pktbuf_put(uchar *pkt);
+
+/**
+ * pktbuf_is_pooled() - check whether a packet lives in the pool
+ *
+ * Packets passed to the stack by drivers may be in the driver's own DMA
+ * memory; only pooled packets can be referenced with pktbuf_get().
+ *
+ * @pkt:	pointer to check
+ * Return: true if @pkt points into an allocated pool buffer
+ */
+bool pktbuf_is_pooled(const uchar *pkt);
+
+/**
+ * pktbuf_is_shared() - check whether a packet has more than one reference
+ *
+ * A driver which passes its DMA buffers up the stack uses this when the
+ * packet is freed, to tell whether a protocol kept it, in which case the
+ * driver must drop its reference and use another buffer.
+ *
+ * @pkt:	pointer to check
+ * Return: true if @pkt points into a pool buffer with more than one reference
+ */
+bool pktbuf_is_shared(const uchar *pkt);
+
+/**
+ * pktbuf_headroom() - get the free space in front of a packet
+ *
+ * @pkt:	pointer into a pool buffer
+ * Return: number of bytes which can be prepended with pktbuf_push(), 0 if
+ *	@pkt is not a pool buffer
+ */
+int pktbuf_headroom(const uchar *pkt);
+
+/**
+ * pktbuf_push() - extend a packet at its front
+ *
+ * This lets drivers prepend a hardware or tag header in place.
+ *
+ * @pkt:	pointer into a pool buffer
+ * @len:	number of bytes to prepend
+ * Return: new start of the packet, or NULL if there is not enough headroom
+ */
+uchar *pktbuf_push(uchar *pkt, int len);
+
+/**
+ * pktbuf_get_stats() - get the usage of the packet buffer pool
+ *
+ * @stats:	returns the statistics
+ */
+void pktbuf_get_stats(struct pktbuf_stats *stats);
+
+#endif /* __NET_PKTBUF_H__ */
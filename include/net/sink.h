@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Streaming of network downloads to a consumer
+ */
+
+#ifndef __NET_SINK_H__
+#define __NET_SINK_H__
+
+#include <linux/errno.h>
+#include <linux/kconfig.h>
+#include <linux/types.h>
+
+struct blk_desc;
+struct spi_flash;
+
+/**
+ * struct net_sink - consumer of downloaded data
+ *
+ * A sink receives a download in order, in chunks of half the staging buffer
+ * (CONFIG_NET_SINK_BUF_SIZE), instead of having it stored at the load
+ * address. The sink is called from the packet handlers, so a slow write
+ * holds back the acknowledgement of the data and thereby the sender.
+ *
+ * @name:	name of the sink, for messages
+ * @align:	size which every write but the last is a multiple of; the
+ *		staging chunk size is rounded down to a multiple of it
+ * @write:	write @len bytes of the download, starting at @offset. @buf
+ *		may be modified, e.g. padded up to @align
+ * @finish:	called once the whole download of @size bytes was written;
+ *		may be NULL
+ * @abort:	called if the download or writing it failed; may be NULL
+ * @priv:	private data of the sink
+ */
+struct net_sink {
+	const char *name;
+	ulong align;
+	int (*write)(struct net_sink *sink, u64 offset, void *buf, ulong len);
+	int (*finish)(struct net_sink *sink, u64 size);
+	void (*abort)(struct net_sink *sink);
+	void *priv;
+};
+
+#if CONFIG_IS_ENABLED(NET_SINK)
+/**
+ * net_sink_set() - stream the next download to a sink
+ *
+ * The sink is used by the next TFTP, NFS or HTTP download and released once
+ * that download finished or failed.
+ *
+ * @sink:	sink to use, must stay valid until it is released
+ * Return: 0 if OK, -ENOMEM if the staging buffer cannot be allocated
+ */
+int net_sink_set(struct net_sink *sink);
+
+/**
+ * net_sink_clear() - stop using the sink, discarding pending data
+ */
+void net_sink_clear(void);
+
+/**
+ * net_sink_active() - check whether downloads go to a sink
+ *
+ * Return: true if a sink is set
+ */
+bool net_sink_active(void);
+
+/**
+ * net_sink_store() - pass downloaded data to the sink
+ *
+ * Data may arrive out of order within the staging buffer. Data before the
+ * part already written, e.g. after a transfer restarted, is ignored.
+ *
+ * @offset:	offset of the data in the download
+ * @src:	data
+ * @len:	number of bytes
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_store(ulong offset, const void *src, ulong len);
+
+/**
+ * net_sink_end() - complete a network transfer using the sink
+ *
+ * This writes the remaining data and releases the sink if the transfer
+ * was a download, or stored data.
+ *
+ * @download:	true if the protocol was a download
+ * @ret:	result of the transfer (0 if OK, or -ve on error)
+ * @size:	number of bytes transferred
+ * Return: @ret, or -EIO if the data could not be written
+ */
+int net_sink_end(bool download, int ret, ulong size);
+
+/**
+ * net_sink_blk() - set up a sink writing to a block device
+ *
+ * @desc:	block device
+ * @start:	byte offset to write to, a multiple of the block size
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_blk(struct blk_desc *desc, u64 start);
+
+/**
+ * net_sink_gzwrite() - set up a sink decompressing to a block device
+ *
+ * The download must be a gzip file; it is decompressed on the fly, like
+ * with gzwrite().
+ *
+ * @desc:	block device
+ * @start:	byte offset to write to, a multiple of the block size
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_gzwrite(struct blk_desc *desc, u64 start);
+
+/**
+ * net_sink_sf() - set up a sink writing to SPI flash
+ *
+ * Each erase block is erased before it is written.
+ *
+ * @flash:	SPI flash
+ * @start:	offset to write to, a multiple of the erase size
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_sf(struct spi_flash *flash, u32 start);
+#else
+static inline bool net_sink_active(void)
+{
+	return false;
+}
+
+static inline int net_sink_store(ulong offset, const void *src, ulong len)
+{
+	return -ENOSYS;
+}
+
+static inline int net_sink_end(bool download, int ret, ulong size)
+{
+	return ret;
+}
+#endif
+
+#endif /* __NET_SINK_H__ */
@@ -8,6 +8,18 @@
  */
 void wget_start(void);
 
+/**
+ * wget_set_range() - select the byte range fetched by following transfers
+ *
+ * The byte at offset @start of the object is stored at the load address and
+ * an HTTP Range request is sent. If the server ignores the request and sends
+ * the whole object, the bytes outside the range are dropped.
+ *
+ * @start:	first byte to fetch
+ * @end:	last byte to fetch, or 0 to fetch up to the end of the object
+ */
+void wget_set_range(ulong start, ulong end);
+
 enum wget_state {
 	WGET_CLOSED,
 	WGET_CONNECTING,
@@ -19,3 +31,4 @@ enum wget_state {
 #define DEBUG_WGET		0	/* Set to 1 for debug messages */
 #define WGET_RETRY_COUNT	30
 #define WGET_TIMEOUT		2000UL
+#define WGET_RESUME_COUNT	10	/* Stalled transfers resumed by Range */
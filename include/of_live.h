@@ -9,12 +9,63 @@
 #ifndef _OF_LIVE_H
 #define _OF_LIVE_H
 
+#include <linux/types.h>
+
 struct abuf;
 struct device_node;
 
+/*
+ * A stashed tree has the same layout as the one built by
+ * unflatten_device_tree(), but each pointer is replaced by an offset and a
+ * tag in the bottom two bits saying what the offset is relative to. It is
+ * created by of_live_stash() or, with CONFIG_OF_LIVE_BUILTIN, generated from
+ * U-Boot's device tree at build time by tools/of_live_gen
+ */
+enum {
+	OF_LIVE_STASH_MAGIC	= 0x5654466c,	/* "lFTV" */
+
+	OF_LIVE_REF_TREE	= 1,	/* offset into the tree */
+	OF_LIVE_REF_FDT,		/* offset into the FDT */
+	OF_LIVE_REF_CONST,		/* index of a string, OF_LIVE_CONST_... */
+	OF_LIVE_REF_MASK	= 3,
+	OF_LIVE_REF_SHIFT	= 2,
+
+	OF_LIVE_CONST_ROOT	= 0,	/* "", the name of the root node */
+	OF_LIVE_CONST_NULL,		/* "<NULL>", for a missing name or type */
+	OF_LIVE_CONST_NAME,		/* "name", for a generated property */
+};
+
+/**
+ * struct of_live_stash - header of a stashed tree
+ *
+ * The tree follows at offset OF_LIVE_STASH_HDR
+ *
+ * @magic: OF_LIVE_STASH_MAGIC
+ * @fdt_size: total size of the FDT the tree was built from
+ * @fdt_crc: CRC32 of that FDT
+ * @size: size of the tree following this header, in bytes
+ */
+struct of_live_stash {
+	u32 magic;
+	u32 fdt_size;
+	u32 fdt_crc;
+	u32 size;
+};
+
+#define OF_LIVE_STASH_HDR \
+	ALIGN(sizeof(struct of_live_stash), __alignof__(struct device_node))
+
+/* Tree generated at build time with CONFIG_OF_LIVE_BUILTIN */
+extern void *const of_live_builtin;
+
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
  *
+ * With CONFIG_OF_LIVE_HANDOFF, this uses the tree stashed in the bloblist by
+ * SPL, if it was built from @fdt_blob. Failing that, with
+ * CONFIG_OF_LIVE_BUILTIN, it uses the tree generated at build time, if that was
+ * generated from @fdt_blob
+ *
  * @fdt_blob: Input tree to convert
  * @rootp: Returns live tree that was created
  * Return: 0 if OK, -ve on error
@@ -37,6 +88,58 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp);
  */
 int unflatten_device_tree(const void *blob, struct device_node **mynodes);
 
+/**
+ * of_live_stash_size() - Get the space needed to stash a live tree
+ *
+ * @fdt_blob: Flat tree to convert
+ * Return: number of bytes needed by of_live_stash(), or -ve on error
+ */
+long of_live_stash_size(const void *fdt_blob);
+
+/**
+ * of_live_stash() - Build a live tree which can be moved to another address
+ *
+ * This unflattens @fdt_blob into @buf, then replaces each pointer in the tree
+ * with an offset into @buf or into @fdt_blob, so that the tree can be passed
+ * to a later phase of U-Boot and used there by of_live_unstash(). As with
+ * unflatten_device_tree(), property values and most names are not copied but
+ * refer to the flat tree, so it must be passed on unchanged.
+ *
+ * @fdt_blob: Flat tree to convert
+ * @buf: Buffer to hold the tree, aligned for struct device_node
+ * @size: Size of @buf, see of_live_stash_size()
+ * Return: 0 if OK, -ENOSPC if @buf is too small, other -ve on error
+ */
+int of_live_stash(const void *fdt_blob, void *buf, long size);
+
+/**
+ * of_live_unstash() - Use a live tree created by of_live_stash()
+ *
+ * This turns the offsets in a stashed tree back into pointers, in place, so
+ * the tree must not be moved after this call, nor freed with of_live_free()
+ *
+ * @buf: Stashed tree
+ * @fdt_blob: Flat tree, which must be the same as that passed to
+ *	of_live_stash() although it may have moved
+ * @rootp: Returns the root node of the tree
+ * Return: 0 if OK, -ENOENT if the tree was stashed from a different flat
+ * tree, -EINVAL if @buf does not hold a stashed tree (including one which
+ * has already been unstashed)
+ */
+int of_live_unstash(void *buf, const void *fdt_blob,
+		    struct device_node **rootp);
+
+/**
+ * of_live_stash_handoff() - Stash a live tree in the bloblist
+ *
+ * This is used by SPL with CONFIG_OF_LIVE_HANDOFF so that U-Boot proper can
+ * use the tree instead of building its own, see of_live_build()
+ *
+ * @fdt_blob: Flat tree which U-Boot proper will use
+ * Return: 0 if OK, -ENOSPC if the bloblist is full, other -ve on error
+ */
+int of_live_stash_handoff(const void *fdt_blob);
+
 /**
  * of_live_free() - Dispose of a livetree
  *
@@ -123,5 +123,6 @@ int hwalk_r(struct hsearch_data *htab,
 #define H_ORIGIN_FLAGS	(H_INTERACTIVE | H_PROGRAMMATIC)
 #define H_DEFAULT	(1 << 10) /* indicate that an import is default env */
 #define H_EXTERNAL	(1 << 11) /* indicate that an import is external env */
+#define H_NOCOPY	(1 << 12) /* key and data are in env_default_table */
 
 #endif /* _SEARCH_H_ */
@@ -6,8 +6,12 @@
 
 extern const uint8_t sha256_der_prefix[];
 
-/* Reset watchdog each time we process this many bytes */
-#define CHUNKSZ_SHA256	(64 * 1024)
+/*
+ * Reset watchdog each time we process this many bytes. Even slow CPUs hash
+ * this in a few milliseconds, so there is no point in calling schedule()
+ * more often.
+ */
+#define CHUNKSZ_SHA256	(256 * 1024)
 
 typedef struct {
 	uint32_t total[2];
@@ -12,9 +12,11 @@
 #include <image.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <time.h>
 #include <u-boot/crc.h>
 #include <watchdog.h>
 #include <u-boot/zlib.h>
+#include <asm/unaligned.h>
 
 #define HEADER0			'\x1f'
 #define HEADER1			'\x8b'
@@ -81,6 +83,191 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+/* Output of a member which is decompressed and discarded at a time */
+#define GZIP_READ_SCRATCH	0x8000
+
+/*
+ * Get the compressed and uncompressed size of the member at @src from its
+ * index subfield: 'U','B' holds both sizes, 'B','C' (BGZF) the compressed
+ * size less one, in which case the uncompressed size is taken from the
+ * member's trailer.
+ */
+static int gzip_member_info(const unsigned char *src, ulong len,
+			    struct gzip_member *m)
+{
+	ulong xlen, pos;
+	const unsigned char *sub;
+	uint slen;
+
+	if (len < 18 || src[0] != (unsigned char)HEADER0 ||
+	    src[1] != (unsigned char)HEADER1 || src[2] != DEFLATED)
+		return -EINVAL;
+	if (!(src[3] & EXTRA_FIELD))
+		return -ENOENT;
+	xlen = get_unaligned_le16(src + 10);
+	if (12 + xlen > len)
+		return -EINVAL;
+
+	m->size = 0;
+	for (pos = 12; pos + 4 <= 12 + xlen; pos += 4 + slen) {
+		sub = src + pos;
+		slen = get_unaligned_le16(sub + 2);
+		if (sub[0] == 'U' && sub[1] == 'B' && slen == 8) {
+			m->size = get_unaligned_le32(sub + 4);
+			m->usize = get_unaligned_le32(sub + 8);
+			break;
+		}
+		if (sub[0] == 'B' && sub[1] == 'C' && slen == 2) {
+			m->size = get_unaligned_le16(sub + 4) + 1;
+			if (m->size <= len)
+				m->usize = get_unaligned_le32(src + m->size - 4);
+			break;
+		}
+	}
+	if (!m->size)
+		return -ENOENT;
+	if (m->size < 12 + xlen + 8 || m->size > len)
+		return -EINVAL;
+
+	return 0;
+}
+
+int gzip_find_member(const void *src, ulong len, u64 offset,
+		     struct gzip_member *m)
+{
+	ulong pos = 0;
+	u64 uoffset = 0;
+	int ret;
+
+	while (pos < len) {
+		ret = gzip_member_info(src + pos, len - pos, m);
+		if (ret == -EINVAL && pos)
+			break;	/* trailing data after the last member */
+		if (ret)
+			return ret;
+		if (!m->usize)
+			break;	/* end-of-file marker */
+		m->offset = pos;
+		m->uoffset = uoffset;
+		if (offset < uoffset + m->usize)
+			return 0;
+		pos += m->size;
+		uoffset += m->usize;
+	}
+	m->offset = pos;
+	m->size = 0;
+	m->uoffset = uoffset;
+	m->usize = 0;
+
+	return -ERANGE;
+}
+
+/*
+ * Decompress the member at @src of @len bytes, discarding the first @skip
+ * bytes of its output and storing up to *@sizep bytes after that at @dst.
+ * The CRC and size are checked if the whole member was decompressed.
+ */
+static int gzip_read_member(const unsigned char *src, ulong len, ulong skip,
+			    void *dst, ulong *sizep)
+{
+	unsigned char *scratch = NULL;
+	ulong size = *sizep;
+	unsigned char *out;
+	z_stream s;
+	u32 crc = 0;
+	int hdrlen, r, ret = 0;
+
+	*sizep = 0;
+	hdrlen = gzip_parse_header(src, len);
+	if (hdrlen < 0 || hdrlen + 8 > len)
+		return -EINVAL;
+	if (skip) {
+		scratch = malloc(GZIP_READ_SCRATCH);
+		if (!scratch)
+			return -ENOMEM;
+	}
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK) {
+		free(scratch);
+		return -ENOMEM;
+	}
+	s.next_in = (unsigned char *)src + hdrlen;
+	s.avail_in = len - hdrlen - 8;
+	do {
+		if (skip) {
+			s.next_out = scratch;
+			s.avail_out = min_t(ulong, skip, GZIP_READ_SCRATCH);
+		} else {
+			s.next_out = dst + *sizep;
+			s.avail_out = size - *sizep;
+		}
+		out = s.next_out;
+		r = inflate(&s, Z_SYNC_FLUSH);
+		crc = crc32(crc, out, s.next_out - out);
+		if (skip)
+			skip -= s.next_out - out;
+		else
+			*sizep += s.next_out - out;
+	} while (r == Z_OK && (skip || *sizep < size));
+
+	if (r == Z_STREAM_END) {
+		if (skip || crc != get_unaligned_le32(src + len - 8) ||
+		    (u32)s.total_out != get_unaligned_le32(src + len - 4)) {
+			puts("Error: gzip member is corrupt\n");
+			ret = -EIO;
+		}
+	} else if (r != Z_OK) {
+		printf("Error: inflate() returned %d\n", r);
+		ret = -EIO;
+	}
+	inflateEnd(&s);
+	free(scratch);
+
+	return ret;
+}
+
+int gzip_read(const void *src, ulong len, u64 offset, void *dst, ulong *sizep)
+{
+	struct gzip_member m;
+	ulong size = *sizep;
+	ulong pos, n;
+	int ret;
+
+	*sizep = 0;
+	ret = gzip_find_member(src, len, offset, &m);
+	if (ret == -ERANGE && offset == m.uoffset)
+		return 0;
+	if (ret)
+		return ret;
+
+	while (*sizep < size) {
+		n = size - *sizep;
+		ret = gzip_read_member(src + m.offset, m.size,
+				       offset - m.uoffset, dst + *sizep, &n);
+		if (ret)
+			return ret;
+		*sizep += n;
+
+		/* continue with the next member */
+		offset = m.uoffset + m.usize;
+		pos = m.offset + m.size;
+		if (pos >= len)
+			break;
+		ret = gzip_member_info(src + pos, len - pos, &m);
+		if (ret == -EINVAL || (!ret && !m.usize))
+			break;
+		if (ret)
+			return ret;
+		m.offset = pos;
+		m.uoffset = offset;
+	}
+
+	return 0;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(ulong expectedsize)
@@ -115,160 +302,470 @@ void gzwrite_progress_finish(int returnval,
 	}
 }
 
-int gzwrite(unsigned char *src, int len,
-	    struct blk_desc *dev,
-	    unsigned long szwritebuf,
-	    ulong startoffs,
-	    ulong szexpected)
-{
-	int i, flags;
+/**
+ * struct gzwrite_stream - state of a streaming gzwrite
+ *
+ * @s:		inflate state
+ * @dev:	block device being written
+ * @writebuf:	output buffer of @szwritebuf bytes
+ * @szwritebuf:	bytes per write
+ * @outblock:	next block to write
+ * @szexpected:	expected uncompressed size, 0 if unknown
+ * @flags:	GZWRITE_... flags
+ * @totalfilled: uncompressed offset reached so far
+ * @base:	uncompressed offset at which decompression started
+ * @discard:	number of bytes still to be discarded before writing, when
+ *		resuming within a member
+ * @skipped:	number of bytes not written because they were all zero
+ * @inflate_us:	time spent decompressing
+ * @write_us:	time spent writing, or erasing
+ * @crc:	CRC32 of the decompressed data of the current member
+ * @member_out:	number of bytes decompressed from the current member
+ * @members:	number of members completed
+ * @iteration:	number of writes, for the progress indicator
+ * @hdr:	start of the member, until its header is complete
+ * @hdrlen:	number of bytes in @hdr
+ * @trailer:	CRC and size trailer following the deflate stream
+ * @trailerlen:	number of bytes in @trailer
+ * @inited:	inflate() was initialised
+ * @started:	the header of the current member was parsed
+ * @ended:	inflate() reached the end of the deflate stream
+ * @trailing:	data which is not a gzip member follows the last member, and
+ *		is ignored
+ */
+struct gzwrite_stream {
 	z_stream s;
-	int r = 0;
+	struct blk_desc *dev;
 	unsigned char *writebuf;
-	unsigned crc = 0;
-	ulong totalfilled = 0;
-	lbaint_t blksperbuf, outblock;
-	u32 expected_crc;
-	u32 payload_size;
-	int iteration = 0;
-
-	if (!szwritebuf ||
-	    (szwritebuf % dev->blksz) ||
-	    (szwritebuf < dev->blksz)) {
-		printf("%s: size %lu not a multiple of %lu\n",
-		       __func__, szwritebuf, dev->blksz);
-		return -1;
-	}
-
-	if (startoffs & (dev->blksz-1)) {
-		printf("%s: start offset %lu not a multiple of %lu\n",
-		       __func__, startoffs, dev->blksz);
-		return -1;
-	}
+	ulong szwritebuf;
+	lbaint_t outblock;
+	ulong szexpected;
+	uint flags;
+	ulong totalfilled;
+	ulong base;
+	ulong discard;
+	ulong skipped;
+	ulong inflate_us;
+	ulong write_us;
+	u32 crc;
+	ulong member_out;
+	uint members;
+	int iteration;
+	unsigned char hdr[GZWRITE_STREAM_HDR_MAX];
+	int hdrlen;
+	unsigned char trailer[8];
+	int trailerlen;
+	bool inited;
+	bool started;
+	bool ended;
+	bool trailing;
+};
 
-	blksperbuf = szwritebuf / dev->blksz;
-	outblock = lldiv(startoffs, dev->blksz);
+/*
+ * Get the length of the gzip header in @src, 0 if more data is needed or -1
+ * if the header is invalid or too long
+ */
+static int gzwrite_stream_header(const unsigned char *src, int len)
+{
+	int i = 10;
+	int flags;
 
-	/* skip header */
-	i = 10;
+	if (len < 10)
+		return 0;
 	flags = src[3];
-	if (src[2] != DEFLATED || (flags & RESERVED) != 0) {
+	if (src[0] != (unsigned char)HEADER0 ||
+	    src[1] != (unsigned char)HEADER1 ||
+	    src[2] != DEFLATED || (flags & RESERVED) != 0) {
 		puts("Error: Bad gzipped data\n");
 		return -1;
 	}
-	if ((flags & EXTRA_FIELD) != 0)
+	if (flags & EXTRA_FIELD) {
+		if (len < 12)
+			return 0;
 		i = 12 + src[10] + (src[11] << 8);
-	if ((flags & ORIG_NAME) != 0)
-		while (src[i++] != 0)
-			;
-	if ((flags & COMMENT) != 0)
-		while (src[i++] != 0)
-			;
-	if ((flags & HEAD_CRC) != 0)
+	}
+	if (flags & ORIG_NAME) {
+		while (i < len && src[i])
+			i++;
+		i++;
+	}
+	if (flags & COMMENT) {
+		while (i < len && src[i])
+			i++;
+		i++;
+	}
+	if (flags & HEAD_CRC)
 		i += 2;
+	if (i > len) {
+		if (len == GZWRITE_STREAM_HDR_MAX) {
+			puts("Error: gzip header too long\n");
+			return -1;
+		}
+		return 0;
+	}
+
+	return i;
+}
 
-	if (i >= len-8) {
-		puts("Error: gunzip out of data in header");
+/* Check whether @len bytes at the word-aligned @buf are all zero */
+static bool gzwrite_is_zero(const void *buf, ulong len)
+{
+	const ulong *p = buf;
+	const ulong *end = buf + len;
+
+	while (p < end) {
+		if (*p++)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Write out the output buffer. Blocks which are all zero are skipped or
+ * erased, if requested by the flags.
+ */
+static int gzwrite_stream_flush(struct gzwrite_stream *gs)
+{
+	struct blk_desc *dev = gs->dev;
+	ulong numfilled = gs->szwritebuf - gs->s.avail_out;
+	lbaint_t writeblocks;
+	ulong start;
+
+	if (!numfilled)
+		return 0;
+
+	writeblocks = DIV_ROUND_UP(numfilled, dev->blksz);
+	if (numfilled % dev->blksz)
+		memset(gs->writebuf + numfilled, '\0',
+		       dev->blksz - numfilled % dev->blksz);
+	if (gs->outblock + writeblocks > dev->lba) {
+		printf("%s: uncompressed size exceeds device size\n", __func__);
 		return -1;
 	}
 
-	payload_size = len - i - 8;
-
-	memcpy(&expected_crc, src + len - 8, sizeof(expected_crc));
-	expected_crc = le32_to_cpu(expected_crc);
-	u32 szuncompressed;
-	memcpy(&szuncompressed, src + len - 4, sizeof(szuncompressed));
-	if (szexpected == 0) {
-		szexpected = le32_to_cpu(szuncompressed);
-	} else if (szuncompressed != (u32)szexpected) {
-		printf("size of %lx doesn't match trailer low bits %x\n",
-		       szexpected, szuncompressed);
+	gzwrite_progress(gs->iteration++, gs->totalfilled, gs->szexpected);
+
+	start = timer_get_us();
+	if ((gs->flags & (GZWRITE_SKIP_ZERO | GZWRITE_ERASE_ZERO)) &&
+	    gzwrite_is_zero(gs->writebuf, writeblocks * dev->blksz) &&
+	    (!(gs->flags & GZWRITE_ERASE_ZERO) ||
+	     blk_derase(dev, gs->outblock, writeblocks) == writeblocks)) {
+		gs->skipped += numfilled;
+	} else if (blk_dwrite(dev, gs->outblock, writeblocks,
+			      gs->writebuf) != writeblocks) {
+		printf("%s: write failed at block " LBAF "\n", __func__,
+		       gs->outblock);
 		return -1;
 	}
-	if (lldiv(szexpected, dev->blksz) > (dev->lba - outblock)) {
-		printf("%s: uncompressed size %lu exceeds device size\n",
-		       __func__, szexpected);
+	gs->write_us += timer_get_us() - start;
+
+	gs->outblock += writeblocks;
+	gs->s.next_out = gs->writebuf;
+	gs->s.avail_out = gs->szwritebuf;
+	if (ctrlc()) {
+		puts("abort\n");
 		return -1;
 	}
+	schedule();
 
-	gzwrite_progress_init(szexpected);
+	return 0;
+}
 
-	s.zalloc = gzalloc;
-	s.zfree = gzfree;
+/* Get the rate of @bytes in @us microseconds in KiB/s */
+static ulong gzwrite_rate(ulong bytes, ulong us)
+{
+	return us ? lldiv((u64)bytes * 1000000 / 1024, us) : 0;
+}
 
-	r = inflateInit2(&s, -MAX_WBITS);
-	if (r != Z_OK) {
-		printf("Error: inflateInit2() returned %d\n", r);
+/*
+ * Account for the output of inflate() from @out up to the current output
+ * position, dropping what is to be discarded
+ */
+static void gzwrite_stream_produced(struct gzwrite_stream *gs,
+				    unsigned char *out)
+{
+	ulong len = gs->s.next_out - out;
+	ulong drop;
+
+	gs->crc = crc32(gs->crc, out, len);
+	gs->member_out += len;
+	gs->totalfilled += len;
+	if (gs->discard) {
+		drop = min(gs->discard, len);
+		memmove(out, out + drop, len - drop);
+		gs->s.next_out -= drop;
+		gs->s.avail_out += drop;
+		gs->discard -= drop;
+	}
+}
+
+/* Check the trailer of the member completed and get ready for the next */
+static int gzwrite_stream_next(struct gzwrite_stream *gs)
+{
+	u32 expected_crc = get_unaligned_le32(gs->trailer);
+	u32 szuncompressed = get_unaligned_le32(gs->trailer + 4);
+
+	if (gs->crc != expected_crc || (u32)gs->member_out != szuncompressed) {
+		printf("%s: member %u corrupt, crc 0x%08x/0x%08x\n", __func__,
+		       gs->members, expected_crc, gs->crc);
 		return -1;
 	}
+	gs->members++;
+	gs->crc = 0;
+	gs->member_out = 0;
+	gs->hdrlen = 0;
+	gs->trailerlen = 0;
+	gs->started = false;
+	gs->ended = false;
+
+	return 0;
+}
 
-	s.next_in = src + i;
-	s.avail_in = payload_size+8;
-	writebuf = (unsigned char *)malloc_cache_aligned(szwritebuf);
+struct gzwrite_stream *gzwrite_stream_start(struct blk_desc *dev,
+					    ulong szwritebuf, ulong startoffs,
+					    ulong szexpected, uint flags)
+{
+	struct gzwrite_stream *gs;
 
-	/* decompress until deflate stream ends or end of file */
-	do {
-		if (s.avail_in == 0) {
-			printf("%s: weird termination with result %d\n",
-			       __func__, r);
-			break;
+	if (!szwritebuf || (szwritebuf % dev->blksz)) {
+		printf("%s: size %lu not a multiple of %lu\n",
+		       __func__, szwritebuf, dev->blksz);
+		return NULL;
+	}
+	if (startoffs & (dev->blksz - 1)) {
+		printf("%s: start offset %lu not a multiple of %lu\n",
+		       __func__, startoffs, dev->blksz);
+		return NULL;
+	}
+
+	gs = calloc(1, sizeof(*gs));
+	if (!gs)
+		return NULL;
+	gs->writebuf = malloc_cache_aligned(szwritebuf);
+	if (!gs->writebuf) {
+		free(gs);
+		return NULL;
+	}
+	gs->dev = dev;
+	gs->szwritebuf = szwritebuf;
+	gs->outblock = lldiv(startoffs, dev->blksz);
+	gs->szexpected = szexpected;
+	gs->flags = flags;
+	gs->s.zalloc = gzalloc;
+	gs->s.zfree = gzfree;
+	gzwrite_progress_init(szexpected);
+
+	return gs;
+}
+
+int gzwrite_stream_feed(struct gzwrite_stream *gs, const void *src, ulong len)
+{
+	const unsigned char *in = src;
+	unsigned char *out;
+	ulong start;
+	int copy;
+	int r;
+
+	while (len && !gs->trailing) {
+		/* the last member is complete; another may follow */
+		if (gs->trailerlen == sizeof(gs->trailer)) {
+			if (in[0] != (unsigned char)HEADER0) {
+				gs->trailing = true;
+				break;
+			}
+			if (gzwrite_stream_next(gs))
+				return -1;
 		}
 
-		/* run inflate() on input until output buffer not full */
-		do {
-			unsigned long blocks_written;
-			int numfilled;
-			lbaint_t writeblocks;
-
-			s.avail_out = szwritebuf;
-			s.next_out = writebuf;
-			r = inflate(&s, Z_SYNC_FLUSH);
-			if ((r != Z_OK) &&
-			    (r != Z_STREAM_END)) {
-				printf("Error: inflate() returned %d\n", r);
-				goto out;
+		if (!gs->started) {
+			int hdrlen;
+
+			copy = min_t(ulong, len, sizeof(gs->hdr) - gs->hdrlen);
+			memcpy(gs->hdr + gs->hdrlen, in, copy);
+			hdrlen = gzwrite_stream_header(gs->hdr,
+						       gs->hdrlen + copy);
+			if (hdrlen < 0)
+				return -1;
+			if (!hdrlen) {
+				gs->hdrlen += copy;
+				return 0;
 			}
-			numfilled = szwritebuf - s.avail_out;
-			crc = crc32(crc, writebuf, numfilled);
-			totalfilled += numfilled;
-			if (numfilled < szwritebuf) {
-				writeblocks = (numfilled+dev->blksz-1)
-						/ dev->blksz;
-				memset(writebuf+numfilled, 0,
-				       dev->blksz-(numfilled%dev->blksz));
+			/* skip the part of the header which is in this chunk */
+			in += hdrlen - gs->hdrlen;
+			len -= hdrlen - gs->hdrlen;
+
+			if (gs->inited) {
+				r = inflateReset(&gs->s);
 			} else {
-				writeblocks = blksperbuf;
+				r = inflateInit2(&gs->s, -MAX_WBITS);
+				gs->s.next_out = gs->writebuf;
+				gs->s.avail_out = gs->szwritebuf;
+			}
+			if (r != Z_OK) {
+				printf("Error: inflateInit2() returned %d\n", r);
+				return -1;
 			}
+			gs->inited = true;
+			gs->started = true;
+		}
 
-			gzwrite_progress(iteration++,
-					 totalfilled,
-					 szexpected);
-			blocks_written = blk_dwrite(dev, outblock,
-						    writeblocks, writebuf);
-			outblock += blocks_written;
-			if (ctrlc()) {
-				puts("abort\n");
-				goto out;
+		gs->s.next_in = (unsigned char *)in;
+		gs->s.avail_in = len;
+		while (!gs->ended && gs->s.avail_in) {
+			out = gs->s.next_out;
+			start = timer_get_us();
+			r = inflate(&gs->s, Z_SYNC_FLUSH);
+			gs->inflate_us += timer_get_us() - start;
+			gzwrite_stream_produced(gs, out);
+			if (r == Z_STREAM_END) {
+				gs->ended = true;
+			} else if (r != Z_OK && r != Z_BUF_ERROR) {
+				printf("Error: inflate() returned %d\n", r);
+				return -1;
 			}
-			schedule();
-		} while (s.avail_out == 0);
-		/* done when inflate() says it's done */
-	} while (r != Z_STREAM_END);
+			if (!gs->s.avail_out && gzwrite_stream_flush(gs))
+				return -1;
+		}
+		if (!gs->ended)
+			break;
+
+		/* the trailer follows the deflate stream */
+		copy = min_t(ulong, gs->s.avail_in,
+			     sizeof(gs->trailer) - gs->trailerlen);
+		memcpy(gs->trailer + gs->trailerlen, gs->s.next_in, copy);
+		gs->trailerlen += copy;
+		in = gs->s.next_in + copy;
+		len = gs->s.avail_in - copy;
+	}
 
-	if ((szexpected != totalfilled) ||
-	    (crc != expected_crc))
+	return 0;
+}
+
+/* Complete the stream if @r is 0, report the result and free the state */
+static int gzwrite_stream_end(struct gzwrite_stream *gs, int r)
+{
+	u32 expected_crc = 0;
+	u32 szuncompressed = 0;
+	ulong total = gs->szexpected;
+
+	if (!r && (!gs->ended || gs->trailerlen != sizeof(gs->trailer))) {
+		printf("%s: truncated gzip data\n", __func__);
 		r = -1;
-	else
-		r = 0;
+	}
+	if (!r)
+		r = gzwrite_stream_flush(gs);
+	if (!r) {
+		expected_crc = get_unaligned_le32(gs->trailer);
+		szuncompressed = get_unaligned_le32(gs->trailer + 4);
+		if (!total)
+			total = gs->totalfilled;
+		if (gs->crc != expected_crc ||
+		    (u32)gs->member_out != szuncompressed ||
+		    gs->totalfilled != total)
+			r = -1;
+	}
 
-out:
-	gzwrite_progress_finish(r, totalfilled, szexpected,
-				expected_crc, crc);
-	free(writebuf);
-	inflateEnd(&s);
+	gzwrite_progress_finish(r, gs->totalfilled, total, expected_crc,
+				gs->crc);
+	printf("\tinflate %lu KiB/s, write %lu KiB/s",
+	       gzwrite_rate(gs->totalfilled - gs->base, gs->inflate_us),
+	       gzwrite_rate(gs->totalfilled - gs->base - gs->skipped,
+			    gs->write_us));
+	if (gs->skipped)
+		printf(", %lu bytes of zeroes %s", gs->skipped,
+		       gs->flags & GZWRITE_ERASE_ZERO ? "erased" : "skipped");
+	putc('\n');
+	gzwrite_stream_free(gs);
 
 	return r;
 }
+
+int gzwrite_stream_finish(struct gzwrite_stream *gs)
+{
+	return gzwrite_stream_end(gs, 0);
+}
+
+void gzwrite_stream_free(struct gzwrite_stream *gs)
+{
+	if (gs->inited)
+		inflateEnd(&gs->s);
+	free(gs->writebuf);
+	free(gs);
+}
+
+int gzwrite_resume(unsigned char *src, int len, struct blk_desc *dev,
+		   ulong szwritebuf, ulong startoffs, ulong szexpected,
+		   uint flags, ulong offset)
+{
+	struct gzwrite_stream *gs;
+	struct gzip_member m;
+
+	if (len < 18) {
+		puts("Error: gunzip out of data in header\n");
+		return -1;
+	}
+
+	if (gzip_find_member(src, len, ~0ULL, &m) == -ERANGE) {
+		/* indexed file: the index gives the size */
+		if (szexpected == 0) {
+			szexpected = m.uoffset;
+		} else if (szexpected != m.uoffset) {
+			printf("size of %lx doesn't match index size %llx\n",
+			       szexpected, m.uoffset);
+			return -1;
+		}
+	} else if (szexpected == 0) {
+		/* the trailer of the last member gives the size of a single one */
+		szexpected = get_unaligned_le32(src + len - 4);
+	}
+	if (lldiv(szexpected, dev->blksz) >
+	    dev->lba - lldiv(startoffs, dev->blksz)) {
+		printf("%s: uncompressed size %lu exceeds device size\n",
+		       __func__, szexpected);
+		return -1;
+	}
+
+	memset(&m, '\0', sizeof(m));
+	if (offset) {
+		if (offset % dev->blksz) {
+			printf("%s: resume offset %lx not a multiple of %lx\n",
+			       __func__, offset, dev->blksz);
+			return -1;
+		}
+		if (gzip_find_member(src, len, offset, &m)) {
+			printf("%s: no indexed member to resume at %lx\n",
+			       __func__, offset);
+			return -1;
+		}
+	}
+
+	gs = gzwrite_stream_start(dev, szwritebuf, startoffs + offset,
+				  szexpected, flags);
+	if (!gs)
+		return -1;
+	gs->totalfilled = m.uoffset;
+	gs->base = m.uoffset;
+	gs->discard = offset - m.uoffset;
+
+	return gzwrite_stream_end(gs, gzwrite_stream_feed(gs, src + m.offset,
+							  len - m.offset));
+}
+
+int gzwrite_flags(unsigned char *src, int len, struct blk_desc *dev,
+		  ulong szwritebuf, ulong startoffs, ulong szexpected,
+		  uint flags)
+{
+	return gzwrite_resume(src, len, dev, szwritebuf, startoffs, szexpected,
+			      flags, 0);
+}
+
+int gzwrite(unsigned char *src, int len, struct blk_desc *dev,
+	    ulong szwritebuf, ulong startoffs, ulong szexpected)
+{
+	return gzwrite_flags(src, len, dev, szwritebuf, startoffs, szexpected,
+			     0);
+}
 #endif
 
 /*
@@ -39,6 +39,7 @@
 
 #include <env_callback.h>
 #include <env_flags.h>
+#include <env_table.h>
 #include <search.h>
 #include <slre.h>
 
@@ -58,6 +59,22 @@ struct env_entry_node {
 	struct env_entry entry;
 };
 
+/* Free a key or value, unless it still refers to the default table */
+static void hfree(const void *ptr)
+{
+	if (!env_table_owns(ptr))
+		free((void *)ptr);
+}
+
+/* Copy a key or value into the table, unless H_NOCOPY says it is static */
+static char *hstrdup(const char *str, int flag)
+{
+	if (CONFIG_IS_ENABLED(ENV_DEFAULT_TABLE) && (flag & H_NOCOPY))
+		return (char *)str;
+
+	return strdup(str);
+}
+
 
 static void _hdelete(const char *key, struct hsearch_data *htab,
 		     struct env_entry *ep, int idx);
@@ -152,8 +169,8 @@ void hdestroy_r(struct hsearch_data *htab)
 		if (htab->table[i].used > 0) {
 			struct env_entry *ep = &htab->table[i].entry;
 
-			free((void *)ep->key);
-			free(ep->data);
+			hfree(ep->key);
+			hfree(ep->data);
 		}
 	}
 	free(htab->table);
@@ -264,8 +281,8 @@ static inline int _compare_and_overwrite_entry(struct env_entry item,
 				return 0;
 			}
 
-			free(htab->table[idx].entry.data);
-			htab->table[idx].entry.data = strdup(item.data);
+			hfree(htab->table[idx].entry.data);
+			htab->table[idx].entry.data = hstrdup(item.data, flag);
 			if (!htab->table[idx].entry.data) {
 				__set_errno(ENOMEM);
 				*retval = NULL;
@@ -380,8 +397,8 @@ int hsearch_r(struct env_entry item, enum env_action action,
 			idx = first_deleted;
 
 		htab->table[idx].used = hval;
-		htab->table[idx].entry.key = strdup(item.key);
-		htab->table[idx].entry.data = strdup(item.data);
+		htab->table[idx].entry.key = hstrdup(item.key, flag);
+		htab->table[idx].entry.data = hstrdup(item.data, flag);
 		if (!htab->table[idx].entry.key ||
 		    !htab->table[idx].entry.data) {
 			__set_errno(ENOMEM);
@@ -444,8 +461,8 @@ static void _hdelete(const char *key, struct hsearch_data *htab,
 {
 	/* free used entry */
 	debug("hdelete: DELETING key \"%s\"\n", key);
-	free((void *)ep->key);
-	free(ep->data);
+	hfree(ep->key);
+	hfree(ep->data);
 	ep->flags = 0;
 	htab->table[idx].used = USED_DELETED;
 
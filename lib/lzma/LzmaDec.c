@@ -6,6 +6,7 @@
 #include "LzmaDec.h"
 
 #include <linux/string.h>
+#include <asm/unaligned.h>
 
 #define kNumTopBits 24
 #define kTopValue ((UInt32)1 << kNumTopBits)
@@ -26,6 +27,18 @@
   { UPDATE_1(p); i = (i + i) + 1; A1; }
 #define GET_BIT(p, i) GET_BIT2(p, i, ; , ;)
 
+/*
+The bits of literals which do not follow a match are hard to predict, so they
+are decoded without branches: m is all ones for a 1 bit and zero for a 0 bit.
+*/
+#define GET_BIT_BL(p, i) \
+  { UInt32 m; unsigned u0, u1; \
+  ttt = *(p); NORMALIZE; bound = (range >> kNumBitModelTotalBits) * ttt; \
+  m = (UInt32)0 - (UInt32)(code >= bound); \
+  range = bound + ((range - bound - bound) & m); code -= bound & m; \
+  u0 = ttt + ((kBitModelTotal - ttt) >> kNumMoveBits); u1 = ttt - (ttt >> kNumMoveBits); \
+  *(p) = (CLzmaProb)(u0 ^ ((u0 ^ u1) & m)); i = (i + i) - m; }
+
 #define TREE_GET_BIT(probs, i) { GET_BIT((probs + i), i); }
 #define TREE_DECODE(probs, limit, i) \
   { i = 1; do { TREE_GET_BIT(probs, i); } while (i < limit); i -= limit; }
@@ -34,6 +47,11 @@
 
 #ifdef _LZMA_SIZE_OPT
 #define TREE_6_DECODE(probs, i) TREE_DECODE(probs, (1 << 6), i)
+#define LITERAL_DECODE(probs, i) \
+  { i = 1; do { GET_BIT_BL(probs + i, i) } while (i < 0x100); }
+#define MATCHED_LITERAL_DECODE(probs, i, matchByte) \
+  { unsigned offs = 0x100; i = 1; \
+  do { MATCHED_LITERAL_BIT(probs, i, matchByte, offs) } while (i < 0x100); }
 #else
 #define TREE_6_DECODE(probs, i) \
   { i = 1; \
@@ -44,8 +62,37 @@
   TREE_GET_BIT(probs, i); \
   TREE_GET_BIT(probs, i); \
   i -= 0x40; }
+#define LITERAL_DECODE(probs, i) \
+  { i = 1; \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); \
+  GET_BIT_BL(probs + i, i); }
+#define MATCHED_LITERAL_DECODE(probs, i, matchByte) \
+  { unsigned offs = 0x100; i = 1; \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  MATCHED_LITERAL_BIT(probs, i, matchByte, offs) }
 #endif
 
+/*
+A literal after a match is coded relative to the byte at rep0: while its bits
+agree with that byte, the probabilities for the matching bits are used.
+*/
+#define MATCHED_LITERAL_BIT(probs, i, matchByte, offs) \
+  { unsigned bit; CLzmaProb *probLit; \
+  matchByte <<= 1; bit = matchByte & offs; probLit = probs + offs + bit + i; \
+  GET_BIT2(probLit, i, offs &= ~bit, offs &= bit) }
+
 #define NORMALIZE_CHECK if (range < kTopValue) { if (buf >= bufLimit) return DUMMY_ERROR; range <<= 8; code = (code << 8) | (*buf++); }
 
 #define IF_BIT_0_CHECK(p) ttt = *(p); NORMALIZE_CHECK; bound = (range >> kNumBitModelTotalBits) * ttt; if (code < bound)
@@ -176,27 +223,13 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
       if (state < kNumLitStates)
       {
         state -= (state < 4) ? state : 3;
-        symbol = 1;
-
-        do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+        LITERAL_DECODE(prob, symbol);
       }
       else
       {
         unsigned matchByte = p->dic[(dicPos - rep0) + ((dicPos < rep0) ? dicBufSize : 0)];
-        unsigned offs = 0x100;
         state -= (state < 10) ? 3 : 6;
-        symbol = 1;
-
-        do
-        {
-          unsigned bit;
-          CLzmaProb *probLit;
-          matchByte <<= 1;
-          bit = (matchByte & offs);
-          probLit = prob + offs + bit + symbol;
-          GET_BIT2(probLit, symbol, offs &= ~bit, offs &= bit)
-        }
-        while (symbol < 0x100);
+        MATCHED_LITERAL_DECODE(prob, symbol, matchByte);
       }
       dic[dicPos++] = (Byte)symbol;
       processedPos++;
@@ -402,9 +435,22 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
           const Byte *lim = dest + curLen;
           dicPos += curLen;
 
-          do
-            *(dest) = (Byte)*(dest + src);
-          while (++dest != lim);
+          /* a run of one byte, e.g. padding, or a word at a time */
+          if (src == -1)
+            memset(dest, dest[-1], curLen);
+          else if (src >= (ptrdiff_t)sizeof(SizeT) || src <= -(ptrdiff_t)sizeof(SizeT))
+          {
+            for (; lim - dest >= (ptrdiff_t)sizeof(SizeT); dest += sizeof(SizeT))
+              put_unaligned(get_unaligned((SizeT *)(dest + src)), (SizeT *)dest);
+            for (; dest != lim; dest++)
+              *(dest) = (Byte)*(dest + src);
+          }
+          else
+          {
+            do
+              *(dest) = (Byte)*(dest + src);
+            while (++dest != lim);
+          }
         }
         else
         {
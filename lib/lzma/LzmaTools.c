@@ -120,4 +120,89 @@ int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
     return res;
 }
 
+int lzmaStreamDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+                         lzmaReadFunc read, void *priv, SizeT length)
+{
+    unsigned char header[LZMA_DATA_OFFSET];
+    const unsigned char *in;
+    ISzAlloc g_Alloc;
+    ELzmaStatus state = LZMA_STATUS_NEEDS_MORE_INPUT;
+    CLzmaDec dec;
+    uint64_t outSize = 0;
+    SizeT outSizeFull;
+    SizeT offset, inLen;
+    ELzmaFinishMode finish;
+    int res;
+    int i;
+
+    if (length < LZMA_DATA_OFFSET)
+        return SZ_ERROR_INPUT_EOF;
+
+    /* The header may come in pieces */
+    for (offset = 0; offset < LZMA_DATA_OFFSET; offset += inLen) {
+        inLen = LZMA_DATA_OFFSET - offset;
+        in = read(priv, offset, &inLen);
+        if (!in || !inLen)
+            return SZ_ERROR_READ;
+        inLen = min(inLen, (SizeT)LZMA_DATA_OFFSET - offset);
+        memcpy(header + offset, in, inLen);
+    }
+
+    for (i = 7; i >= 0; i--)
+        outSize = outSize << 8 | header[LZMA_SIZE_OFFSET + i];
+    if (outSize == (uint64_t)-1) {
+        outSizeFull = (SizeT)-1;
+    } else if (outSize > (SizeT)-1) {
+        debug("LZMA: 64bit support not enabled.\n");
+        return SZ_ERROR_DATA;
+    } else {
+        outSizeFull = outSize;
+    }
+    if (outSizeFull != (SizeT)-1 && *uncompressedSize < outSizeFull)
+        return SZ_ERROR_OUTPUT_EOF;
+    outSizeFull = min(outSizeFull, *uncompressedSize);
+
+    g_Alloc.Alloc = SzAlloc;
+    g_Alloc.Free = SzFree;
+    LzmaDec_Construct(&dec);
+    res = LzmaDec_AllocateProbs(&dec, header, LZMA_PROPS_SIZE, &g_Alloc);
+    if (res != SZ_OK)
+        return res;
+    dec.dic = outStream;
+    dec.dicBufSize = outSizeFull;
+    LzmaDec_Init(&dec);
+
+    /* Decode each piece where the reader has it, without copying it */
+    for (offset = LZMA_DATA_OFFSET; offset < length; offset += inLen) {
+        inLen = length - offset;
+        in = read(priv, offset, &inLen);
+        if (!in || !inLen) {
+            res = SZ_ERROR_READ;
+            break;
+        }
+        inLen = min(inLen, length - offset);
+        /* Once the output is full, only an end mark may follow */
+        finish = offset + inLen == length || dec.dicPos == outSizeFull ?
+                 LZMA_FINISH_END : LZMA_FINISH_ANY;
+        res = LzmaDec_DecodeToDic(&dec, outSizeFull, in, &inLen, finish,
+                                  &state);
+        if (res != SZ_OK || state == LZMA_STATUS_FINISHED_WITH_MARK ||
+            state == LZMA_STATUS_MAYBE_FINISHED_WITHOUT_MARK ||
+            (outSize != (uint64_t)-1 && dec.dicPos == outSizeFull))
+            break;
+        if (!inLen && finish == LZMA_FINISH_END) {
+            res = SZ_ERROR_DATA;
+            break;
+        }
+        schedule();
+    }
+    if (res == SZ_OK && state == LZMA_STATUS_NEEDS_MORE_INPUT)
+        res = SZ_ERROR_INPUT_EOF;
+
+    *uncompressedSize = dec.dicPos;
+    LzmaDec_FreeProbs(&dec, &g_Alloc);
+
+    return res;
+}
+
 #endif
@@ -28,4 +28,36 @@
 int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
 			     const unsigned char *inStream, SizeT length);
 
+/**
+ * typedef lzmaReadFunc - Get a piece of the compressed data
+ *
+ * @priv: Private data of the reader
+ * @offset: Offset of the data wanted
+ * @lenp: On entry, the number of bytes wanted; on exit, the number of bytes
+ *	available at the returned pointer, which may be fewer or more
+ * @return pointer to the data at @offset, or NULL on error
+ */
+typedef const unsigned char *(*lzmaReadFunc)(void *priv, SizeT offset,
+					     SizeT *lenp);
+
+/**
+ * lzmaStreamDecompress() - Decompress LZMA data which is read in pieces
+ *
+ * This is lzmaBuffToBuffDecompress() for data which is not in memory as a
+ * whole. The reader can return data from memory-mapped flash directly, or
+ * read it piece by piece into a small buffer, rather than the compressed
+ * data being copied to memory first.
+ *
+ * @outStream: output buffer
+ * @uncompressedSize: On entry, the maximum uncompressed size of the data;
+ *	on exit, the actual uncompressed size after processing
+ * @read: Function to get the compressed data
+ * @priv: Private data passed to @read
+ * @length: Size of the compressed data
+ * @return 0 if OK, SZ_ERROR_READ if @read failed, otherwise as
+ *	lzmaBuffToBuffDecompress()
+ */
+int lzmaStreamDecompress(unsigned char *outStream, SizeT *uncompressedSize,
+			 lzmaReadFunc read, void *priv, SizeT length);
+
 #endif
@@ -11,7 +11,9 @@
 #define LOG_CATEGORY	LOGC_DT
 
 #include <abuf.h>
+#include <bloblist.h>
 #include <log.h>
+#include <u-boot/crc.h>
 #include <linux/libfdt.h>
 #include <of_live.h>
 #include <malloc.h>
@@ -23,6 +25,11 @@ enum {
 	BUF_STEP	= SZ_64K,
 };
 
+/* Strings used by the tree which are not in the FDT or the tree's memory */
+static const char of_live_root[] = "";
+static const char of_live_null[] = "<NULL>";
+static const char of_live_name[] = "name";
+
 static void *unflatten_dt_alloc(void **mem, unsigned long size,
 				unsigned long align)
 {
@@ -35,6 +42,20 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
 	return res;
 }
 
+/* Look up a property while the node is being built */
+static const void *unflatten_get_prop(const struct device_node *np,
+				      const char *name)
+{
+	const struct property *pp;
+
+	for (pp = np->properties; pp; pp = pp->next) {
+		if (!strcmp(pp->name, name))
+			return pp->value;
+	}
+
+	return NULL;
+}
+
 /**
  * unflatten_dt_node() - Alloc and populate a device_node from the flat tree
  * @blob: The parent device tree blob
@@ -87,7 +108,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 			fpsize = 1;
 			allocl = 2;
 			l = 1;
-			pathp = "";
+			pathp = of_live_root;
 		} else {
 			/*
 			 * account for '/' and path size minus terminal 0
@@ -200,7 +221,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		pp = unflatten_dt_alloc(&mem, sizeof(struct property) + sz,
 					__alignof__(struct property));
 		if (!dryrun) {
-			pp->name = "name";
+			pp->name = (char *)of_live_name;
 			pp->length = sz;
 			pp->value = pp + 1;
 			*prev_pp = pp;
@@ -214,13 +235,14 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	if (!dryrun) {
 		*prev_pp = NULL;
 		if (!has_name)
-			np->name = of_get_property(np, "name", NULL);
-		np->type = of_get_property(np, "device_type", NULL);
+			np->name = unflatten_get_prop(np, "name");
+		np->type = unflatten_get_prop(np, "device_type");
 
 		if (!np->name)
-			np->name = "<NULL>";
+			np->name = of_live_null;
 		if (!np->type)
-			np->type = "<NULL>";	}
+			np->type = of_live_null;
+	}
 
 	old_depth = depth;
 	*poffset = fdt_next_node(blob, *poffset, &depth);
@@ -260,13 +282,11 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
-int unflatten_device_tree(const void *blob, struct device_node **mynodes)
+/* Check the blob and work out how much memory the tree needs */
+static long unflatten_dt_size(const void *blob)
 {
 	unsigned long size;
 	int start;
-	void *mem;
-
-	debug(" -> unflatten_device_tree()\n");
 
 	if (!blob) {
 		debug("No device tree pointer\n");
@@ -289,12 +309,16 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 						0, true);
 	if (!size)
 		return -EFAULT;
-	size = ALIGN(size, 4);
 
-	debug("  size is %lx, allocating...\n", size);
+	return ALIGN(size, 4);
+}
+
+/* Unflatten into @mem, which must be @size bytes plus 4 for the marker */
+static int unflatten_dt_into(const void *blob, void *mem, unsigned long size,
+			     struct device_node **mynodes)
+{
+	int start;
 
-	/* Allocate memory for the expanded device tree */
-	mem = memalign(__alignof__(struct device_node), size + 4);
 	memset(mem, '\0', size);
 
 	/* Set up value for dm_test_livetree_align() */
@@ -313,17 +337,274 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 		return -ENOSPC;
 	}
 
+	return 0;
+}
+
+int unflatten_device_tree(const void *blob, struct device_node **mynodes)
+{
+	long size;
+	void *mem;
+	int ret;
+
+	debug(" -> unflatten_device_tree()\n");
+
+	size = unflatten_dt_size(blob);
+	if (size < 0)
+		return size;
+
+	debug("  size is %lx, allocating...\n", size);
+
+	/* Allocate memory for the expanded device tree */
+	mem = memalign(__alignof__(struct device_node), size + 4);
+	if (!mem)
+		return -ENOMEM;
+
+	ret = unflatten_dt_into(blob, mem, size, mynodes);
+	if (ret)
+		return ret;
+
 	debug(" <- unflatten_device_tree()\n");
 
 	return 0;
 }
 
+static const char *const of_live_consts[] = {
+	[OF_LIVE_CONST_ROOT]	= of_live_root,
+	[OF_LIVE_CONST_NULL]	= of_live_null,
+	[OF_LIVE_CONST_NAME]	= of_live_name,
+};
+
+/* Root of the tree last taken from a stash, which must not be freed */
+static struct device_node *of_live_static_root;
+
+struct of_live_rebase {
+	void *tree;
+	ulong size;
+	const void *fdt;
+	ulong fdt_size;
+	int err;
+};
+
+static ulong of_live_to_ref(struct of_live_rebase *rb, const void *ptr)
+{
+	int i;
+
+	if (!ptr)
+		return 0;
+	if (ptr >= rb->tree && ptr < rb->tree + rb->size)
+		return (ptr - rb->tree) << OF_LIVE_REF_SHIFT | OF_LIVE_REF_TREE;
+	if (ptr >= rb->fdt && ptr < rb->fdt + rb->fdt_size)
+		return (ptr - rb->fdt) << OF_LIVE_REF_SHIFT | OF_LIVE_REF_FDT;
+	for (i = 0; i < ARRAY_SIZE(of_live_consts); i++) {
+		if (ptr == of_live_consts[i])
+			return i << OF_LIVE_REF_SHIFT | OF_LIVE_REF_CONST;
+	}
+	rb->err = -EFAULT;
+
+	return 0;
+}
+
+static void *of_live_from_ref(struct of_live_rebase *rb, ulong ref)
+{
+	ulong offset = ref >> OF_LIVE_REF_SHIFT;
+
+	switch (ref & OF_LIVE_REF_MASK) {
+	case 0:
+		if (!ref)
+			return NULL;
+		break;
+	case OF_LIVE_REF_TREE:
+		if (offset < rb->size)
+			return rb->tree + offset;
+		break;
+	case OF_LIVE_REF_FDT:
+		if (offset < rb->fdt_size)
+			return (void *)rb->fdt + offset;
+		break;
+	case OF_LIVE_REF_CONST:
+		if (offset < ARRAY_SIZE(of_live_consts))
+			return (void *)of_live_consts[offset];
+		break;
+	}
+	rb->err = -EINVAL;
+
+	return NULL;
+}
+
+#define TO_REF(rb, field)	((field) = (void *)of_live_to_ref(rb, field))
+#define FROM_REF(rb, field)	((field) = of_live_from_ref(rb, (ulong)(field)))
+
+/* Turn the pointers in @np, its siblings and their subtrees into offsets */
+static void of_live_stash_nodes(struct of_live_rebase *rb,
+				struct device_node *np)
+{
+	struct device_node *sibling;
+	struct property *pp, *next;
+
+	for (; np; np = sibling) {
+		sibling = np->sibling;
+		for (pp = np->properties; pp; pp = next) {
+			next = pp->next;
+			TO_REF(rb, pp->name);
+			TO_REF(rb, pp->value);
+			TO_REF(rb, pp->next);
+		}
+		of_live_stash_nodes(rb, np->child);
+		TO_REF(rb, np->name);
+		TO_REF(rb, np->type);
+		TO_REF(rb, np->full_name);
+		TO_REF(rb, np->properties);
+		TO_REF(rb, np->parent);
+		TO_REF(rb, np->child);
+		TO_REF(rb, np->sibling);
+	}
+}
+
+/* Turn the offsets in @np, its siblings and their subtrees into pointers */
+static void of_live_unstash_nodes(struct of_live_rebase *rb,
+				  struct device_node *np)
+{
+	struct property *pp;
+
+	for (; np && !rb->err; np = np->sibling) {
+		FROM_REF(rb, np->name);
+		FROM_REF(rb, np->type);
+		FROM_REF(rb, np->full_name);
+		FROM_REF(rb, np->properties);
+		FROM_REF(rb, np->parent);
+		FROM_REF(rb, np->child);
+		FROM_REF(rb, np->sibling);
+		for (pp = np->properties; pp && !rb->err; pp = pp->next) {
+			FROM_REF(rb, pp->name);
+			FROM_REF(rb, pp->value);
+			FROM_REF(rb, pp->next);
+		}
+		of_live_unstash_nodes(rb, np->child);
+	}
+}
+
+long of_live_stash_size(const void *fdt_blob)
+{
+	long size;
+
+	size = unflatten_dt_size(fdt_blob);
+	if (size < 0)
+		return size;
+
+	return OF_LIVE_STASH_HDR + size + 4;
+}
+
+int of_live_stash(const void *fdt_blob, void *buf, long size)
+{
+	struct of_live_stash *hdr = buf;
+	struct of_live_rebase rb;
+	struct device_node *root;
+	long tree_size;
+	int ret;
+
+	tree_size = unflatten_dt_size(fdt_blob);
+	if (tree_size < 0)
+		return tree_size;
+	if (OF_LIVE_STASH_HDR + tree_size + 4 > size)
+		return -ENOSPC;
+
+	rb.tree = buf + OF_LIVE_STASH_HDR;
+	rb.size = tree_size;
+	rb.fdt = fdt_blob;
+	rb.fdt_size = fdt_totalsize(fdt_blob);
+	rb.err = 0;
+	ret = unflatten_dt_into(fdt_blob, rb.tree, tree_size, &root);
+	if (ret)
+		return ret;
+	if ((void *)root != rb.tree)
+		return -EFAULT;
+	of_live_stash_nodes(&rb, root);
+	if (rb.err)
+		return rb.err;
+
+	hdr->magic = OF_LIVE_STASH_MAGIC;
+	hdr->fdt_size = rb.fdt_size;
+	hdr->fdt_crc = crc32(0, fdt_blob, rb.fdt_size);
+	hdr->size = tree_size;
+
+	return 0;
+}
+
+int of_live_unstash(void *buf, const void *fdt_blob,
+		    struct device_node **rootp)
+{
+	struct of_live_stash *hdr = buf;
+	struct of_live_rebase rb;
+
+	if (hdr->magic != OF_LIVE_STASH_MAGIC)
+		return -EINVAL;
+	if (!fdt_blob || fdt_check_header(fdt_blob) ||
+	    hdr->fdt_size != fdt_totalsize(fdt_blob) ||
+	    hdr->fdt_crc != crc32(0, fdt_blob, hdr->fdt_size))
+		return -ENOENT;
+
+	rb.tree = buf + OF_LIVE_STASH_HDR;
+	rb.size = hdr->size;
+	rb.fdt = fdt_blob;
+	rb.fdt_size = hdr->fdt_size;
+	rb.err = 0;
+
+	/* the tree is rebased in place, so can only be unstashed once */
+	hdr->magic = 0;
+	of_live_unstash_nodes(&rb, rb.tree);
+	if (rb.err)
+		return rb.err;
+	*rootp = rb.tree;
+
+	return 0;
+}
+
+int of_live_stash_handoff(const void *fdt_blob)
+{
+	long size;
+	void *buf;
+	int ret;
+
+	size = of_live_stash_size(fdt_blob);
+	if (size < 0)
+		return size;
+	buf = bloblist_add(BLOBLISTT_U_BOOT_LIVE_TREE, size, 0);
+	if (!buf)
+		return -ENOSPC;
+	ret = of_live_stash(fdt_blob, buf, size);
+	if (ret)
+		return ret;
+	debug("Stashed live tree: %lx bytes\n", size);
+
+	return 0;
+}
+
 int of_live_build(const void *fdt_blob, struct device_node **rootp)
 {
 	int ret;
 
 	debug("%s: start\n", __func__);
-	ret = unflatten_device_tree(fdt_blob, rootp);
+	ret = -ENOENT;
+	if (IS_ENABLED(CONFIG_OF_LIVE_HANDOFF)) {
+		void *buf;
+
+		buf = bloblist_find(BLOBLISTT_U_BOOT_LIVE_TREE, 0);
+		if (buf)
+			ret = of_live_unstash(buf, fdt_blob, rootp);
+		if (buf && ret)
+			log_warning("Cannot use stashed live tree (err=%d)\n",
+				    ret);
+	}
+	if (ret && IS_ENABLED(CONFIG_OF_LIVE_BUILTIN)) {
+		/* the board may have used another device tree or changed it */
+		ret = of_live_unstash(of_live_builtin, fdt_blob, rootp);
+		if (ret)
+			debug("Cannot use built-in live tree (err=%d)\n", ret);
+	}
+	if (!ret)
+		of_live_static_root = *rootp;
+	else
+		ret = unflatten_device_tree(fdt_blob, rootp);
 	if (ret) {
 		debug("Failed to create live tree: err=%d\n", ret);
 		return ret;
@@ -340,6 +621,15 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 
 void of_live_free(struct device_node *root)
 {
+	if (IS_ENABLED(CONFIG_OF_PHANDLE_INDEX))
+		of_reset_phandle_index();
+
+	/* a stashed tree is not in the malloc() area */
+	if (root == of_live_static_root) {
+		of_live_static_root = NULL;
+		return;
+	}
+
 	/* the tree is stored as a contiguous block of memory */
 	free(root);
 }
@@ -24,10 +24,10 @@ const uint8_t sha256_der_prefix[SHA256_DER_LEN] = {
  */
 #ifndef GET_UINT32_BE
 #define GET_UINT32_BE(n,b,i) {				\
-	(n) = ( (unsigned long) (b)[(i)    ] << 24 )	\
-	    | ( (unsigned long) (b)[(i) + 1] << 16 )	\
-	    | ( (unsigned long) (b)[(i) + 2] <<  8 )	\
-	    | ( (unsigned long) (b)[(i) + 3]       );	\
+	(n) = ( (uint32_t) (b)[(i)    ] << 24 )		\
+	    | ( (uint32_t) (b)[(i) + 1] << 16 )		\
+	    | ( (uint32_t) (b)[(i) + 2] <<  8 )		\
+	    | ( (uint32_t) (b)[(i) + 3]       );		\
 }
 #endif
 #ifndef PUT_UINT32_BE
@@ -54,147 +54,179 @@ void sha256_starts(sha256_context * ctx)
 	ctx->state[7] = 0x5BE0CD19;
 }
 
-static void sha256_process_one(sha256_context *ctx, const uint8_t data[64])
-{
-	uint32_t temp1, temp2;
-	uint32_t W[64];
-	uint32_t A, B, C, D, E, F, G, H;
+#define SHR(x, n) ((x) >> (n))
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
 
-	GET_UINT32_BE(W[0], data, 0);
-	GET_UINT32_BE(W[1], data, 4);
-	GET_UINT32_BE(W[2], data, 8);
-	GET_UINT32_BE(W[3], data, 12);
-	GET_UINT32_BE(W[4], data, 16);
-	GET_UINT32_BE(W[5], data, 20);
-	GET_UINT32_BE(W[6], data, 24);
-	GET_UINT32_BE(W[7], data, 28);
-	GET_UINT32_BE(W[8], data, 32);
-	GET_UINT32_BE(W[9], data, 36);
-	GET_UINT32_BE(W[10], data, 40);
-	GET_UINT32_BE(W[11], data, 44);
-	GET_UINT32_BE(W[12], data, 48);
-	GET_UINT32_BE(W[13], data, 52);
-	GET_UINT32_BE(W[14], data, 56);
-	GET_UINT32_BE(W[15], data, 60);
-
-#define SHR(x,n) ((x & 0xFFFFFFFF) >> n)
-#define ROTR(x,n) (SHR(x,n) | (x << (32 - n)))
-
-#define S0(x) (ROTR(x, 7) ^ ROTR(x,18) ^ SHR(x, 3))
-#define S1(x) (ROTR(x,17) ^ ROTR(x,19) ^ SHR(x,10))
-
-#define S2(x) (ROTR(x, 2) ^ ROTR(x,13) ^ ROTR(x,22))
-#define S3(x) (ROTR(x, 6) ^ ROTR(x,11) ^ ROTR(x,25))
-
-#define F0(x,y,z) ((x & y) | (z & (x | y)))
-#define F1(x,y,z) (z ^ (x & (y ^ z)))
-
-#define R(t)					\
-(						\
-	W[t] = S1(W[t - 2]) + W[t - 7] +	\
-		S0(W[t - 15]) + W[t - 16]	\
-)
+#define S0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ SHR(x, 3))
+#define S1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ SHR(x, 10))
 
-#define P(a,b,c,d,e,f,g,h,x,K) {		\
-	temp1 = h + S3(e) + F1(e,f,g) + K + x;	\
-	temp2 = S2(a) + F0(a,b,c);		\
-	d += temp1; h = temp1 + temp2;		\
-}
+#define S2(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define S3(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+
+#define F1(x, y, z) (z ^ (x & (y ^ z)))
+
+/*
+ * The message schedule only ever needs the last 16 words, so it is kept in a
+ * ring of 16 rather than expanded to 64 words in memory
+ */
+#define R(t)						\
+(							\
+	W[(t) & 15] += S1(W[((t) - 2) & 15]) +		\
+		W[((t) - 7) & 15] + S0(W[((t) - 15) & 15])	\
+)
 
-	A = ctx->state[0];
-	B = ctx->state[1];
-	C = ctx->state[2];
-	D = ctx->state[3];
-	E = ctx->state[4];
-	F = ctx->state[5];
-	G = ctx->state[6];
-	H = ctx->state[7];
-
-	P(A, B, C, D, E, F, G, H, W[0], 0x428A2F98);
-	P(H, A, B, C, D, E, F, G, W[1], 0x71374491);
-	P(G, H, A, B, C, D, E, F, W[2], 0xB5C0FBCF);
-	P(F, G, H, A, B, C, D, E, W[3], 0xE9B5DBA5);
-	P(E, F, G, H, A, B, C, D, W[4], 0x3956C25B);
-	P(D, E, F, G, H, A, B, C, W[5], 0x59F111F1);
-	P(C, D, E, F, G, H, A, B, W[6], 0x923F82A4);
-	P(B, C, D, E, F, G, H, A, W[7], 0xAB1C5ED5);
-	P(A, B, C, D, E, F, G, H, W[8], 0xD807AA98);
-	P(H, A, B, C, D, E, F, G, W[9], 0x12835B01);
-	P(G, H, A, B, C, D, E, F, W[10], 0x243185BE);
-	P(F, G, H, A, B, C, D, E, W[11], 0x550C7DC3);
-	P(E, F, G, H, A, B, C, D, W[12], 0x72BE5D74);
-	P(D, E, F, G, H, A, B, C, W[13], 0x80DEB1FE);
-	P(C, D, E, F, G, H, A, B, W[14], 0x9BDC06A7);
-	P(B, C, D, E, F, G, H, A, W[15], 0xC19BF174);
-	P(A, B, C, D, E, F, G, H, R(16), 0xE49B69C1);
-	P(H, A, B, C, D, E, F, G, R(17), 0xEFBE4786);
-	P(G, H, A, B, C, D, E, F, R(18), 0x0FC19DC6);
-	P(F, G, H, A, B, C, D, E, R(19), 0x240CA1CC);
-	P(E, F, G, H, A, B, C, D, R(20), 0x2DE92C6F);
-	P(D, E, F, G, H, A, B, C, R(21), 0x4A7484AA);
-	P(C, D, E, F, G, H, A, B, R(22), 0x5CB0A9DC);
-	P(B, C, D, E, F, G, H, A, R(23), 0x76F988DA);
-	P(A, B, C, D, E, F, G, H, R(24), 0x983E5152);
-	P(H, A, B, C, D, E, F, G, R(25), 0xA831C66D);
-	P(G, H, A, B, C, D, E, F, R(26), 0xB00327C8);
-	P(F, G, H, A, B, C, D, E, R(27), 0xBF597FC7);
-	P(E, F, G, H, A, B, C, D, R(28), 0xC6E00BF3);
-	P(D, E, F, G, H, A, B, C, R(29), 0xD5A79147);
-	P(C, D, E, F, G, H, A, B, R(30), 0x06CA6351);
-	P(B, C, D, E, F, G, H, A, R(31), 0x14292967);
-	P(A, B, C, D, E, F, G, H, R(32), 0x27B70A85);
-	P(H, A, B, C, D, E, F, G, R(33), 0x2E1B2138);
-	P(G, H, A, B, C, D, E, F, R(34), 0x4D2C6DFC);
-	P(F, G, H, A, B, C, D, E, R(35), 0x53380D13);
-	P(E, F, G, H, A, B, C, D, R(36), 0x650A7354);
-	P(D, E, F, G, H, A, B, C, R(37), 0x766A0ABB);
-	P(C, D, E, F, G, H, A, B, R(38), 0x81C2C92E);
-	P(B, C, D, E, F, G, H, A, R(39), 0x92722C85);
-	P(A, B, C, D, E, F, G, H, R(40), 0xA2BFE8A1);
-	P(H, A, B, C, D, E, F, G, R(41), 0xA81A664B);
-	P(G, H, A, B, C, D, E, F, R(42), 0xC24B8B70);
-	P(F, G, H, A, B, C, D, E, R(43), 0xC76C51A3);
-	P(E, F, G, H, A, B, C, D, R(44), 0xD192E819);
-	P(D, E, F, G, H, A, B, C, R(45), 0xD6990624);
-	P(C, D, E, F, G, H, A, B, R(46), 0xF40E3585);
-	P(B, C, D, E, F, G, H, A, R(47), 0x106AA070);
-	P(A, B, C, D, E, F, G, H, R(48), 0x19A4C116);
-	P(H, A, B, C, D, E, F, G, R(49), 0x1E376C08);
-	P(G, H, A, B, C, D, E, F, R(50), 0x2748774C);
-	P(F, G, H, A, B, C, D, E, R(51), 0x34B0BCB5);
-	P(E, F, G, H, A, B, C, D, R(52), 0x391C0CB3);
-	P(D, E, F, G, H, A, B, C, R(53), 0x4ED8AA4A);
-	P(C, D, E, F, G, H, A, B, R(54), 0x5B9CCA4F);
-	P(B, C, D, E, F, G, H, A, R(55), 0x682E6FF3);
-	P(A, B, C, D, E, F, G, H, R(56), 0x748F82EE);
-	P(H, A, B, C, D, E, F, G, R(57), 0x78A5636F);
-	P(G, H, A, B, C, D, E, F, R(58), 0x84C87814);
-	P(F, G, H, A, B, C, D, E, R(59), 0x8CC70208);
-	P(E, F, G, H, A, B, C, D, R(60), 0x90BEFFFA);
-	P(D, E, F, G, H, A, B, C, R(61), 0xA4506CEB);
-	P(C, D, E, F, G, H, A, B, R(62), 0xBEF9A3F7);
-	P(B, C, D, E, F, G, H, A, R(63), 0xC67178F2);
-
-	ctx->state[0] += A;
-	ctx->state[1] += B;
-	ctx->state[2] += C;
-	ctx->state[3] += D;
-	ctx->state[4] += E;
-	ctx->state[5] += F;
-	ctx->state[6] += G;
-	ctx->state[7] += H;
+/*
+ * Maj(a, b, c) is computed as b ^ ((a ^ b) & (b ^ c)), where b ^ c is a ^ b
+ * of the previous round
+ */
+#define P(a, b, c, d, e, f, g, h, x, K) {		\
+	temp1 = h + S3(e) + F1(e, f, g) + K + x;	\
+	ab = a ^ b;					\
+	temp2 = S2(a) + (b ^ (ab & bc));		\
+	bc = ab;					\
+	d += temp1; h = temp1 + temp2;			\
 }
 
-__weak void sha256_process(sha256_context *ctx, const unsigned char *data,
-			   unsigned int blocks)
+/*
+ * Process @blocks 64-byte blocks. The rounds are unrolled so that the working
+ * variables and the message schedule can stay in registers, and the state is
+ * only loaded and stored once for all the blocks.
+ */
+static void sha256_process_blocks(uint32_t state[8], const uint8_t *data,
+				  unsigned int blocks)
 {
-	if (!blocks)
-		return;
+	uint32_t temp1, temp2, ab, bc;
+	uint32_t W[16];
+	uint32_t A, B, C, D, E, F, G, H;
+	uint32_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+	s0 = state[0];
+	s1 = state[1];
+	s2 = state[2];
+	s3 = state[3];
+	s4 = state[4];
+	s5 = state[5];
+	s6 = state[6];
+	s7 = state[7];
 
 	while (blocks--) {
-		sha256_process_one(ctx, data);
+		GET_UINT32_BE(W[0], data, 0);
+		GET_UINT32_BE(W[1], data, 4);
+		GET_UINT32_BE(W[2], data, 8);
+		GET_UINT32_BE(W[3], data, 12);
+		GET_UINT32_BE(W[4], data, 16);
+		GET_UINT32_BE(W[5], data, 20);
+		GET_UINT32_BE(W[6], data, 24);
+		GET_UINT32_BE(W[7], data, 28);
+		GET_UINT32_BE(W[8], data, 32);
+		GET_UINT32_BE(W[9], data, 36);
+		GET_UINT32_BE(W[10], data, 40);
+		GET_UINT32_BE(W[11], data, 44);
+		GET_UINT32_BE(W[12], data, 48);
+		GET_UINT32_BE(W[13], data, 52);
+		GET_UINT32_BE(W[14], data, 56);
+		GET_UINT32_BE(W[15], data, 60);
+
+		A = s0;
+		B = s1;
+		C = s2;
+		D = s3;
+		E = s4;
+		F = s5;
+		G = s6;
+		H = s7;
+		bc = B ^ C;
+
+		P(A, B, C, D, E, F, G, H, W[0], 0x428A2F98);
+		P(H, A, B, C, D, E, F, G, W[1], 0x71374491);
+		P(G, H, A, B, C, D, E, F, W[2], 0xB5C0FBCF);
+		P(F, G, H, A, B, C, D, E, W[3], 0xE9B5DBA5);
+		P(E, F, G, H, A, B, C, D, W[4], 0x3956C25B);
+		P(D, E, F, G, H, A, B, C, W[5], 0x59F111F1);
+		P(C, D, E, F, G, H, A, B, W[6], 0x923F82A4);
+		P(B, C, D, E, F, G, H, A, W[7], 0xAB1C5ED5);
+		P(A, B, C, D, E, F, G, H, W[8], 0xD807AA98);
+		P(H, A, B, C, D, E, F, G, W[9], 0x12835B01);
+		P(G, H, A, B, C, D, E, F, W[10], 0x243185BE);
+		P(F, G, H, A, B, C, D, E, W[11], 0x550C7DC3);
+		P(E, F, G, H, A, B, C, D, W[12], 0x72BE5D74);
+		P(D, E, F, G, H, A, B, C, W[13], 0x80DEB1FE);
+		P(C, D, E, F, G, H, A, B, W[14], 0x9BDC06A7);
+		P(B, C, D, E, F, G, H, A, W[15], 0xC19BF174);
+		P(A, B, C, D, E, F, G, H, R(16), 0xE49B69C1);
+		P(H, A, B, C, D, E, F, G, R(17), 0xEFBE4786);
+		P(G, H, A, B, C, D, E, F, R(18), 0x0FC19DC6);
+		P(F, G, H, A, B, C, D, E, R(19), 0x240CA1CC);
+		P(E, F, G, H, A, B, C, D, R(20), 0x2DE92C6F);
+		P(D, E, F, G, H, A, B, C, R(21), 0x4A7484AA);
+		P(C, D, E, F, G, H, A, B, R(22), 0x5CB0A9DC);
+		P(B, C, D, E, F, G, H, A, R(23), 0x76F988DA);
+		P(A, B, C, D, E, F, G, H, R(24), 0x983E5152);
+		P(H, A, B, C, D, E, F, G, R(25), 0xA831C66D);
+		P(G, H, A, B, C, D, E, F, R(26), 0xB00327C8);
+		P(F, G, H, A, B, C, D, E, R(27), 0xBF597FC7);
+		P(E, F, G, H, A, B, C, D, R(28), 0xC6E00BF3);
+		P(D, E, F, G, H, A, B, C, R(29), 0xD5A79147);
+		P(C, D, E, F, G, H, A, B, R(30), 0x06CA6351);
+		P(B, C, D, E, F, G, H, A, R(31), 0x14292967);
+		P(A, B, C, D, E, F, G, H, R(32), 0x27B70A85);
+		P(H, A, B, C, D, E, F, G, R(33), 0x2E1B2138);
+		P(G, H, A, B, C, D, E, F, R(34), 0x4D2C6DFC);
+		P(F, G, H, A, B, C, D, E, R(35), 0x53380D13);
+		P(E, F, G, H, A, B, C, D, R(36), 0x650A7354);
+		P(D, E, F, G, H, A, B, C, R(37), 0x766A0ABB);
+		P(C, D, E, F, G, H, A, B, R(38), 0x81C2C92E);
+		P(B, C, D, E, F, G, H, A, R(39), 0x92722C85);
+		P(A, B, C, D, E, F, G, H, R(40), 0xA2BFE8A1);
+		P(H, A, B, C, D, E, F, G, R(41), 0xA81A664B);
+		P(G, H, A, B, C, D, E, F, R(42), 0xC24B8B70);
+		P(F, G, H, A, B, C, D, E, R(43), 0xC76C51A3);
+		P(E, F, G, H, A, B, C, D, R(44), 0xD192E819);
+		P(D, E, F, G, H, A, B, C, R(45), 0xD6990624);
+		P(C, D, E, F, G, H, A, B, R(46), 0xF40E3585);
+		P(B, C, D, E, F, G, H, A, R(47), 0x106AA070);
+		P(A, B, C, D, E, F, G, H, R(48), 0x19A4C116);
+		P(H, A, B, C, D, E, F, G, R(49), 0x1E376C08);
+		P(G, H, A, B, C, D, E, F, R(50), 0x2748774C);
+		P(F, G, H, A, B, C, D, E, R(51), 0x34B0BCB5);
+		P(E, F, G, H, A, B, C, D, R(52), 0x391C0CB3);
+		P(D, E, F, G, H, A, B, C, R(53), 0x4ED8AA4A);
+		P(C, D, E, F, G, H, A, B, R(54), 0x5B9CCA4F);
+		P(B, C, D, E, F, G, H, A, R(55), 0x682E6FF3);
+		P(A, B, C, D, E, F, G, H, R(56), 0x748F82EE);
+		P(H, A, B, C, D, E, F, G, R(57), 0x78A5636F);
+		P(G, H, A, B, C, D, E, F, R(58), 0x84C87814);
+		P(F, G, H, A, B, C, D, E, R(59), 0x8CC70208);
+		P(E, F, G, H, A, B, C, D, R(60), 0x90BEFFFA);
+		P(D, E, F, G, H, A, B, C, R(61), 0xA4506CEB);
+		P(C, D, E, F, G, H, A, B, R(62), 0xBEF9A3F7);
+		P(B, C, D, E, F, G, H, A, R(63), 0xC67178F2);
+
+		s0 += A;
+		s1 += B;
+		s2 += C;
+		s3 += D;
+		s4 += E;
+		s5 += F;
+		s6 += G;
+		s7 += H;
 		data += 64;
 	}
+
+	state[0] = s0;
+	state[1] = s1;
+	state[2] = s2;
+	state[3] = s3;
+	state[4] = s4;
+	state[5] = s5;
+	state[6] = s6;
+	state[7] = s7;
+}
+
+__weak void sha256_process(sha256_context *ctx, const unsigned char *data,
+			   unsigned int blocks)
+{
+	sha256_process_blocks(ctx->state, data, blocks);
 }
 
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
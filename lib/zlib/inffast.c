@@ -31,6 +31,29 @@
 #  define PUP(a) *++(a)
 #endif
 
+/*
+   U-Boot: with a 64-bit bit buffer, refill it eight bytes at a time with an
+   unaligned load, which is enough for a whole length/distance pair, and
+   copy matches a word at a time.  Words are only copied as a whole when the
+   source is at least a word behind the destination, so that an overlapping
+   copy still repeats the right bytes.
+ */
+#if BITS_PER_LONG == 64
+#  define INFLATE_WIDE
+#  define COPYWORD(o, f) \
+    put_unaligned(get_unaligned((unsigned long FAR *)((f) + OFF)), \
+                  (unsigned long FAR *)((o) + OFF))
+#  define COPYWORDS(n) \
+    while ((n) >= 8) { \
+        COPYWORD(out, from); \
+        out += 8; \
+        from += 8; \
+        (n) -= 8; \
+    }
+#else
+#  define COPYWORDS(n)
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -127,10 +150,18 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef INFLATE_WIDE
+        if (bits < 48 && last - in > 2) {
+            hold |= (unsigned long)get_unaligned_le64(in + OFF) << bits;
+            in += (63 - bits) >> 3;
+            bits |= 56;
+        }
+        else
+#endif
         if (bits < 15) {
-            hold += (unsigned long)(PUP(in)) << bits;
+            hold |= (unsigned long)(PUP(in)) << bits;
             bits += 8;
-            hold += (unsigned long)(PUP(in)) << bits;
+            hold |= (unsigned long)(PUP(in)) << bits;
             bits += 8;
         }
         this = lcode[hold & lmask];
@@ -150,7 +181,7 @@ void inflate_fast(z_streamp strm, unsigned start)
             op &= 15;                           /* number of extra bits */
             if (op) {
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold |= (unsigned long)(PUP(in)) << bits;
                     bits += 8;
                 }
                 len += (unsigned)hold & ((1U << op) - 1);
@@ -159,9 +190,9 @@ void inflate_fast(z_streamp strm, unsigned start)
             }
             Tracevv((stderr, "inflate:         length %u\n", len));
             if (bits < 15) {
-                hold += (unsigned long)(PUP(in)) << bits;
+                hold |= (unsigned long)(PUP(in)) << bits;
                 bits += 8;
-                hold += (unsigned long)(PUP(in)) << bits;
+                hold |= (unsigned long)(PUP(in)) << bits;
                 bits += 8;
             }
             this = dcode[hold & dmask];
@@ -174,10 +205,10 @@ void inflate_fast(z_streamp strm, unsigned start)
                 dist = (unsigned)(this.val);
                 op &= 15;                       /* number of extra bits */
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold |= (unsigned long)(PUP(in)) << bits;
                     bits += 8;
                     if (bits < op) {
-                        hold += (unsigned long)(PUP(in)) << bits;
+                        hold |= (unsigned long)(PUP(in)) << bits;
                         bits += 8;
                     }
                 }
@@ -205,9 +236,9 @@ void inflate_fast(z_streamp strm, unsigned start)
                         from += wsize - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
+                            COPYWORDS(op);
+                            for (; op; op--)
                                 PUP(out) = PUP(from);
-                            } while (--op);
                             from = out - dist;  /* rest from output */
                         }
                     }
@@ -216,16 +247,16 @@ void inflate_fast(z_streamp strm, unsigned start)
                         op -= write;
                         if (op < len) {         /* some from end of window */
                             len -= op;
-                            do {
+                            COPYWORDS(op);
+                            for (; op; op--)
                                 PUP(out) = PUP(from);
-                            } while (--op);
                             from = window - OFF;
                             if (write < len) {  /* some from start of window */
                                 op = write;
                                 len -= op;
-                                do {
+                                COPYWORDS(op);
+                                for (; op; op--)
                                     PUP(out) = PUP(from);
-                                } while (--op);
                                 from = out - dist;      /* rest from output */
                             }
                         }
@@ -234,12 +265,15 @@ void inflate_fast(z_streamp strm, unsigned start)
                         from += write - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
+                            COPYWORDS(op);
+                            for (; op; op--)
                                 PUP(out) = PUP(from);
-                            } while (--op);
                             from = out - dist;  /* rest from output */
                         }
                     }
+                    if (dist >= 8) {
+                        COPYWORDS(len);
+                    }
                     while (len > 2) {
                         PUP(out) = PUP(from);
                         PUP(out) = PUP(from);
@@ -253,6 +287,44 @@ void inflate_fast(z_streamp strm, unsigned start)
                     }
                 }
                 else {
+#ifdef INFLATE_WIDE
+                    from = out - dist;          /* copy direct from output */
+                    if (dist >= 16) {           /* long matches by 16 bytes */
+                        while (len >= 16) {
+                            COPYWORD(out, from);
+                            COPYWORD(out + 8, from + 8);
+                            out += 16;
+                            from += 16;
+                            len -= 16;
+                        }
+                    }
+                    if (dist >= 8) {
+                        COPYWORDS(len);
+                    }
+                    else if (dist == 1) {       /* run of one byte */
+                        unsigned long pat;
+
+                        pat = 0x0101010101010101UL * from[OFF];
+                        while (len >= 8) {
+                            put_unaligned(pat,
+                                          (unsigned long FAR *)(out + OFF));
+                            out += 8;
+                            len -= 8;
+                        }
+                        from = out - dist;
+                    }
+                    while (len > 2) {
+                        PUP(out) = PUP(from);
+                        PUP(out) = PUP(from);
+                        PUP(out) = PUP(from);
+                        len -= 3;
+                    }
+                    if (len) {
+                        PUP(out) = PUP(from);
+                        if (len > 1)
+                            PUP(out) = PUP(from);
+                    }
+#else
 		    unsigned short *sout;
 		    unsigned long loops;
 
@@ -294,6 +366,7 @@ void inflate_fast(z_streamp strm, unsigned start)
 		    }
 		    if (len & 1)
 			PUP(out) = PUP(from);
+#endif
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
@@ -6,12 +6,43 @@
 #define LOG_CATEGORY	LOGC_BOOT
 
 #include <abuf.h>
+#include <blk.h>
+#include <console.h>
+#include <div64.h>
 #include <log.h>
 #include <malloc.h>
+#include <memalign.h>
+#include <time.h>
+#include <watchdog.h>
 #include <linux/errno.h>
+#include <linux/kernel.h>
 #include <linux/zstd.h>
 
-int zstd_decompress(struct abuf *in, struct abuf *out)
+/* Largest window accepted by zstd_write(), the default limit of the zstd tool */
+#define ZSTD_WRITE_WINDOW_MAX	(1UL << 27)
+
+#if CONFIG_IS_ENABLED(ZSTD_DICT)
+/* Built-in dictionary, see cmd_S_zstd_dict in scripts/Makefile.lib */
+extern const char zstd_dict[], zstd_dict_end[];
+#endif
+
+/* Find the built-in dictionary with ID @id */
+static const void *zstd_find_dict(uint id, size_t *sizep)
+{
+#if CONFIG_IS_ENABLED(ZSTD_DICT)
+	size_t size = zstd_dict_end - zstd_dict;
+
+	if (zstd_get_dict_id_from_dict(zstd_dict, size) == id) {
+		*sizep = size;
+		return zstd_dict;
+	}
+#endif
+
+	return NULL;
+}
+
+int zstd_decompress_dict(struct abuf *in, struct abuf *out, const void *dict,
+			 size_t dict_size)
 {
 	zstd_dctx *ctx;
 	size_t wsize, len;
@@ -45,8 +76,8 @@ int zstd_decompress(struct abuf *in, struct abuf *out)
 		goto do_free;
 	}
 
-	len = zstd_decompress_dctx(ctx, abuf_data(out), abuf_size(out),
-				   abuf_data(in), len);
+	len = zstd_decompress_using_dict(ctx, abuf_data(out), abuf_size(out),
+					 abuf_data(in), len, dict, dict_size);
 	if (zstd_is_error(len)) {
 		log_err("%s: failed to decompress: %d\n", __func__,
 			zstd_get_error_code(len));
@@ -59,3 +90,187 @@ do_free:
 	free(workspace);
 	return ret;
 }
+
+int zstd_decompress(struct abuf *in, struct abuf *out)
+{
+	const void *dict = NULL;
+	size_t dict_size = 0;
+	uint id;
+
+	id = zstd_get_dict_id_from_frame(abuf_data(in), abuf_size(in));
+	if (id) {
+		dict = zstd_find_dict(id, &dict_size);
+		if (!dict) {
+			log_err("%s: dictionary %u not available\n", __func__,
+				id);
+			return -ENOKEY;
+		}
+	}
+
+	return zstd_decompress_dict(in, out, dict, dict_size);
+}
+
+#if CONFIG_IS_ENABLED(BLK)
+/*
+ * Find the end of the frames at @src, ignoring any trailing data, with the
+ * largest window they need and their total size, or 0 if a frame does not
+ * record its size
+ */
+static int zstd_scan_frames(const void *src, size_t len, size_t *endp,
+			    size_t *windowp, u64 *sizep)
+{
+	zstd_frame_header fh;
+	size_t pos, ret;
+	bool known = true;
+
+	*windowp = 0;
+	*sizep = 0;
+	for (pos = 0; pos < len; pos += ret) {
+		ret = zstd_get_frame_header(&fh, src + pos, len - pos);
+		if (ret) {
+			if (!pos) {
+				printf("%s: not zstd data\n", __func__);
+				return -EINVAL;
+			}
+			break;
+		}
+		ret = zstd_find_frame_compressed_size(src + pos, len - pos);
+		if (zstd_is_error(ret)) {
+			printf("%s: frame at %zx truncated or corrupt\n",
+			       __func__, pos);
+			return -EINVAL;
+		}
+		if (fh.frameType == ZSTD_skippableFrame)
+			continue;
+		*windowp = max_t(size_t, *windowp, fh.windowSize);
+		if (fh.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+			known = false;
+		else
+			*sizep += fh.frameContentSize;
+	}
+	*endp = pos;
+	if (!known)
+		*sizep = 0;
+
+	return 0;
+}
+
+static ulong zstd_write_rate(u64 bytes, ulong us)
+{
+	return us ? lldiv(bytes * 1000000 / 1024, us) : 0;
+}
+
+int zstd_write(const void *src, ulong len, struct blk_desc *dev,
+	       ulong szwritebuf, u64 startoffs, u64 szexpected)
+{
+	zstd_in_buffer in = { .src = src };
+	zstd_out_buffer out = { .size = szwritebuf };
+	ulong dec_us = 0, write_us = 0, start;
+	size_t window, wsize, ret;
+	lbaint_t blk, cnt;
+	zstd_dstream *ds;
+	void *workspace;
+	u64 size, total = 0;
+	bool done;
+	int err;
+
+	if (!szwritebuf || szwritebuf % dev->blksz ||
+	    startoffs & (dev->blksz - 1)) {
+		printf("%s: size %lx or offset %llx not a multiple of %lx\n",
+		       __func__, szwritebuf, startoffs, dev->blksz);
+		return -EINVAL;
+	}
+	err = zstd_scan_frames(src, len, &in.size, &window, &size);
+	if (err)
+		return err;
+	if (!szexpected)
+		szexpected = size;
+	if (window > ZSTD_WRITE_WINDOW_MAX) {
+		printf("%s: window of %zx bytes too large\n", __func__, window);
+		return -E2BIG;
+	}
+	blk = lldiv(startoffs, dev->blksz);
+	if (blk + lldiv(szexpected + dev->blksz - 1, dev->blksz) > dev->lba) {
+		printf("%s: uncompressed size %llx exceeds device size\n",
+		       __func__, szexpected);
+		return -ENOSPC;
+	}
+
+	wsize = zstd_dstream_workspace_bound(window);
+	workspace = malloc(wsize);
+	out.dst = malloc_cache_aligned(szwritebuf);
+	if (!workspace || !out.dst) {
+		err = -ENOMEM;
+		goto do_free;
+	}
+	ds = zstd_init_dstream(window, workspace, wsize);
+	if (!ds) {
+		err = -EPERM;
+		goto do_free;
+	}
+
+	do {
+		start = timer_get_us();
+		ret = zstd_decompress_stream(ds, &out, &in);
+		dec_us += timer_get_us() - start;
+		if (zstd_is_error(ret)) {
+			printf("%s: corrupt data at %zx: %s\n", __func__,
+			       in.pos, zstd_get_error_name(ret));
+			err = -EINVAL;
+			break;
+		}
+		done = !ret && in.pos == in.size;
+		if (!done && in.pos == in.size && out.pos < out.size) {
+			printf("%s: truncated data\n", __func__);
+			err = -EINVAL;
+			break;
+		}
+		if (out.pos < out.size && !(done && out.pos))
+			continue;
+
+		cnt = DIV_ROUND_UP(out.pos, dev->blksz);
+		if (out.pos % dev->blksz)
+			memset(out.dst + out.pos, '\0',
+			       dev->blksz - out.pos % dev->blksz);
+		if (blk + cnt > dev->lba) {
+			printf("%s: uncompressed size exceeds device size\n",
+			       __func__);
+			err = -ENOSPC;
+			break;
+		}
+		start = timer_get_us();
+		if (blk_dwrite(dev, blk, cnt, out.dst) != cnt) {
+			printf("%s: write failed at block " LBAF "\n",
+			       __func__, blk);
+			err = -EIO;
+			break;
+		}
+		write_us += timer_get_us() - start;
+		blk += cnt;
+		total += out.pos;
+		out.pos = 0;
+		printf("%llu/%llu\r", total, szexpected);
+		if (ctrlc()) {
+			puts("abort\n");
+			err = -EINTR;
+			break;
+		}
+		schedule();
+	} while (!done);
+
+	if (!err && szexpected && total != szexpected) {
+		printf("\n\tuncompressed %llu of %llu\n", total, szexpected);
+		err = -EIO;
+	} else if (!err) {
+		printf("\n\t%llu bytes, decompress %lu KiB/s, write %lu KiB/s\n",
+		       total, zstd_write_rate(total, dec_us),
+		       zstd_write_rate(total, write_us));
+	}
+
+do_free:
+	free(out.dst);
+	free(workspace);
+
+	return err;
+}
+#endif
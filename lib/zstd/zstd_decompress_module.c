@@ -59,6 +59,15 @@ size_t zstd_decompress_dctx(zstd_dctx *dctx, void *dst, size_t dst_capacity,
 }
 EXPORT_SYMBOL(zstd_decompress_dctx);
 
+size_t zstd_decompress_using_dict(zstd_dctx *dctx, void *dst,
+	size_t dst_capacity, const void *src, size_t src_size,
+	const void *dict, size_t dict_size)
+{
+	return ZSTD_decompress_usingDict(dctx, dst, dst_capacity, src, src_size,
+		dict, dict_size);
+}
+EXPORT_SYMBOL(zstd_decompress_using_dict);
+
 size_t zstd_dstream_workspace_bound(size_t max_window_size)
 {
 	return ZSTD_estimateDStreamSize(max_window_size);
@@ -101,5 +110,17 @@ size_t zstd_get_frame_header(zstd_frame_header *header, const void *src,
 }
 EXPORT_SYMBOL(zstd_get_frame_header);
 
+unsigned int zstd_get_dict_id_from_dict(const void *dict, size_t dict_size)
+{
+	return ZSTD_getDictID_fromDict(dict, dict_size);
+}
+EXPORT_SYMBOL(zstd_get_dict_id_from_dict);
+
+unsigned int zstd_get_dict_id_from_frame(const void *src, size_t src_size)
+{
+	return ZSTD_getDictID_fromFrame(src, src_size);
+}
+EXPORT_SYMBOL(zstd_get_dict_id_from_frame);
+
 MODULE_LICENSE("Dual BSD/GPL");
 MODULE_DESCRIPTION("Zstd Decompressor");
@@ -100,6 +100,8 @@
 #if defined(CONFIG_CMD_PCAP)
 #include <net/pcap.h>
 #endif
+#include <net/pktbuf.h>
+#include <net/sink.h>
 #include <net/udp.h>
 #if defined(CONFIG_LED_STATUS)
 #include <miiphy.h>
@@ -187,7 +189,6 @@ u32 net_boot_file_size;
 /* Boot file size in blocks as reported by the DHCP server */
 u32 net_boot_file_expected_size_in_blocks;
 
-static uchar net_pkt_buf[(PKTBUFSRX+1) * PKTSIZE_ALIGN + PKTALIGN];
 /* Receive packets */
 uchar *net_rx_packets[PKTBUFSRX];
 /* Current UDP RX packet handler */
@@ -399,16 +400,14 @@ int net_init(void)
 
 	if (first_call) {
 		/*
-		 *	Setup packet buffers, aligned correctly.
+		 *	Setup packet buffers, taken from the packet pool and
+		 *	kept for the lifetime of the network stack.
 		 */
 		int i;
 
-		net_tx_packet = &net_pkt_buf[0] + (PKTALIGN - 1);
-		net_tx_packet -= (ulong)net_tx_packet % PKTALIGN;
-		for (i = 0; i < PKTBUFSRX; i++) {
-			net_rx_packets[i] = net_tx_packet +
-				(i + 1) * PKTSIZE_ALIGN;
-		}
+		net_tx_packet = pktbuf_alloc();
+		for (i = 0; i < PKTBUFSRX; i++)
+			net_rx_packets[i] = pktbuf_alloc();
 		arp_init();
 		ndisc_init();
 		net_clear_handlers();
@@ -422,15 +421,25 @@ int net_init(void)
 	return net_init_loop();
 }
 
+/* Check whether a protocol loads a file into memory */
+static bool net_loop_loads(enum proto_t protocol)
+{
+	return protocol == TFTPGET || protocol == NFS || protocol == WGET;
+}
+
 /**********************************************************************/
 /*
  *	Main network processing loop.
  */
 
-int net_loop(enum proto_t protocol)
+int net_loop_size(enum proto_t protocol, ulong *sizep)
 {
 	int ret = -EINVAL;
 	enum net_loop_state prev_net_state = net_state;
+	ulong size = 0;
+
+	if (sizep)
+		*sizep = 0;
 
 #if defined(CONFIG_CMD_PING)
 	if (protocol != PING)
@@ -464,6 +473,8 @@ int net_loop(enum proto_t protocol)
 	} else {
 		eth_init_state_only();
 	}
+	if (net_loop_loads(protocol))
+		bootstage_start(BOOTSTAGE_ID_ACCUM_LOAD, "load");
 
 restart:
 #ifdef CONFIG_USB_KEYBOARD
@@ -496,6 +507,8 @@ restart:
 	case 0:
 		net_dev_exists = 1;
 		net_boot_file_size = 0;
+		if (net_loop_loads(protocol) && !net_sink_active())
+			fit_load_hash_start(image_load_addr);
 		switch (protocol) {
 #ifdef CONFIG_CMD_TFTPBOOT
 		case TFTPGET:
@@ -728,7 +741,8 @@ restart:
 
 			eth_set_last_protocol(protocol);
 
-			ret = net_boot_file_size;
+			ret = 0;
+			size = net_boot_file_size;
 			debug_cond(DEBUG_INT_STATE, "--- net_loop Success!\n");
 			goto done;
 
@@ -746,6 +760,12 @@ restart:
 	}
 
 done:
+	if (net_loop_loads(protocol)) {
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_LOAD);
+		if (!net_sink_active())
+			fit_load_hash_end(ret >= 0, net_boot_file_size);
+	}
+	ret = net_sink_end(net_loop_loads(protocol), ret, size);
 #ifdef CONFIG_USB_KEYBOARD
 	net_busy_flag = 0;
 #endif
@@ -760,9 +780,24 @@ done:
 	if (pcap_active())
 		pcap_print_status();
 #endif
+	if (!ret && sizep)
+		*sizep = size;
+
 	return ret;
 }
 
+int net_loop(enum proto_t protocol)
+{
+	ulong size;
+	int ret;
+
+	ret = net_loop_size(protocol, &size);
+	if (ret)
+		return ret;
+
+	return size > INT_MAX ? -EFBIG : size;
+}
+
 /**********************************************************************/
 
 static void start_again_timeout_handler(void)
@@ -41,6 +41,7 @@
 #include <net.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <net/sink.h>
 #include "nfs.h"
 #include "bootp.h"
 #include <time.h>
@@ -55,6 +56,8 @@ static int fs_mounted;
 static unsigned long rpc_id;
 static int nfs_offset = -1;
 static int nfs_len;
+static unsigned int nfs_read_eof;	/* End of file, once a READ hit it */
+static unsigned int nfs_received;	/* Bytes received, for progress */
 static const ulong nfs_timeout = CONFIG_NFS_TIMEOUT;
 
 static char dirfh[NFS_FHSIZE];	/* NFSv2 / NFSv3 file handle of directory */
@@ -75,6 +78,20 @@ static int nfs_state;
 #define STATE_LOOKUP_REQ		5
 #define STATE_READ_REQ			6
 #define STATE_READLINK_REQ		7
+#define STATE_FSINFO_REQ		8
+
+/*
+ * READ requests in flight. Up to CONFIG_NFS_READ_WINDOW requests are kept
+ * outstanding; replies are matched by XID and stored at the offset of their
+ * request, so they may arrive in any order.
+ */
+struct nfs_read_slot {
+	unsigned long id;	/* RPC XID of the request, 0 if the slot is free */
+	unsigned int offset;
+	unsigned int len;
+};
+
+static struct nfs_read_slot nfs_read_slots[CONFIG_NFS_READ_WINDOW];
 
 static char *nfs_filename;
 static char *nfs_path;
@@ -111,11 +128,15 @@ static inline int store_block(uchar *src, unsigned offset, unsigned len)
 		}
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_NFS */
-	{
+	if (net_sink_active()) {
+		if (net_sink_store(offset, src, len))
+			return -1;
+	} else {
 		void *ptr = map_sysmem(image_load_addr + offset, len);
 
 		memcpy(ptr, src, len);
 		unmap_sysmem(ptr);
+		fit_load_hash_update(image_load_addr + offset, len);
 	}
 
 	if (net_boot_file_size < (offset + len))
@@ -425,6 +446,95 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+/**************************************************************************
+NFS_FSINFO - Get the preferred READ size (NFSv3 only)
+**************************************************************************/
+static void nfs_fsinfo_req(void)
+{
+	uint32_t data[1024];
+	uint32_t *p;
+	int len;
+
+	p = &(data[0]);
+	p = rpc_add_credentials(p);
+
+	*p++ = htonl(filefh3_length);
+	memcpy(p, filefh, filefh3_length);
+	p += (filefh3_length / 4);
+
+	len = (uint32_t *)p - (uint32_t *)&(data[0]);
+
+	rpc_req(PROG_NFS, NFS3PROC_FSINFO, data, len);
+}
+
+/*
+ * Largest READ size whose reply still fits in a datagram we can receive,
+ * including the RPC header and the NFSv3 attributes.
+ */
+static int nfs_read_size_max(void)
+{
+#ifdef CONFIG_IP_DEFRAG
+	int size = NFS_READ_SIZE_MAX;
+
+	while (size > NFS_READ_SIZE &&
+	       size + IP_UDP_HDR_SIZE + sizeof(struct rpc_t) - NFS_READ_SIZE >
+	       CONFIG_NET_MAXDEFRAG)
+		size >>= 1;
+
+	return size;
+#else
+	return NFS_READ_SIZE;
+#endif
+}
+
+/* Send READ requests for all free slots, up to the end of the file */
+static void nfs_read_fill(void)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		slot = &nfs_read_slots[i];
+		if (slot->id || nfs_offset >= nfs_read_eof)
+			continue;
+
+		slot->offset = nfs_offset;
+		slot->len = nfs_len;
+		nfs_read_req(slot->offset, slot->len);
+		slot->id = rpc_id;
+		nfs_offset += nfs_len;
+	}
+}
+
+/* Send the outstanding READ requests again, with new XIDs */
+static void nfs_read_resend(void)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		slot = &nfs_read_slots[i];
+		if (!slot->id)
+			continue;
+
+		nfs_read_req(slot->offset, slot->len);
+		slot->id = rpc_id;
+	}
+}
+
+/* Check whether any READ request is still waiting for its reply */
+static bool nfs_read_pending(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		if (nfs_read_slots[i].id)
+			return true;
+	}
+
+	return false;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -455,7 +565,11 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
+		nfs_read_fill();
+		break;
+	case STATE_FSINFO_REQ:
+		nfs_fsinfo_req();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -704,21 +818,78 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
-static int nfs_read_reply(uchar *pkt, unsigned len)
+static int nfs_fsinfo_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
-	uchar *data_ptr;
+	int nfsv3_data_offset;
+	int size;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	memcpy(&rpc_pkt.u.data[0], pkt, len);
 
 	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
 		return -NFS_RPC_ERR;
 	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
 		return -NFS_RPC_DROP;
 
+	if (rpc_handle_error(&rpc_pkt))
+		return -NFS_RPC_ERR;
+
+	nfs_len = NFS_READ_SIZE;
+	nfsv3_data_offset = nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
+	if (((uchar *)&rpc_pkt.u.reply.data[3 + nfsv3_data_offset] -
+	     (uchar *)&rpc_pkt) > len)
+		return -NFS_RPC_ERR;
+
+	/* rtpref follows rtmax; use the largest power of two not above it */
+	size = ntohl(rpc_pkt.u.reply.data[2 + nfsv3_data_offset]);
+	while (nfs_len * 2 <= size && nfs_len * 2 <= nfs_read_size_max())
+		nfs_len *= 2;
+	debug("NFS READ size %d (server prefers %d)\n", nfs_len, size);
+
+	return 0;
+}
+
+static void nfs_show_progress(int rlen)
+{
+	const int step = (NFS_READ_SIZE / 2) * 10;
+	unsigned int hashes = nfs_received / step;
+
+	nfs_received += rlen;
+	while (hashes < nfs_received / step) {
+		if (hashes && !(hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		hashes++;
+	}
+}
+
+static int nfs_read_reply(uchar *pkt, unsigned len)
+{
+	struct rpc_t rpc_pkt;
+	struct nfs_read_slot *slot = NULL;
+	unsigned long id;
+	int rlen, eof;
+	int data_pos;
+	int i;
+
+	debug("%s\n", __func__);
+
+	/* Only the header is copied; data is stored straight from the packet */
+	memcpy(&rpc_pkt.u.data[0], pkt,
+	       min_t(unsigned int, len, sizeof(rpc_pkt.u.reply)));
+
+	id = ntohl(rpc_pkt.u.reply.id);
+	if (id > rpc_id)
+		return -NFS_RPC_ERR;
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		if (id && nfs_read_slots[i].id == id)
+			slot = &nfs_read_slots[i];
+	}
+	if (!slot)
+		return -NFS_RPC_DROP;
+
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
 	    rpc_pkt.u.reply.astatus  ||
@@ -730,38 +901,61 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
 	if (choosen_nfs_version != NFS_V3) {
 		rlen = ntohl(rpc_pkt.u.reply.data[18]);
-		data_ptr = (uchar *)&(rpc_pkt.u.reply.data[19]);
+		/* NFSv2 has no EOF flag, a zero-length READ marks the end */
+		eof = !rlen;
+		data_pos = 19;
 	} else {  /* NFS_V3 */
 		int nfsv3_data_offset =
 			nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
 
 		/* count value */
 		rlen = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+		eof = rpc_pkt.u.reply.data[2 + nfsv3_data_offset] || !rlen;
 		/* Skip unused values :
 			EOF:		32 bits value,
 			data_size:	32 bits value,
 		*/
-		data_ptr = (uchar *)
-			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
+		data_pos = 4 + nfsv3_data_offset;
 	}
+	data_pos = (uchar *)&rpc_pkt.u.reply.data[data_pos] - (uchar *)&rpc_pkt;
 
-	if (((uchar *)&(rpc_pkt.u.reply.data[0]) - (uchar *)(&rpc_pkt) + rlen) > len)
+	if (rlen > slot->len || data_pos + rlen > len)
 			return -9999;
 
-	if (store_block(data_ptr, nfs_offset, rlen))
+	if (store_block(pkt + data_pos, slot->offset, rlen))
 			return -9999;
 
+	nfs_show_progress(rlen);
+
+	if (eof) {
+		nfs_read_eof = min(nfs_read_eof, slot->offset + rlen);
+		slot->id = 0;
+	} else if (rlen < slot->len) {
+		/* Short read: ask again for the rest of this block */
+		slot->offset += rlen;
+		slot->len -= rlen;
+		nfs_read_req(slot->offset, slot->len);
+		slot->id = rpc_id;
+	} else {
+		slot->id = 0;
+	}
+
 	return rlen;
 }
 
+/* Start reading the file, with an empty window of READ requests */
+static void nfs_read_start(void)
+{
+	memset(nfs_read_slots, 0, sizeof(nfs_read_slots));
+	nfs_offset = 0;
+	nfs_read_eof = UINT_MAX;
+	nfs_received = 0;
+	nfs_state = STATE_READ_REQ;
+	nfs_send();
+}
+
 /**************************************************************************
 Interfaces of U-BOOT
 **************************************************************************/
@@ -787,7 +981,10 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 	debug("%s\n", __func__);
 
-	if (len > sizeof(struct rpc_t))
+	/* Only READ replies may carry more than NFS_READ_SIZE bytes of data */
+	if (len > sizeof(struct rpc_t) &&
+	    (nfs_state != STATE_READ_REQ ||
+	     len > sizeof(struct rpc_t) + nfs_len - NFS_READ_SIZE))
 		return;
 
 	if (dest != nfs_our_port)
@@ -857,13 +1054,25 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
 			nfs_send();
 		} else {
-			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
 			nfs_len = NFS_READ_SIZE;
-			nfs_send();
+			if (choosen_nfs_version == NFS_V3 &&
+			    nfs_read_size_max() > NFS_READ_SIZE) {
+				nfs_state = STATE_FSINFO_REQ;
+				nfs_send();
+			} else {
+				nfs_read_start();
+			}
 		}
 		break;
 
+	case STATE_FSINFO_REQ:
+		reply = nfs_fsinfo_reply(pkt, len);
+		if (reply == -NFS_RPC_DROP)
+			break;
+		/* Without FSINFO, fall back to the default READ size */
+		nfs_read_start();
+		break;
+
 	case STATE_READLINK_REQ:
 		reply = nfs_readlink_reply(pkt, len);
 		if (reply == -NFS_RPC_DROP) {
@@ -887,18 +1096,20 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		if (rlen == -NFS_RPC_DROP)
 			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen >= 0) {
+			if (nfs_read_pending() || nfs_offset < nfs_read_eof) {
+				nfs_read_fill();
+				break;
+			}
+			nfs_download_state = NETLOOP_SUCCESS;
+			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
-			if (rlen < 0)
-				debug("NFS READ error (%d)\n", rlen);
+			debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Reference-counted pool of network packet buffers
+ *
+ * The pool holds the transmit packet and the receive packets of the network
+ * stack, plus CONFIG_NET_PKTBUF_EXTRA spare buffers which drivers and
+ * protocols may allocate. Every buffer starts on a PKTALIGN boundary with
+ * the packet data placed after CONFIG_NET_PKTBUF_HEADROOM bytes, rounded up
+ * so that the data stays aligned for DMA.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <net.h>
+#include <net/pktbuf.h>
+#include <linux/kernel.h>
+
+#define PKTBUF_COUNT	(PKTBUFSRX + 1 + CONFIG_NET_PKTBUF_EXTRA)
+#define PKTBUF_HEADROOM	ALIGN(CONFIG_NET_PKTBUF_HEADROOM, PKTALIGN)
+#define PKTBUF_STRIDE	(PKTBUF_HEADROOM + PKTSIZE_ALIGN)
+
+static uchar pktbuf_mem[PKTBUF_COUNT * PKTBUF_STRIDE + PKTALIGN];
+static int pktbuf_refcnt[PKTBUF_COUNT];
+static struct pktbuf_stats pktbuf_stats;
+
+static uchar *pktbuf_base(void)
+{
+	return PTR_ALIGN(&pktbuf_mem[0], PKTALIGN);
+}
+
+/* Get the index of the buffer containing @pkt, or -1 if not in the pool */
+static int pktbuf_index(const uchar *pkt)
+{
+	const uchar *base = pktbuf_base();
+
+	if (pkt < base || pkt >= base + PKTBUF_COUNT * PKTBUF_STRIDE)
+		return -1;
+
+	return (pkt - base) / PKTBUF_STRIDE;
+}
+
+uchar *pktbuf_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < PKTBUF_COUNT; i++) {
+		if (pktbuf_refcnt[i])
+			continue;
+
+		pktbuf_refcnt[i] = 1;
+		pktbuf_stats.allocs++;
+		if (++pktbuf_stats.in_use > pktbuf_stats.peak)
+			pktbuf_stats.peak = pktbuf_stats.in_use;
+
+		return pktbuf_base() + i * PKTBUF_STRIDE + PKTBUF_HEADROOM;
+	}
+	pktbuf_stats.fails++;
+	log_debug("Packet buffer pool empty\n");
+
+	return NULL;
+}
+
+void pktbuf_get(uchar *pkt)
+{
+	int i = pktbuf_index(pkt);
+
+	if (i < 0 || !pktbuf_refcnt[i]) {
+		log_err("Reference to non-pool packet %p\n", pkt);
+		return;
+	}
+	pktbuf_refcnt[i]++;
+}
+
+void pktbuf_put(uchar *pkt)
+{
+	int i = pktbuf_index(pkt);
+
+	if (i < 0 || !pktbuf_refcnt[i]) {
+		log_err("Release of non-pool packet %p\n", pkt);
+		return;
+	}
+	if (!--pktbuf_refcnt[i])
+		pktbuf_stats.in_use--;
+}
+
+bool pktbuf_is_pooled(const uchar *pkt)
+{
+	int i = pktbuf_index(pkt);
+
+	return i >= 0 && pktbuf_refcnt[i];
+}
+
+bool pktbuf_is_shared(const uchar *pkt)
+{
+	int i = pktbuf_index(pkt);
+
+	return i >= 0 && pktbuf_refcnt[i] > 1;
+}
+
+int pktbuf_headroom(const uchar *pkt)
+{
+	int i = pktbuf_index(pkt);
+
+	if (i < 0)
+		return 0;
+
+	return pkt - (pktbuf_base() + i * PKTBUF_STRIDE);
+}
+
+uchar *pktbuf_push(uchar *pkt, int len)
+{
+	if (len > pktbuf_headroom(pkt))
+		return NULL;
+
+	return pkt - len;
+}
+
+void pktbuf_get_stats(struct pktbuf_stats *stats)
+{
+	*stats = pktbuf_stats;
+	stats->total = PKTBUF_COUNT;
+	stats->headroom = PKTBUF_HEADROOM;
+	stats->size = PKTSIZE_ALIGN;
+}
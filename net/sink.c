@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Streaming of network downloads to a consumer
+ *
+ * Downloads are staged in a buffer of CONFIG_NET_SINK_BUF_SIZE bytes, used
+ * as two halves. Packets may arrive out of order within the buffer; once the
+ * data received without gaps covers a half, it is passed to the sink and the
+ * half is reused for later data. This lets images larger than the free
+ * memory be written straight to their destination.
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <gzip.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <spi_flash.h>
+#include <net/sink.h>
+#include <linux/kernel.h>
+
+/* Number of gaps in the received data which can be tracked */
+#define NET_SINK_EXTENTS	16
+
+/**
+ * struct net_sink_extent - data received after a gap
+ *
+ * @start:	offset of the first byte
+ * @end:	offset after the last byte
+ */
+struct net_sink_extent {
+	ulong start;
+	ulong end;
+};
+
+static struct net_sink *net_sink;
+static uchar *net_sink_buf;
+static ulong net_sink_chunk;
+static ulong net_sink_flushed;
+static ulong net_sink_contig;
+static bool net_sink_used;
+static int net_sink_err;
+static struct net_sink_extent net_sink_ext[NET_SINK_EXTENTS];
+static int net_sink_next;
+
+int net_sink_set(struct net_sink *sink)
+{
+	ulong chunk = CONFIG_NET_SINK_BUF_SIZE / 2;
+
+	net_sink_clear();
+
+	if (sink->align > 1)
+		chunk = rounddown(chunk, sink->align);
+	if (!chunk) {
+		log_err("%s: write size %lx exceeds staging buffer\n",
+			sink->name, sink->align);
+		return -EINVAL;
+	}
+	net_sink_buf = malloc_cache_aligned(chunk * 2);
+	if (!net_sink_buf)
+		return -ENOMEM;
+
+	net_sink = sink;
+	net_sink_chunk = chunk;
+	net_sink_flushed = 0;
+	net_sink_contig = 0;
+	net_sink_used = false;
+	net_sink_err = 0;
+	net_sink_next = 0;
+
+	return 0;
+}
+
+static void net_sink_release(void)
+{
+	free(net_sink_buf);
+	net_sink_buf = NULL;
+	net_sink = NULL;
+}
+
+void net_sink_clear(void)
+{
+	if (net_sink && net_sink->abort)
+		net_sink->abort(net_sink);
+	net_sink_release();
+}
+
+bool net_sink_active(void)
+{
+	return net_sink;
+}
+
+/* Record that @start to @end was received and advance net_sink_contig */
+static int net_sink_add_extent(ulong start, ulong end)
+{
+	int i, j;
+
+	if (start <= net_sink_contig) {
+		net_sink_contig = max(net_sink_contig, end);
+	} else {
+		for (i = 0; i < net_sink_next; i++) {
+			if (start <= net_sink_ext[i].end)
+				break;
+		}
+		if (i < net_sink_next && end >= net_sink_ext[i].start) {
+			net_sink_ext[i].start = min(net_sink_ext[i].start,
+						    start);
+			net_sink_ext[i].end = max(net_sink_ext[i].end, end);
+		} else {
+			if (net_sink_next == NET_SINK_EXTENTS)
+				return -ENOSPC;
+			memmove(&net_sink_ext[i + 1], &net_sink_ext[i],
+				(net_sink_next - i) * sizeof(*net_sink_ext));
+			net_sink_ext[i].start = start;
+			net_sink_ext[i].end = end;
+			net_sink_next++;
+		}
+		/* merge with the following extents */
+		for (j = i + 1; j < net_sink_next &&
+		     net_sink_ext[j].start <= net_sink_ext[i].end; j++)
+			net_sink_ext[i].end = max(net_sink_ext[i].end,
+						  net_sink_ext[j].end);
+		memmove(&net_sink_ext[i + 1], &net_sink_ext[j],
+			(net_sink_next - j) * sizeof(*net_sink_ext));
+		net_sink_next -= j - i - 1;
+	}
+
+	/* consume the extents which now continue the contiguous data */
+	for (i = 0; i < net_sink_next &&
+	     net_sink_ext[i].start <= net_sink_contig; i++)
+		net_sink_contig = max(net_sink_contig, net_sink_ext[i].end);
+	memmove(&net_sink_ext[0], &net_sink_ext[i],
+		(net_sink_next - i) * sizeof(*net_sink_ext));
+	net_sink_next -= i;
+
+	return 0;
+}
+
+/* Pass @len bytes at net_sink_flushed to the sink */
+static int net_sink_write(ulong len)
+{
+	uchar *buf = net_sink_buf + net_sink_flushed % (net_sink_chunk * 2);
+	int ret;
+
+	ret = net_sink->write(net_sink, net_sink_flushed, buf, len);
+	if (ret) {
+		log_err("\n%s: write at %lx failed (err=%d)\n", net_sink->name,
+			net_sink_flushed, ret);
+		return ret;
+	}
+	net_sink_flushed += len;
+
+	return 0;
+}
+
+int net_sink_store(ulong offset, const void *src, ulong len)
+{
+	ulong size = net_sink_chunk * 2;
+	ulong end = offset + len;
+	ulong pos, copy;
+	int ret;
+
+	if (!net_sink)
+		return -ENODEV;
+	if (net_sink_err)
+		return net_sink_err;
+	net_sink_used = true;
+
+	/* already written, e.g. when the transfer restarted */
+	if (end <= net_sink_flushed)
+		return 0;
+	if (offset < net_sink_flushed) {
+		src += net_sink_flushed - offset;
+		offset = net_sink_flushed;
+	}
+	if (end > net_sink_flushed + size) {
+		log_err("\n%s: data at %lx beyond staging buffer\n",
+			net_sink->name, offset);
+		net_sink_err = -E2BIG;
+		return net_sink_err;
+	}
+
+	for (pos = offset; pos < end; pos += copy, src += copy) {
+		copy = min(end - pos, size - pos % size);
+		memcpy(net_sink_buf + pos % size, src, copy);
+	}
+
+	ret = net_sink_add_extent(offset, end);
+	if (ret) {
+		log_err("\n%s: too much out-of-order data\n", net_sink->name);
+		net_sink_err = ret;
+		return ret;
+	}
+
+	while (net_sink_contig - net_sink_flushed >= net_sink_chunk) {
+		ret = net_sink_write(net_sink_chunk);
+		if (ret) {
+			net_sink_err = ret;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int net_sink_end(bool download, int ret, ulong size)
+{
+	struct net_sink *sink = net_sink;
+	int err;
+
+	if (!sink || (!download && !net_sink_used))
+		return ret;
+
+	if (!ret && (net_sink_err || net_sink_next ||
+		     net_sink_contig != size)) {
+		log_err("%s: incomplete data, %lx of %lx bytes\n", sink->name,
+			net_sink_contig, size);
+		ret = -EIO;
+	}
+	if (!ret) {
+		err = 0;
+		if (net_sink_contig > net_sink_flushed)
+			err = net_sink_write(net_sink_contig - net_sink_flushed);
+		if (!err && sink->finish)
+			err = sink->finish(sink, net_sink_contig);
+		if (!err) {
+			net_sink_release();
+			return ret;
+		}
+		ret = -EIO;
+	}
+	net_sink_clear();
+
+	return ret;
+}
+
+#if IS_ENABLED(CONFIG_BLK)
+static struct blk_desc *net_sink_blk_desc;
+static lbaint_t net_sink_blk_start;
+
+static int net_sink_blk_write(struct net_sink *sink, u64 offset, void *buf,
+			      ulong len)
+{
+	struct blk_desc *desc = net_sink_blk_desc;
+	lbaint_t blk = net_sink_blk_start + lldiv(offset, desc->blksz);
+	lbaint_t cnt = DIV_ROUND_UP(len, desc->blksz);
+
+	if (blk + cnt > desc->lba)
+		return -ENOSPC;
+	/* pad the last block */
+	if (len % desc->blksz)
+		memset(buf + len, '\0', desc->blksz - len % desc->blksz);
+	if (blk_dwrite(desc, blk, cnt, buf) != cnt)
+		return -EIO;
+
+	return 0;
+}
+
+static struct net_sink net_sink_blk_ops = {
+	.name	= "blk",
+	.write	= net_sink_blk_write,
+};
+
+int net_sink_blk(struct blk_desc *desc, u64 start)
+{
+	if (start & (desc->blksz - 1))
+		return -EINVAL;
+	net_sink_blk_desc = desc;
+	net_sink_blk_start = lldiv(start, desc->blksz);
+	net_sink_blk_ops.align = desc->blksz;
+
+	return net_sink_set(&net_sink_blk_ops);
+}
+#endif
+
+#if IS_ENABLED(CONFIG_BLK) && IS_ENABLED(CONFIG_CMD_UNZIP)
+static struct gzwrite_stream *net_sink_gz;
+
+static int net_sink_gz_write(struct net_sink *sink, u64 offset, void *buf,
+			     ulong len)
+{
+	return gzwrite_stream_feed(net_sink_gz, buf, len) ? -EIO : 0;
+}
+
+static int net_sink_gz_finish(struct net_sink *sink, u64 size)
+{
+	int ret = gzwrite_stream_finish(net_sink_gz);
+
+	net_sink_gz = NULL;
+
+	return ret ? -EIO : 0;
+}
+
+static void net_sink_gz_abort(struct net_sink *sink)
+{
+	if (net_sink_gz)
+		gzwrite_stream_free(net_sink_gz);
+	net_sink_gz = NULL;
+}
+
+static struct net_sink net_sink_gz_ops = {
+	.name	= "gzwrite",
+	.write	= net_sink_gz_write,
+	.finish	= net_sink_gz_finish,
+	.abort	= net_sink_gz_abort,
+};
+
+int net_sink_gzwrite(struct blk_desc *desc, u64 start)
+{
+	int ret;
+
+	net_sink_clear();
+	net_sink_gz = gzwrite_stream_start(desc, 1 << 20, start, 0, 0);
+	if (!net_sink_gz)
+		return -EINVAL;
+
+	ret = net_sink_set(&net_sink_gz_ops);
+	if (ret) {
+		gzwrite_stream_free(net_sink_gz);
+		net_sink_gz = NULL;
+	}
+
+	return ret;
+}
+#endif
+
+#if IS_ENABLED(CONFIG_SPI_FLASH)
+static struct spi_flash *net_sink_flash;
+static u32 net_sink_sf_start;
+
+static int net_sink_sf_write(struct net_sink *sink, u64 offset, void *buf,
+			     ulong len)
+{
+	struct spi_flash *flash = net_sink_flash;
+	u32 addr = net_sink_sf_start + offset;
+	int ret;
+
+	if (addr + len > flash->size)
+		return -ENOSPC;
+	ret = spi_flash_erase(flash, addr, roundup(len, flash->erase_size));
+	if (!ret)
+		ret = spi_flash_write(flash, addr, len, buf);
+
+	return ret;
+}
+
+static struct net_sink net_sink_sf_ops = {
+	.name	= "sf",
+	.write	= net_sink_sf_write,
+};
+
+int net_sink_sf(struct spi_flash *flash, u32 start)
+{
+	if (start % flash->erase_size)
+		return -EINVAL;
+	net_sink_flash = flash;
+	net_sink_sf_start = start;
+	net_sink_sf_ops.align = flash->erase_size;
+
+	return net_sink_set(&net_sink_sf_ops);
+}
+#endif
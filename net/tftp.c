@@ -17,6 +17,7 @@
 #include <net.h>
 #include <net6.h>
 #include <asm/global_data.h>
+#include <net/sink.h>
 #include <net/tftp.h>
 #include "bootp.h"
 
@@ -167,16 +168,22 @@ static inline int store_block(int block, uchar *src, unsigned int len)
 	if (!end_addr)
 		end_addr = ULONG_MAX;
 
-	if (store_addr < tftp_load_addr ||
-	    store_addr + len > end_addr) {
+	if (!net_sink_active() &&
+	    (store_addr < tftp_load_addr || store_addr + len > end_addr)) {
 		puts("\nTFTP error: ");
 		puts("trying to overwrite reserved memory...\n");
 		return -1;
 	}
 #endif
-	ptr = map_sysmem(store_addr, len);
-	memcpy(ptr, src, len);
-	unmap_sysmem(ptr);
+	if (net_sink_active()) {
+		if (net_sink_store(offset, src, len))
+			return -1;
+	} else {
+		ptr = map_sysmem(store_addr, len);
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
+		fit_load_hash_update(store_addr, len);
+	}
 
 	if (net_boot_file_size < newsize)
 		net_boot_file_size = newsize;
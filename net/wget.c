@@ -13,6 +13,7 @@
 #include <lmb.h>
 #include <mapmem.h>
 #include <net.h>
+#include <net/sink.h>
 #include <net/tcp.h>
 #include <net/wget.h>
 #include <stdlib.h>
@@ -22,11 +23,14 @@ DECLARE_GLOBAL_DATA_PTR;
 /* The default, change with environment variable 'httpdstp' */
 #define SERVER_PORT		80
 
+#define HTTP_OK			200
+#define HTTP_PARTIAL_CONTENT	206
+
 static const char bootfile1[] = "GET ";
-static const char bootfile3[] = " HTTP/1.0\r\n\r\n";
+static const char bootfile3[] = " HTTP/1.0\r\n";
 static const char http_eom[] = "\r\n\r\n";
-static const char http_ok[] = "200";
 static const char content_len[] = "Content-Length";
+static const char content_range[] = "Content-Range: bytes ";
 static const char linefeed[] = "\r\n";
 static struct in_addr web_server_ip;
 static int our_port;
@@ -66,6 +70,21 @@ static int retry_len;			/* TCP retry length */
 
 static ulong wget_load_size;
 
+/*
+ * Byte range control. All offsets are positions within the remote object.
+ * The byte at @wget_origin lands at image_load_addr. A request asks for
+ * @wget_req_start..@wget_range_end (inclusive, 0 for end of object) and the
+ * body of the current response starts at @wget_data_start. @wget_contig is
+ * the end of the data received without holes, used to resume the transfer
+ * on a new connection when the current one stalls.
+ */
+static ulong wget_origin;
+static ulong wget_range_end;
+static ulong wget_req_start;
+static ulong wget_data_start;
+static ulong wget_contig;
+static int wget_resume_count;
+
 /**
  * wget_init_max_size() - initialize maximum load size
  *
@@ -90,16 +109,32 @@ static int wget_init_load_size(void)
 /**
  * store_block() - store block in memory
  * @src: source of data
- * @offset: offset
+ * @offset: offset within the body of the current response
  * @len: length
  */
 static inline int store_block(uchar *src, unsigned int offset, unsigned int len)
 {
-	ulong store_addr = image_load_addr + offset;
-	ulong newsize = offset + len;
+	ulong pos = wget_data_start + offset;
+	ulong store_addr;
+	ulong newsize;
 	uchar *ptr;
 
-	if (IS_ENABLED(CONFIG_LMB)) {
+	/* Drop anything outside the range, e.g. on a server ignoring Range */
+	if (pos + len <= wget_origin ||
+	    (wget_range_end && pos > wget_range_end))
+		return 0;
+	if (pos < wget_origin) {
+		src += wget_origin - pos;
+		len -= wget_origin - pos;
+		pos = wget_origin;
+	}
+	if (wget_range_end && pos + len > wget_range_end + 1)
+		len = wget_range_end + 1 - pos;
+
+	store_addr = image_load_addr + (pos - wget_origin);
+	newsize = pos - wget_origin + len;
+
+	if (IS_ENABLED(CONFIG_LMB) && !net_sink_active()) {
 		ulong end_addr = image_load_addr + wget_load_size;
 
 		if (!end_addr)
@@ -113,11 +148,20 @@ static inline int store_block(uchar *src, unsigned int offset, unsigned int len)
 		}
 	}
 
-	ptr = map_sysmem(store_addr, len);
-	memcpy(ptr, src, len);
-	unmap_sysmem(ptr);
+	if (net_sink_active()) {
+		if (net_sink_store(pos - wget_origin, src, len))
+			return -1;
+	} else {
+		ptr = map_sysmem(store_addr, len);
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
+		fit_load_hash_update(store_addr, len);
+	}
 
-	if (net_boot_file_size < (offset + len))
+	if (pos <= wget_contig && pos + len > wget_contig)
+		wget_contig = pos + len;
+
+	if (net_boot_file_size < newsize)
 		net_boot_file_size = newsize;
 
 	return 0;
@@ -167,6 +211,19 @@ static void wget_send_stored(void)
 
 		memcpy(offset, &bootfile3, strlen(bootfile3));
 		offset += strlen(bootfile3);
+
+		if (wget_req_start || wget_range_end) {
+			offset += sprintf((char *)offset, "Range: bytes=%lu-",
+					  wget_req_start);
+			if (wget_range_end)
+				offset += sprintf((char *)offset, "%lu",
+						  wget_range_end);
+			memcpy(offset, linefeed, strlen(linefeed));
+			offset += strlen(linefeed);
+		}
+
+		memcpy(offset, linefeed, strlen(linefeed));
+		offset += strlen(linefeed);
 		net_send_tcp_packet((offset - ptr), server_port, our_port,
 				    TCP_PUSH, tcp_seq_num, tcp_ack_num);
 		current_wget_state = WGET_CONNECTED;
@@ -206,12 +263,52 @@ void wget_success(u8 action, unsigned int tcp_seq_num,
 	wget_send(action, tcp_seq_num, tcp_ack_num, len);
 }
 
+#define RANDOM_PORT_START 1024
+#define RANDOM_PORT_RANGE 0x4000
+
+/**
+ * random_port() - make port a little random (1024-17407)
+ *
+ * Return: random port number from 1024 to 17407
+ *
+ * This keeps the math somewhat trivial to compute, and seems to work with
+ * all supported protocols/clients/servers
+ */
+static unsigned int random_port(void)
+{
+	return RANDOM_PORT_START + (get_timer(0) % RANDOM_PORT_RANGE);
+}
+
+/**
+ * wget_resume() - restart a stalled transfer on a new connection
+ *
+ * The current connection is reset and the object is requested again,
+ * starting from the first byte not yet received.
+ */
+static void wget_resume(void)
+{
+	wget_resume_count++;
+	wget_req_start = wget_contig;
+	printf("\nResuming at offset 0x%lx\n", wget_req_start - wget_origin);
+
+	wget_send(TCP_RST, 0, 0, 0);
+	wget_timeout_count = 0;
+	current_wget_state = WGET_CLOSED;
+	our_port = random_port();
+	wget_send(TCP_SYN, 0, 0, 0);
+}
+
 /*
  * Interfaces of U-BOOT
  */
 static void wget_timeout_handler(void)
 {
-	if (++wget_timeout_count > WGET_RETRY_COUNT) {
+	if (wget_timeout_count >= WGET_RETRY_COUNT &&
+	    current_wget_state == WGET_TRANSFERRING &&
+	    wget_resume_count < WGET_RESUME_COUNT) {
+		wget_resume();
+		net_set_timeout_handler(wget_timeout, wget_timeout_handler);
+	} else if (++wget_timeout_count > WGET_RETRY_COUNT) {
 		puts("\nRetry count exceeded; starting again\n");
 		wget_send(TCP_RST, 0, 0, 0);
 		net_start_again();
@@ -224,6 +321,22 @@ static void wget_timeout_handler(void)
 	}
 }
 
+/**
+ * wget_http_status() - get the status code of an HTTP response
+ * @pkt: response header, NUL-terminated
+ *
+ * Return: status code, or 0 if the status line cannot be parsed
+ */
+static int wget_http_status(const char *pkt)
+{
+	const char *pos = strchr(pkt, ' ');
+
+	if (!pos)
+		return 0;
+
+	return simple_strtoul(pos + 1, NULL, 10);
+}
+
 #define PKT_QUEUE_OFFSET 0x20000
 #define PKT_QUEUE_PACKET_SIZE 0x800
 
@@ -233,6 +346,7 @@ static void wget_connected(uchar *pkt, unsigned int tcp_seq_num,
 	uchar *pkt_in_q;
 	char *pos;
 	int hlen, i;
+	int status;
 	uchar *ptr1;
 
 	pkt[len] = '\0';
@@ -272,7 +386,8 @@ static void wget_connected(uchar *pkt, unsigned int tcp_seq_num,
 
 		current_wget_state = WGET_TRANSFERRING;
 
-		if (strstr((char *)pkt, http_ok) == 0) {
+		status = wget_http_status((char *)pkt);
+		if (status != HTTP_OK && status != HTTP_PARTIAL_CONTENT) {
 			debug_cond(DEBUG_WGET,
 				   "wget: Connected Bad Xfer\n");
 			initial_data_seq_num = tcp_seq_num + hlen;
@@ -295,6 +410,20 @@ static void wget_connected(uchar *pkt, unsigned int tcp_seq_num,
 					   content_length);
 			}
 
+			if (status == HTTP_PARTIAL_CONTENT) {
+				pos = strstr((char *)pkt, content_range);
+				if (pos)
+					wget_data_start = simple_strtoul(pos + strlen(content_range),
+									 NULL, 10);
+				else
+					wget_data_start = wget_req_start;
+			} else {
+				/* The whole object is sent if Range is unsupported */
+				wget_data_start = 0;
+			}
+			debug_cond(DEBUG_WGET, "wget: Connected Start %lu\n",
+				   wget_data_start);
+
 			net_boot_file_size = 0;
 
 			if (len > hlen) {
@@ -435,20 +564,10 @@ static void wget_handler(uchar *pkt, u16 dport,
 	}
 }
 
-#define RANDOM_PORT_START 1024
-#define RANDOM_PORT_RANGE 0x4000
-
-/**
- * random_port() - make port a little random (1024-17407)
- *
- * Return: random port number from 1024 to 17407
- *
- * This keeps the math somewhat trivial to compute, and seems to work with
- * all supported protocols/clients/servers
- */
-static unsigned int random_port(void)
+void wget_set_range(ulong start, ulong end)
 {
-	return RANDOM_PORT_START + (get_timer(0) % RANDOM_PORT_RANGE);
+	wget_origin = start;
+	wget_range_end = end;
 }
 
 #define BLOCKSIZE 512
@@ -507,6 +626,10 @@ void wget_start(void)
 	wget_timeout_count = 0;
 	current_wget_state = WGET_CLOSED;
 
+	wget_req_start = wget_origin;
+	wget_contig = wget_origin;
+	wget_resume_count = 0;
+
 	our_port = random_port();
 
 	/*
@@ -564,6 +687,7 @@ int wget_with_dns(ulong dst_addr, char *uri)
 	strlcat(net_boot_file_name, ":/", sizeof(net_boot_file_name)); /* append '/' which is removed by strsep() */
 	strlcat(net_boot_file_name, file_name, sizeof(net_boot_file_name));
 	image_load_addr = dst_addr;
+	wget_set_range(0, 0);
 	ret = net_loop(WGET);
 
 out:
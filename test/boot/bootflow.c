@@ -1159,3 +1159,80 @@ static int bootflow_cros(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(bootflow_cros, 0);
+
+/* Check preparing to boot in the background */
+static int bootflow_prep(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+	struct bootflow *bflow;
+
+	if (!IS_ENABLED(CONFIG_BOOTSTD_PREP))
+		return -EAGAIN;
+	ut_assertok(bootstd_get_priv(&std));
+
+	ut_assertok(bootflow_prep_start());
+	ut_asserteq(-EALREADY, bootflow_prep_start());
+	ut_asserteq(1, bootflow_prep_finish(false));
+	ut_asserteq(-ENOENT, bootflow_prep_finish(false));
+	ut_assert(std->hunters_used & BIT(MMC_HUNTER));
+
+	ut_assertok(bootflow_first_glob(&bflow));
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow->name);
+	ut_asserteq(BOOTFLOWST_READY, bflow->state);
+	ut_asserteq_ptr(bflow, std->cur_bootflow);
+
+	/* the boot command can take it once, without scanning again */
+	ut_asserteq_ptr(bflow, bootflow_prep_take());
+	ut_assertnull(bootflow_prep_take());
+	ut_asserteq(-ENOENT, bootflow_next_glob(&bflow));
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_prep, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
+/* Check that preparing with a network label in the ordering runs no DHCP */
+static int check_prep_skip_net(struct unit_test_state *uts,
+			       struct bootstd_priv *std)
+{
+	struct bootdev_hunter *start, *info;
+	int n_ent, i;
+
+	ut_assertok(bootflow_prep_start());
+	ut_asserteq(1, bootflow_prep_finish(false));
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0, info = start; i < n_ent; i++, info++) {
+		if (info->uclass == UCLASS_ETH)
+			ut_assert(!(std->hunters_used & BIT(i)));
+	}
+
+	return 0;
+}
+
+/* Check that preparing to boot can be cancelled and leaves out the network */
+static int bootflow_prep_cancel(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+	struct bootflow *bflow;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_BOOTSTD_PREP))
+		return -EAGAIN;
+	ut_assertok(bootstd_get_priv(&std));
+
+	/* cancelling before the first step drops everything */
+	ut_assertok(bootflow_prep_start());
+	ut_asserteq(-ECANCELED, bootflow_prep_finish(true));
+	ut_asserteq(-ENOENT, bootflow_first_glob(&bflow));
+	ut_assertnull(bootflow_prep_take());
+	ut_asserteq(0, std->hunters_used);
+
+	/* restore the ordering even if the check fails */
+	ut_assertok(env_set("boot_targets", "dhcp mmc1"));
+	ret = check_prep_skip_net(uts, std);
+	env_set("boot_targets", NULL);
+
+	return ret;
+}
+BOOTSTD_TEST(bootflow_prep_cancel, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
@@ -7,9 +7,12 @@
  */
 
 #include <common.h>
+#include <bootflow.h>
 #include <bootmeth.h>
 #include <bootstd.h>
 #include <dm.h>
+#include <dm/device-internal.h>
+#include <dm/uclass-internal.h>
 #include <test/suites.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
@@ -172,3 +175,28 @@ static int bootmeth_state(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(bootmeth_state, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
+/* Check that the devices listed in "u-boot,needs" are probed before booting */
+static int bootmeth_needs(struct unit_test_state *uts)
+{
+	struct udevice *bootstd, *dev, *led;
+	struct bootflow bflow;
+
+	ut_assertok(uclass_first_device_err(UCLASS_BOOTSTD, &bootstd));
+	ut_assertok(device_bind(bootstd, DM_DRIVER_GET(bootmeth_sandbox),
+				"sandbox-needs", NULL,
+				ofnode_path("/bootstd/sandbox-needs"), &dev));
+
+	ut_assertok(uclass_find_device_by_name(UCLASS_LED, "default_off", &led));
+	ut_assert(!device_active(led));
+
+	/* the sandbox bootmeth always fails to boot, but only after probing */
+	memset(&bflow, '\0', sizeof(bflow));
+	ut_asserteq(-ENOTSUPP, bootmeth_boot(dev, &bflow));
+	ut_assert(device_active(led));
+
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+BOOTSTD_TEST(bootmeth_needs, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
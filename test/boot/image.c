@@ -8,6 +8,8 @@
 
 #include <common.h>
 #include <image.h>
+#include <mapmem.h>
+#include <linux/libfdt.h>
 #include <test/suites.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
@@ -34,3 +36,287 @@ static int test_image_phase(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(test_image_phase, 0);
+
+/* Write a FIT with one image with external data of @size bytes to @buf */
+static int make_fit_ext(struct unit_test_state *uts, void *buf, int buf_size,
+			int size)
+{
+	ut_assertok(fdt_create(buf, buf_size));
+	ut_assertok(fdt_finish_reservemap(buf));
+	ut_assertok(fdt_begin_node(buf, ""));
+	ut_assertok(fdt_begin_node(buf, "images"));
+	ut_assertok(fdt_begin_node(buf, "kernel"));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_OFFSET_PROP, 0));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_SIZE_PROP, size));
+	ut_assertok(fdt_begin_node(buf, "hash-1"));
+	ut_assertok(fdt_property_string(buf, FIT_ALGO_PROP, "sha256"));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_finish(buf));
+
+	return 0;
+}
+
+/* Test hashing the images of a FIT while it is loaded */
+static int test_image_fit_load_hash(struct unit_test_state *uts)
+{
+	const int size = 0x3000, piece = 0x200;
+	u8 expect[HASH_MAX_DIGEST_SIZE], value[HASH_MAX_DIGEST_SIZE];
+	int expect_len, value_len;
+	ulong addr = 0x10000;
+	ulong data_ofs, pos;
+	u8 *fit, *data;
+	int i;
+
+	if (!CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD))
+		return -EAGAIN;
+
+	fit = map_sysmem(addr, 0x400 + size);
+	ut_assertok(make_fit_ext(uts, fit, 0x400, size));
+	data_ofs = ALIGN(fdt_totalsize(fit), 4);
+	data = fit + data_ofs;
+	for (i = 0; i < size; i++)
+		data[i] = i * 7;
+	ut_assertok(calculate_hash(data, size, "sha256", expect, &expect_len));
+
+	/* load the FIT in pieces */
+	fit_load_hash_start(addr);
+	for (pos = 0; pos < data_ofs + size; pos += piece) {
+		ulong len = min_t(ulong, piece, data_ofs + size - pos);
+
+		fit_load_hash_update(addr + pos, len);
+	}
+	fit_load_hash_end(true, data_ofs + size);
+
+	ut_assertok(fit_load_hash_get(data, size, "sha256", value, &value_len));
+	ut_asserteq(expect_len, value_len);
+	ut_asserteq_mem(expect, value, value_len);
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size, "sha1", value,
+					       &value_len));
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size - 1, "sha256", value,
+					       &value_len));
+
+	/* each digest is used once */
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size, "sha256", value,
+					       &value_len));
+
+	/* a later load over the data drops the digest */
+	fit_load_hash_start(addr);
+	fit_load_hash_update(addr, data_ofs + size);
+	fit_load_hash_end(true, data_ofs + size);
+	fit_load_hash_update(addr + data_ofs + size - 1, 1);
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size, "sha256", value,
+					       &value_len));
+
+	/* so does a write reported by a command */
+	fit_load_hash_start(addr);
+	fit_load_hash_update(addr, data_ofs + size);
+	fit_load_hash_end(true, data_ofs + size);
+	fit_load_hash_forget(addr + data_ofs, 4);
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size, "sha256", value,
+					       &value_len));
+
+	/* out-of-order data is hashed at the end */
+	fit_load_hash_start(addr);
+	fit_load_hash_update(addr, data_ofs);
+	fit_load_hash_update(addr + data_ofs + piece, size - piece);
+	fit_load_hash_update(addr + data_ofs, piece);
+	fit_load_hash_end(true, data_ofs + size);
+	ut_assertok(fit_load_hash_get(data, size, "sha256", value, &value_len));
+	ut_asserteq_mem(expect, value, value_len);
+
+	/* a failed load has no digests */
+	fit_load_hash_start(addr);
+	fit_load_hash_update(addr, data_ofs + size);
+	fit_load_hash_end(false, data_ofs + size);
+	ut_asserteq(-ENOENT, fit_load_hash_get(data, size, "sha256", value,
+					       &value_len));
+
+	unmap_sysmem(fit);
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_fit_load_hash, 0);
+
+/*
+ * Write a FIT with external data to @buf, with a kernel loaded to @load, a
+ * devicetree loaded to @fdt_load, or not loaded if 0, and an unused image, and
+ * a configuration using the first two
+ */
+static int make_fit_confs(struct unit_test_state *uts, void *buf, int buf_size,
+			  ulong load, ulong fdt_load)
+{
+	ut_assertok(fdt_create(buf, buf_size));
+	ut_assertok(fdt_finish_reservemap(buf));
+	ut_assertok(fdt_begin_node(buf, ""));
+	ut_assertok(fdt_property_string(buf, FIT_DESC_PROP, "test"));
+	ut_assertok(fdt_property_u32(buf, FIT_TIMESTAMP_PROP, 0));
+	ut_assertok(fdt_begin_node(buf, "images"));
+	ut_assertok(fdt_begin_node(buf, "kernel"));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_OFFSET_PROP, 0));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_SIZE_PROP, 0x100));
+	ut_assertok(fdt_property_u32(buf, FIT_LOAD_PROP, load));
+	ut_assertok(fdt_property_string(buf, FIT_COMP_PROP, "none"));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_begin_node(buf, "fdt"));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_OFFSET_PROP, 0x100));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_SIZE_PROP, 0x40));
+	if (fdt_load)
+		ut_assertok(fdt_property_u32(buf, FIT_LOAD_PROP, fdt_load));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_begin_node(buf, "unused"));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_OFFSET_PROP, 0x140));
+	ut_assertok(fdt_property_u32(buf, FIT_DATA_SIZE_PROP, 0x40));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_begin_node(buf, "configurations"));
+	ut_assertok(fdt_property_string(buf, FIT_DEFAULT_PROP, "conf-1"));
+	ut_assertok(fdt_begin_node(buf, "conf-1"));
+	ut_assertok(fdt_property_string(buf, FIT_KERNEL_PROP, "kernel"));
+	ut_assertok(fdt_property_string(buf, FIT_FDT_PROP, "fdt"));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_end_node(buf));
+	ut_assertok(fdt_finish(buf));
+
+	return 0;
+}
+
+static long fit_read_test_read(struct fit_read_info *info, ulong pos,
+			       ulong size, void *buf)
+{
+	memcpy(buf, info->priv + pos, size);
+
+	return size;
+}
+
+/* Test reading only the images used by a configuration */
+static int test_image_fit_read(struct unit_test_state *uts)
+{
+	ulong src_addr = 0x40000, addr = 0x50000, load = 0x30000;
+	struct fit_read_info info;
+	const void *data;
+	ulong data_ofs, size;
+	size_t data_size;
+	u8 *src, *fit;
+	int i, node;
+
+	if (!CONFIG_IS_ENABLED(FIT_READ))
+		return -EAGAIN;
+
+	src = map_sysmem(src_addr, 0x1000);
+	ut_assertok(make_fit_confs(uts, src, 0x400, load, 0));
+	data_ofs = ALIGN(fdt_totalsize(src), 4);
+	for (i = 0; i < 0x180; i++)
+		src[data_ofs + i] = i + 1;
+
+	fit = map_sysmem(addr, 0x1000);
+	memset(fit, '\0', 0x1000);
+	memset(map_sysmem(load, 0x100), '\0', 0x100);
+	info.read = fit_read_test_read;
+	info.priv = src;
+	ut_assertok(fit_read(&info, addr, NULL, &size));
+	ut_asserteq(data_ofs + 0x140, size);
+
+	/* the kernel is at its load address, the FIT says so */
+	ut_asserteq_mem(src + data_ofs, map_sysmem(load, 0x100), 0x100);
+	node = fdt_path_offset(fit, "/images/kernel");
+	ut_assert(node >= 0);
+	ut_assertok(fit_image_get_data_and_size(fit, node, &data, &data_size));
+	ut_asserteq_ptr(map_sysmem(load, 0), data);
+	ut_asserteq(0x100, data_size);
+
+	/* the devicetree is staged as in the file, the unused image not read */
+	ut_asserteq_mem(src + data_ofs + 0x100, fit + data_ofs + 0x100, 0x40);
+	ut_assertnull(memchr_inv(fit + data_ofs, '\0', 0x100));
+	ut_assertnull(memchr_inv(fit + data_ofs + 0x140, '\0', 0x40));
+
+	ut_asserteq(-ENOENT, fit_read(&info, addr, "conf-2", &size));
+
+	/* a devicetree loaded over the kernel is staged instead */
+	ut_assertok(make_fit_confs(uts, src, 0x400, load, load + 0x80));
+	data_ofs = ALIGN(fdt_totalsize(src), 4);
+	for (i = 0; i < 0x180; i++)
+		src[data_ofs + i] = i + 1;
+	memset(fit, '\0', 0x1000);
+	ut_assertok(fit_read(&info, addr, NULL, &size));
+	ut_asserteq(data_ofs + 0x140, size);
+	ut_asserteq_mem(src + data_ofs, map_sysmem(load, 0x100), 0x100);
+	ut_asserteq_mem(src + data_ofs + 0x100, fit + data_ofs + 0x100, 0x40);
+
+	/* one which is clear of it is read to its load address */
+	ut_assertok(make_fit_confs(uts, src, 0x400, load, load + 0x100));
+	data_ofs = ALIGN(fdt_totalsize(src), 4);
+	for (i = 0; i < 0x180; i++)
+		src[data_ofs + i] = i + 1;
+	memset(fit, '\0', 0x1000);
+	ut_assertok(fit_read(&info, addr, NULL, &size));
+	ut_asserteq(fdt_totalsize(src), size);
+	ut_asserteq_mem(src + data_ofs + 0x100, map_sysmem(load + 0x100, 0x40),
+			0x40);
+	ut_assertnull(memchr_inv(fit + data_ofs, '\0', 0x140));
+
+	unmap_sysmem(fit);
+	unmap_sysmem(src);
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_fit_read, 0);
+
+/* Test the index of the last FIT checked */
+static int test_image_fit_index(struct unit_test_state *uts)
+{
+	ulong addr = 0x40000;
+	int images, node;
+	void *fit;
+
+	if (!CONFIG_IS_ENABLED(FIT_INDEX))
+		return -EAGAIN;
+
+	fit = map_sysmem(addr, 0x400);
+	ut_assertok(make_fit_confs(uts, fit, 0x400, 0x30000, 0));
+	ut_asserteq(-ENOENT, fit_index_check(fit));
+	ut_assertok(fit_check_format(fit, IMAGE_SIZE_INVAL));
+	ut_assertok(fit_index_check(fit));
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	ut_asserteq(images, fit_index_path(fit, FIT_IMAGES_PATH));
+	ut_asserteq(fdt_path_offset(fit, FIT_CONFS_PATH),
+		    fit_index_path(fit, FIT_CONFS_PATH));
+	node = fdt_subnode_offset(fit, images, "fdt");
+	ut_assert(node > 0);
+	ut_asserteq(node, fit_index_image(fit, "fdt"));
+	ut_asserteq(node, fit_image_get_node(fit, "fdt"));
+	ut_asserteq(-ENOENT, fit_index_image(fit, "fdt@1"));
+	ut_asserteq(-ENOENT, fit_index_image(fit, "missing"));
+
+	ut_asserteq(-ENOENT, fit_index_get_compat(fit, fit));
+	fit_index_set_compat(fit, fit, node);
+	ut_asserteq(node, fit_index_get_compat(fit, fit));
+
+	/*
+	 * an in-place change does not move any node, so lookups still work,
+	 * but the next check drops the index until the FIT is checked again
+	 */
+	ut_assertok(fdt_setprop_inplace_u32(fit, node, FIT_DATA_SIZE_PROP,
+					    0x80));
+	ut_asserteq(node, fit_index_image(fit, "fdt"));
+	ut_asserteq(-ENOENT, fit_index_check(fit));
+	ut_asserteq(-ENOENT, fit_index_image(fit, "fdt"));
+	ut_asserteq(-ENOENT, fit_index_path(fit, FIT_IMAGES_PATH));
+	ut_asserteq(node, fit_image_get_node(fit, "fdt"));
+	ut_assertok(fit_check_format(fit, IMAGE_SIZE_INVAL));
+	ut_asserteq(node, fit_index_image(fit, "fdt"));
+	ut_asserteq(-ENOENT, fit_index_get_compat(fit, fit));
+
+	/* a FIT too short for the size given is still checked */
+	if (CONFIG_IS_ENABLED(FIT_FULL_CHECK))
+		ut_assert(fit_check_format(fit, fdt_totalsize(fit) - 1) < 0);
+
+	unmap_sysmem(fit);
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_fit_index, 0);
@@ -26,6 +26,27 @@
 
 #define SHIFT_TO_TCPHDRLEN_FIELD(x) ((x) << 4)
 #define LEN_B_TO_DW(x) ((x) >> 2)
+#define GET_TCP_HDR_LEN_IN_BYTES(x) ((x) >> 2)
+
+static const char sb_range_req[] = "\r\nRange: bytes=2-\r\n";
+static bool sb_range_seen;
+
+/* Check whether the HTTP request asks for the range used by the tests */
+static bool sb_http_range_requested(struct ip_tcp_hdr *tcp)
+{
+	const char *req = (void *)tcp + IP_HDR_SIZE +
+			  GET_TCP_HDR_LEN_IN_BYTES(tcp->tcp_hlen);
+	int req_len = ntohs(tcp->ip_len) - (req - (char *)tcp);
+	int len = strlen(sb_range_req);
+	int i;
+
+	for (i = 0; i + len <= req_len; i++) {
+		if (!memcmp(req + i, sb_range_req, len))
+			return true;
+	}
+
+	return false;
+}
 
 static int sb_arp_handler(struct udevice *dev, void *packet,
 			  unsigned int len)
@@ -106,6 +127,11 @@ static int sb_ack_handler(struct udevice *dev, void *packet,
 	const char *payload1 = "HTTP/1.1 200 OK\r\n"
 		"Content-Length: 30\r\n\r\n\r\n"
 		"<html><body>Hi</body></html>\r\n";
+	const char *payload2 = "HTTP/1.1 206 Partial Content\r\n"
+		"Content-Range: bytes 2-31/32\r\n"
+		"Content-Length: 30\r\n\r\n"
+		"<html><body>Hi</body></html>\r\n";
+	const char *payload;
 
 	/* Don't allow the buffer to overrun */
 	if (priv->recv_packets >= PKTBUFSRX)
@@ -123,8 +149,13 @@ static int sb_ack_handler(struct udevice *dev, void *packet,
 	if (ntohl(tcp->tcp_seq) == 1 && ntohl(tcp->tcp_ack) == 1) {
 		tcp_send->tcp_seq = htonl(ntohl(tcp->tcp_ack));
 		tcp_send->tcp_ack = htonl(ntohl(tcp->tcp_seq) + 1);
-		payload_len = strlen(payload1);
-		memcpy(data, payload1, payload_len);
+		payload = payload1;
+		if (sb_http_range_requested(tcp)) {
+			sb_range_seen = true;
+			payload = payload2;
+		}
+		payload_len = strlen(payload);
+		memcpy(data, payload, payload_len);
 		tcp_send->tcp_flags = TCP_ACK;
 	} else if (ntohl(tcp->tcp_seq) == 2) {
 		tcp_send->tcp_seq = htonl(ntohl(tcp->tcp_ack));
@@ -204,3 +235,28 @@ static int net_test_wget(struct unit_test_state *uts)
 }
 
 LIB_TEST(net_test_wget, 0);
+
+static int net_test_wget_range(struct unit_test_state *uts)
+{
+	sandbox_eth_set_tx_handler(0, sb_http_handler);
+	sandbox_eth_set_priv(0, uts);
+
+	env_set("ethact", "eth@10002000");
+	env_set("ethrotate", "no");
+	env_set("loadaddr", "0x20000");
+	sb_range_seen = false;
+	ut_assertok(run_command("wget -r 2- ${loadaddr} 1.1.2.2:/index.html",
+				0));
+	ut_assert(sb_range_seen);
+
+	sandbox_eth_set_tx_handler(0, NULL);
+
+	ut_assertok(console_record_reset_enable());
+	run_command("md5sum ${loadaddr} ${filesize}", 0);
+	ut_assert_nextline("md5 for 00020000 ... 0002001d ==> 41f1518e6e279e038ddfae79685c87c1");
+	ut_assertok(ut_check_console_end(uts));
+
+	return 0;
+}
+
+LIB_TEST(net_test_wget_range, 0);
@@ -33,3 +33,125 @@ static int dm_test_cyclic_running(struct unit_test_state *uts)
 	return 0;
 }
 COMMON_TEST(dm_test_cyclic_running, 0);
+
+#if CONFIG_IS_ENABLED(CYCLIC_TASK)
+/**
+ * struct task_test - Context for the test task
+ *
+ * @task: Task
+ * @wq: Queue the task waits on in its second step
+ * @ready: Value returned by the poll function of @wq
+ * @timeout_us: Timeout for waiting on @wq, or 0 for none
+ * @steps: Number of steps run
+ */
+struct task_test {
+	struct cyclic_task task;
+	struct cyclic_waitq wq;
+	bool ready;
+	uint64_t timeout_us;
+	int steps;
+};
+
+static bool task_test_poll(void *ctx)
+{
+	struct task_test *priv = ctx;
+
+	return priv->ready;
+}
+
+/* Sleep for 1ms, then wait on the queue, then finish */
+static int task_test_func(struct cyclic_task *task, void *ctx)
+{
+	struct task_test *priv = ctx;
+
+	priv->steps++;
+	if (task->cancel)
+		return -ECANCELED;
+	switch (task->state++) {
+	case 0:
+		return cyclic_task_sleep(task, 1000);
+	case 1:
+		return cyclic_task_wait(task, &priv->wq, priv->timeout_us);
+	default:
+		return task->timed_out ? -EIO : 0;
+	}
+}
+
+static void task_test_start(struct task_test *priv, uint64_t timeout_us)
+{
+	memset(priv, '\0', sizeof(*priv));
+	priv->wq = (struct cyclic_waitq)CYCLIC_WAITQ_INIT(task_test_poll, priv);
+	priv->timeout_us = timeout_us;
+	cyclic_task_start(&priv->task, task_test_func, "task_test", priv);
+}
+
+/* Test that a task sleeps and waits on a queue */
+static int test_cyclic_task(struct unit_test_state *uts)
+{
+	struct task_test priv;
+	int i;
+
+	task_test_start(&priv, 0);
+	schedule();
+	ut_asserteq(1, priv.steps);
+	ut_asserteq(-ETIMEDOUT, cyclic_task_join(&priv.task, 100));
+
+	/* once the sleep is over, the task waits for the poll to succeed */
+	mdelay(2);
+	schedule();
+	ut_asserteq(2, priv.steps);
+	for (i = 0; i < 10; i++)
+		schedule();
+	ut_asserteq(2, priv.steps);
+	ut_assert(!priv.task.done);
+
+	priv.ready = true;
+	ut_assertok(cyclic_task_join(&priv.task, 0));
+	ut_asserteq(3, priv.steps);
+	ut_assert(list_empty(cyclic_task_get_list()));
+
+	/* the task can also be woken directly */
+	task_test_start(&priv, 0);
+	priv.wq.poll = NULL;
+	mdelay(2);
+	schedule();
+	schedule();
+	ut_asserteq(2, priv.steps);
+	cyclic_task_wake(&priv.wq);
+	schedule();
+	ut_assert(priv.task.done);
+	ut_assertok(priv.task.ret);
+
+	return 0;
+}
+COMMON_TEST(test_cyclic_task, 0);
+
+/* Test that waiting on a queue times out, and that tasks can be cancelled */
+static int test_cyclic_task_cancel(struct unit_test_state *uts)
+{
+	struct task_test priv, other;
+
+	task_test_start(&priv, 1000);
+	ut_asserteq(-EIO, cyclic_task_join(&priv.task, 0));
+	ut_asserteq(3, priv.steps);
+
+	/* a cancelled task runs at once */
+	task_test_start(&priv, 0);
+	schedule();
+	cyclic_task_cancel(&priv.task);
+	ut_asserteq(-ECANCELED, cyclic_task_join(&priv.task, 500));
+	ut_asserteq(2, priv.steps);
+
+	/* stopping all tasks gives each a chance to finish */
+	task_test_start(&priv, 0);
+	task_test_start(&other, 0);
+	cyclic_task_stop_all();
+	ut_assert(priv.task.done);
+	ut_asserteq(-ECANCELED, other.task.ret);
+	ut_asserteq(1, other.steps);
+	ut_assert(list_empty(cyclic_task_get_list()));
+
+	return 0;
+}
+COMMON_TEST(test_cyclic_task_cancel, 0);
+#endif
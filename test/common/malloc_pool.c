@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the malloc() pools
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Test allocating, resizing and freeing objects from the pools */
+static int test_malloc_pool(struct unit_test_state *uts)
+{
+	struct malloc_pool_stats before[16], after[16];
+	u8 *ptr, *ptr2;
+	ulong start;
+	int i;
+
+	ut_assert(malloc_pool_get_stats(before, ARRAY_SIZE(before)) > 1);
+	ut_asserteq(32, before[1].size);
+	start = ut_check_free();
+
+	/* a 20-byte object comes from the 32-byte class and is zeroed */
+	ptr = pool_calloc(2, 10);
+	ut_assertnonnull(ptr);
+	ut_asserteq(32, malloc_usable_size(ptr));
+	for (i = 0; i < 20; i++)
+		ut_asserteq(0, ptr[i]);
+	malloc_pool_get_stats(after, ARRAY_SIZE(after));
+	ut_asserteq(before[1].in_use + 1, after[1].in_use);
+	ut_assert(after[1].peak >= after[1].in_use);
+
+	/* it stays put while it fits in its class, then moves to the heap */
+	ut_asserteq_ptr(ptr, realloc(ptr, 32));
+	memset(ptr, 0xaa, 32);
+	ptr2 = realloc(ptr, 100);
+	ut_assertnonnull(ptr2);
+	ut_asserteq(0, malloc_pool_usable_size(ptr2));
+	for (i = 0; i < 32; i++)
+		ut_asserteq(0xaa, ptr2[i]);
+	malloc_pool_get_stats(after, ARRAY_SIZE(after));
+	ut_asserteq(before[1].in_use, after[1].in_use);
+	free(ptr2);
+
+	/* the last object freed is the next one allocated */
+	ptr = pool_calloc(1, 16);
+	ut_assertnonnull(ptr);
+	free(ptr);
+	ut_asserteq_ptr(ptr, pool_calloc(1, 9));
+	free(ptr);
+
+	/* large objects come from the heap */
+	ptr = pool_calloc(1, 4096);
+	ut_assertnonnull(ptr);
+	ut_asserteq(0, malloc_pool_usable_size(ptr));
+	free(ptr);
+
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+COMMON_TEST(test_malloc_pool, 0);
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for tracing of malloc() allocations
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Test that allocations are recorded with their caller until freed */
+static int test_malloc_trace(struct unit_test_state *uts)
+{
+	const struct malloc_trace_rec *rec;
+	struct malloc_trace_stats before, after;
+	ulong caller, time_us;
+	void *ptr[2], *other;
+	int i;
+
+	malloc_trace_get_stats(&before);
+
+	ptr[0] = malloc(100);
+	ut_assertnonnull(ptr[0]);
+	rec = malloc_trace_find(ptr[0]);
+	ut_assertnonnull(rec);
+	ut_asserteq(100, rec->size);
+	ut_assert(rec->caller);
+	caller = rec->caller;
+	time_us = rec->time_us;
+
+	ptr[1] = malloc(101);
+	ut_assertnonnull(ptr[1]);
+	rec = malloc_trace_find(ptr[1]);
+	ut_assertnonnull(rec);
+	ut_asserteq(101, rec->size);
+	ut_assert(rec->time_us >= time_us);
+
+	/* each call is recorded against the place it was made from */
+	ut_assert(rec->caller != caller);
+	other = calloc(3, 10);
+	ut_assertnonnull(other);
+	rec = malloc_trace_find(other);
+	ut_assertnonnull(rec);
+	ut_asserteq(30, rec->size);
+	ut_assert(rec->caller != caller);
+
+	malloc_trace_get_stats(&after);
+	ut_asserteq(before.count + 3, after.count);
+	ut_asserteq(before.bytes + 231, after.bytes);
+	ut_assert(after.peak_bytes >= after.bytes);
+
+	/* moving an allocation moves its record */
+	ptr[0] = realloc(ptr[0], 0x1000);
+	ut_assertnonnull(ptr[0]);
+	rec = malloc_trace_find(ptr[0]);
+	ut_assertnonnull(rec);
+	ut_asserteq(0x1000, rec->size);
+
+	/* allocations from the pools are traced too */
+	free(other);
+	ut_assertnull(malloc_trace_find(other));
+	other = pool_calloc(1, 24);
+	ut_assertnonnull(other);
+	rec = malloc_trace_find(other);
+	ut_assertnonnull(rec);
+	ut_asserteq(24, rec->size);
+
+	/* the mark resets the high-water mark */
+	malloc_trace_mark();
+	malloc_trace_get_stats(&after);
+	ut_asserteq(after.bytes, after.peak_bytes);
+	ut_asserteq(after.count, after.peak_count);
+
+	free(other);
+	for (i = 0; i < 2; i++)
+		free(ptr[i]);
+	malloc_trace_get_stats(&after);
+	ut_asserteq(before.count, after.count);
+	ut_asserteq(before.bytes, after.bytes);
+	ut_assertnull(malloc_trace_find(ptr[1]));
+
+	return 0;
+}
+COMMON_TEST(test_malloc_trace, 0);
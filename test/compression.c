@@ -5,14 +5,19 @@
 
 #include <common.h>
 #include <abuf.h>
+#include <blk.h>
 #include <bootm.h>
 #include <command.h>
+#include <div64.h>
 #include <gzip.h>
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <part.h>
+#include <time.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -23,6 +28,7 @@
 #include <lzma/LzmaTools.h>
 
 #include <linux/lzo.h>
+#include <linux/sizes.h>
 #include <linux/zstd.h>
 #include <test/compression.h>
 #include <test/suites.h>
@@ -245,6 +251,31 @@ static int uncompress_using_lzma(struct unit_test_state *uts,
 	return (ret != SZ_OK);
 }
 
+/* Hand out the compressed data a few bytes at a time */
+static const unsigned char *lzma_stream_read(void *priv, SizeT offset,
+					     SizeT *lenp)
+{
+	*lenp = min(*lenp, (SizeT)7);
+
+	return priv + offset;
+}
+
+static int uncompress_using_lzma_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	int ret;
+	SizeT inout_size = out_max;
+
+	ret = lzmaStreamDecompress(out, &inout_size, lzma_stream_read, in,
+				   in_size);
+	if (out_size)
+		*out_size = inout_size;
+
+	return (ret != SZ_OK);
+}
+
 static int compress_using_lzo(struct unit_test_state *uts,
 			      void *in, unsigned long in_size,
 			      void *out, unsigned long out_max,
@@ -489,6 +520,13 @@ static int compression_test_lzma(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lzma, 0);
 
+static int compression_test_lzma_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "lzma_stream", compress_using_lzma,
+			uncompress_using_lzma_stream);
+}
+COMPRESSION_TEST(compression_test_lzma_stream, 0);
+
 static int compression_test_lzo(struct unit_test_state *uts)
 {
 	return run_test(uts, "lzo", compress_using_lzo, uncompress_using_lzo);
@@ -508,6 +546,377 @@ static int compression_test_zstd(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_zstd, 0);
 
+#define SPEED_SIZE	(1 << 20)
+#define SPEED_LOOPS	4
+
+/* Fill @buf with text, runs of zeroes and some noise, like a kernel image */
+static void fill_speed_data(char *buf, ulong size)
+{
+	ulong len = strlen(plain);
+	u32 seed = 1;
+	ulong i;
+
+	for (i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		if ((i / 4096) % 8 == 7)
+			buf[i] = 0;
+		else if (!(seed >> 28))
+			buf[i] = seed >> 16;
+		else
+			buf[i] = plain[i % len];
+	}
+}
+
+/**
+ * run_speed_test() - Measure how fast a codec decompresses
+ *
+ * @name:	name of the codec
+ * @uncompress:	function to decompress with
+ * @in:		compressed data
+ * @in_size:	size of the compressed data
+ * @orig:	data expected after decompression
+ * @orig_size:	size of @orig
+ * @loops:	number of times to decompress
+ * Return: 0 if OK, non-zero on failure
+ */
+static int run_speed_test(struct unit_test_state *uts, const char *name,
+			  mutate_func uncompress, void *in, ulong in_size,
+			  const void *orig, ulong orig_size, int loops)
+{
+	ulong out_size;
+	ulong start, us;
+	void *out;
+	int i;
+
+	out = malloc(orig_size);
+	ut_assertnonnull(out);
+
+	start = timer_get_us();
+	for (i = 0; i < loops; i++) {
+		ut_assertok(uncompress(uts, in, in_size, out, orig_size,
+				       &out_size));
+	}
+	us = max(timer_get_us() - start, 1UL);
+	ut_asserteq(orig_size, out_size);
+	ut_asserteq_mem(orig, out, orig_size);
+	free(out);
+
+	printf("%8s: %7lu -> %7lu bytes, %5lu MB/s\n", name, in_size,
+	       orig_size, (ulong)lldiv((u64)orig_size * loops, us));
+
+	return 0;
+}
+
+/* Report the decompression speed of each codec */
+static int compression_test_speed(struct unit_test_state *uts)
+{
+	ulong len = strlen(plain);
+	int loops = SPEED_SIZE / len;
+	ulong size = SPEED_SIZE;
+	void *orig, *comp;
+
+	orig = malloc(SPEED_SIZE);
+	comp = malloc(SPEED_SIZE);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	fill_speed_data(orig, SPEED_SIZE);
+	ut_assertok(gzip(comp, &size, orig, SPEED_SIZE));
+	ut_assertok(run_speed_test(uts, "gzip", uncompress_using_gzip, comp,
+				   size, orig, SPEED_SIZE, SPEED_LOOPS));
+	free(comp);
+	free(orig);
+
+	/* The other codecs can only decompress, so use the sample data */
+	ut_assertok(run_speed_test(uts, "bzip2", uncompress_using_bzip2,
+				   (void *)bzip2_compressed,
+				   bzip2_compressed_size, plain, len, loops));
+	ut_assertok(run_speed_test(uts, "lzma", uncompress_using_lzma,
+				   (void *)lzma_compressed,
+				   lzma_compressed_size, plain, len, loops));
+	ut_assertok(run_speed_test(uts, "lzo", uncompress_using_lzo,
+				   (void *)lzo_compressed, lzo_compressed_size,
+				   plain, len, loops));
+	ut_assertok(run_speed_test(uts, "lz4", uncompress_using_lz4,
+				   (void *)lz4_compressed, lz4_compressed_size,
+				   plain, len, loops));
+	ut_assertok(run_speed_test(uts, "zstd", uncompress_using_zstd,
+				   (void *)zstd_compressed,
+				   zstd_compressed_size, plain, len, loops));
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_speed, 0);
+
+/* Size of the extra field added by make_indexed_member() */
+#define INDEX_EXTRA	14
+
+/* BGZF end-of-file marker: an empty member with a 'B','C' index field */
+static const u8 bgzf_eof[] = {
+	0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00,
+	0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+};
+
+/* Compress @size bytes at @src as a gzip member with a 'U','B' index field */
+static int make_indexed_member(struct unit_test_state *uts, void *src,
+			       ulong size, u8 *dst, ulong *lenp)
+{
+	ulong len = *lenp - INDEX_EXTRA;
+
+	ut_assertok(gzip(dst + INDEX_EXTRA, &len, src, size));
+	/* move the header in front of the extra field */
+	memmove(dst, dst + INDEX_EXTRA, 10);
+	dst[3] |= 4;
+	put_unaligned_le16(INDEX_EXTRA - 2, dst + 10);
+	dst[12] = 'U';
+	dst[13] = 'B';
+	put_unaligned_le16(8, dst + 14);
+	put_unaligned_le32(len + INDEX_EXTRA, dst + 16);
+	put_unaligned_le32(size, dst + 20);
+	*lenp = len + INDEX_EXTRA;
+
+	return 0;
+}
+
+/* Read @size bytes at @offset and check that @expect bytes are correct */
+static int check_gzip_read(struct unit_test_state *uts, void *comp, ulong len,
+			   const char *orig, u64 offset, ulong size,
+			   ulong expect)
+{
+	ulong got = size;
+	char *buf;
+
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	ut_assertok(gzip_read(comp, len, offset, buf, &got));
+	ut_asserteq(expect, got);
+	ut_asserteq_mem(orig + offset, buf, got);
+	free(buf);
+
+	return 0;
+}
+
+/* Test random access to an indexed gzip file made of several members */
+static int compression_test_gzip_index(struct unit_test_state *uts)
+{
+	static const ulong sizes[] = { 0x10000, 50000, 0x10000, 7 };
+	ulong total = 0, pos = 0, len, csize;
+	struct gzip_member m;
+	void *comp, *buf;
+	char *orig;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++)
+		total += sizes[i];
+	csize = total * 2;
+	orig = malloc(total);
+	comp = malloc(csize);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	fill_speed_data(orig, total);
+
+	for (i = 0, total = 0; i < ARRAY_SIZE(sizes); i++) {
+		len = csize - pos;
+		ut_assertok(make_indexed_member(uts, orig + total, sizes[i],
+						comp + pos, &len));
+		pos += len;
+		total += sizes[i];
+	}
+	memcpy(comp + pos, bgzf_eof, sizeof(bgzf_eof));
+	len = pos + sizeof(bgzf_eof);
+
+	/* the index gives the member holding an offset, and the total size */
+	ut_assertok(gzip_find_member(comp, len, sizes[0] + 5, &m));
+	ut_asserteq(sizes[0], m.uoffset);
+	ut_asserteq(sizes[1], m.usize);
+	ut_asserteq(-ERANGE, gzip_find_member(comp, len, ~0ULL, &m));
+	ut_asserteq(total, m.uoffset);
+
+	/* within a member, across members, past the end and at the end */
+	ut_assertok(check_gzip_read(uts, comp, len, orig, 0, total, total));
+	ut_assertok(check_gzip_read(uts, comp, len, orig, 1000, 100, 100));
+	ut_assertok(check_gzip_read(uts, comp, len, orig, sizes[0] - 10,
+				    sizes[1] + 20, sizes[1] + 20));
+	ut_assertok(check_gzip_read(uts, comp, len, orig, total - 100, 1000,
+				    100));
+	ut_assertok(check_gzip_read(uts, comp, len, orig, total, 10, 0));
+	buf = malloc(10);
+	ut_assertnonnull(buf);
+	pos = 10;
+	ut_asserteq(-ERANGE, gzip_read(comp, len, total + 1, buf, &pos));
+
+	/* corruption of a member which is read completely is detected */
+	ut_assertok(gzip_find_member(comp, len, sizes[0], &m));
+	((u8 *)comp)[m.offset + m.size - 8] ^= 1;
+	pos = 10;
+	ut_assertok(gzip_read(comp, len, sizes[0], buf, &pos));
+	pos = 10;
+	ut_asserteq(-EIO, gzip_read(comp, len, sizes[0] + sizes[1] - 5, buf,
+				    &pos));
+	free(buf);
+
+	/* a gzip file without an index cannot be searched */
+	len = csize;
+	ut_assertok(gzip(comp, &len, orig, total));
+	ut_asserteq(-ENOENT, gzip_find_member(comp, len, 0, &m));
+
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_index, 0);
+
+/* Size of the output written by compression_test_gzwrite_zero() */
+#define GZWRITE_SIZE	SZ_64K
+
+/*
+ * Fill the first @GZWRITE_SIZE bytes of mmc0 with 0xff, run gzwrite with
+ * @opts on @comp and read back the output into @buf
+ */
+static int run_gzwrite(struct unit_test_state *uts, const char *opts,
+		       void *comp, ulong len, struct blk_desc *desc, void *buf)
+{
+	ulong blocks = GZWRITE_SIZE / desc->blksz;
+
+	memset(buf, 0xff, GZWRITE_SIZE);
+	ut_asserteq(blocks, blk_dwrite(desc, 0, blocks, buf));
+	ut_assertok(run_commandf("gzwrite %s mmc 0 %lx %lx 1000", opts,
+				 (ulong)map_to_sysmem(comp), len));
+	ut_asserteq(blocks, blk_dread(desc, 0, blocks, buf));
+
+	return 0;
+}
+
+/* Test the handling of blocks of zeroes by gzwrite -s and -e */
+static int compression_test_gzwrite_zero(struct unit_test_state *uts)
+{
+	struct blk_desc *desc;
+	ulong len = GZWRITE_SIZE;
+	void *comp, *buf;
+	char *orig;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	orig = malloc(GZWRITE_SIZE);
+	comp = malloc(len);
+	buf = malloc(GZWRITE_SIZE);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(buf);
+
+	/* data, then blocks of zeroes filling whole write buffers, then data */
+	memset(orig, 0xa5, GZWRITE_SIZE);
+	memset(orig + SZ_16K, '\0', SZ_32K);
+	ut_assertok(gzip(comp, &len, orig, GZWRITE_SIZE));
+
+	/* without an option, everything is written */
+	ut_assertok(run_gzwrite(uts, "", comp, len, desc, buf));
+	ut_asserteq_mem(orig, buf, GZWRITE_SIZE);
+
+	/* -s leaves the old contents where the output is zero */
+	ut_assertok(run_gzwrite(uts, "-s", comp, len, desc, buf));
+	ut_asserteq_mem(orig, buf, SZ_16K);
+	ut_assertnull(memchr_inv(buf + SZ_16K, 0xff, SZ_32K));
+	ut_asserteq_mem(orig + SZ_16K + SZ_32K, buf + SZ_16K + SZ_32K,
+			SZ_16K);
+
+	/* -e erases those blocks, which the device reads back as zero */
+	ut_assertok(run_gzwrite(uts, "-e", comp, len, desc, buf));
+	ut_asserteq_mem(orig, buf, GZWRITE_SIZE);
+
+	free(buf);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzwrite_zero,
+		 UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
+/* Environment of the kind a dictionary is trained on */
+static const char zstd_dict_plain[] =
+	"bootcmd=run distro_bootcmd\n"
+	"bootdelay=2\n"
+	"baudrate=115200\n"
+	"ethaddr=00:11:22:33:44:2a\n"
+	"ipaddr=192.168.1.42\n"
+	"serverip=192.168.1.1\n"
+	"fdtfile=loongson/ls2k0300-board0.dtb\n"
+	"loadaddr=0x9000000090000000\n";
+
+/*
+ * zstd --train env*.txt --maxdict=512 -o /tmp/dict
+ * zstd -19 -D /tmp/dict -c /tmp/env.txt > /tmp/env.zst
+ */
+static const char zstd_test_dict[] =
+	"\x37\xa4\x30\xec\x36\x3b\x6c\x40\x1c\x10\xd8\x0a\x92\x0e\x0c\xc3"
+	"\x30\x0c\xc3\x14\x86\x23\x4d\x12\x31\x29\x60\xef\xbd\xe5\xde\x72"
+	"\xc3\x0c\xce\x59\x1b\x53\x01\x00\x00\x00\x00\x13\x57\xfc\x01\x00"
+	"\x00\x04\x00\x00\x00\x00\x12\x08\x00\x49\x18\x00\x00\x00\x00\x18"
+	"\x00\x3a\x4c\x10\x00\x00\x66\x00\x00\x40\x03\x00\x00\x00\x00\x80"
+	"\x24\x00\x00\x00\x30\x7b\x00\x00\x00\x00\x00\x00\x24\x12\x93\xf6"
+	"\xd0\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01"
+	"\x00\x00\x00\x04\x00\x00\x00\x08\x00\x00\x00\x39\x32\x2e\x31\x36"
+	"\x38\x2e\x31\x2e\x31\x0a\x66\x39\x32\x2e\x31\x36\x38\x2e\x31\x2e"
+	"\x31\x0a\x66\x64\x74\x66\x69\x6c\x65\x3d\x6c\x6f\x6f\x6e\x67\x73"
+	"\x6f\x6e\x2f\x6c\x73\x32\x6b\x30\x33\x30\x30\x2d\x62\x6f\x61\x72"
+	"\x64\x34\x2e\x64\x74\x62\x0a\x6c\x6f\x74\x64\x65\x6c\x61\x79\x3d"
+	"\x31\x0a\x62\x61\x75\x64\x72\x61\x74\x65\x3d\x31\x31\x35\x32\x30"
+	"\x30\x0a\x65\x74\x68\x61\x64\x64\x72\x3d\x30\x30\x3a\x31\x31\x3a"
+	"\x32\x32\x3a\x33\x33\x3a\x34\x34\x3a\x36\x61\x74\x64\x65\x6c\x61"
+	"\x79\x3d\x33\x0a\x62\x61\x75\x64\x72\x61\x74\x65\x3d\x31\x31\x35"
+	"\x32\x30\x30\x0a\x65\x74\x68\x61\x64\x64\x72\x3d\x30\x30\x3a\x31"
+	"\x31\x3a\x32\x32\x3a\x33\x33\x3a\x34\x34\x3a\x34\x39\x74\x64\x65"
+	"\x6c\x61\x79\x3d\x30\x0a\x62\x61\x75\x64\x72\x61\x74\x65\x3d\x31"
+	"\x31\x35\x32\x30\x30\x0a\x65\x74\x68\x61\x64\x64\x72\x3d\x30\x30"
+	"\x3a\x31\x31\x3a\x32\x32\x3a\x33\x33\x3a\x34\x34\x3a\x38\x37\x74"
+	"\x64\x65\x6c\x61\x79\x3d\x32\x0a\x62\x61\x75\x64\x72\x61\x74\x65"
+	"\x3d\x31\x31\x35\x32\x30\x30\x0a\x65\x74\x68\x61\x64\x64\x72\x3d"
+	"\x30\x30\x3a\x31\x31\x3a\x32\x32\x3a\x33\x33\x3a\x34\x34\x3a\x32"
+	"\x30\x61\x64\x64\x72\x3d\x30\x30\x3a\x31\x31\x3a\x32\x32\x3a\x33"
+	"\x33\x3a\x34\x34\x3a\x39\x62\x0a\x69\x70\x61\x64\x64\x72\x3d\x31"
+	"\x39\x32\x2e\x31\x36\x38\x2e\x31\x2e\x31\x35\x35\x0a\x73\x65\x72"
+	"\x76\x65\x72\x6c\x65\x3d\x6c\x6f\x6f\x6e\x67\x73\x6f\x6e\x2f\x6c"
+	"\x73\x32\x6b\x30\x33\x30\x30\x2d\x62\x6f\x61\x72\x64\x32\x2e\x64"
+	"\x74\x62\x0a\x6c\x6f\x61\x64\x61\x64\x64\x72\x3d\x30\x78\x39\x30"
+	"\x30\x30\x30\x30\x30\x62\x6f\x6f\x74\x64\x65\x6c\x61\x79\x3d\x34"
+	"\x0a\x62\x61\x75\x64\x72\x61\x74\x65\x3d\x31\x31\x35\x32\x30\x30";
+
+static const char zstd_dict_compressed[] =
+	"\x28\xb5\x2f\xfd\x27\x36\x3b\x6c\x40\xbb\xa5\x01\x00\xe0\x62\x6f"
+	"\x6f\x74\x63\x6d\x64\x3d\x72\x75\x6e\x20\x64\x69\x73\x74\x72\x6f"
+	"\x5f\x0a\x61\x34\x32\x69\x70\x30\x30\x0a\x09\xcc\xab\xfc\xd3\x60"
+	"\x7d\xf5\x47\x77\x9f\x3c\xcf\xae\xd4\xcc\x66\x75\xeb\x5a\x8a\x39"
+	"\x3f\xdf\x9d\xc1\x81";
+
+/* Test decompressing data compressed with a dictionary */
+static int compression_test_zstd_dict(struct unit_test_state *uts)
+{
+	ulong len = sizeof(zstd_dict_plain) - 1;
+	struct abuf in, out;
+	char buf[256];
+
+	abuf_init_set(&in, (void *)zstd_dict_compressed,
+		      sizeof(zstd_dict_compressed) - 1);
+	abuf_init_set(&out, buf, sizeof(buf));
+	ut_asserteq(0x406c3b36,
+		    zstd_get_dict_id_from_frame(zstd_dict_compressed,
+						sizeof(zstd_dict_compressed) - 1));
+	ut_asserteq(len, zstd_decompress_dict(&in, &out, zstd_test_dict,
+					      sizeof(zstd_test_dict) - 1));
+	ut_asserteq_mem(zstd_dict_plain, buf, len);
+
+	/* the dictionary is not built in, so plain decompression fails */
+	ut_asserteq(-ENOKEY, zstd_decompress(&in, &out));
+
+	/* data compressed without a dictionary needs none */
+	ut_asserteq(0, zstd_get_dict_id_from_frame(zstd_compressed,
+						   zstd_compressed_size));
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_zstd_dict, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -610,6 +1019,82 @@ static int compression_test_bootm_none(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_bootm_none, 0);
 
+/**
+ * run_in_place_test() - Decompress an image placed as bootm places it
+ *
+ * The compressed data is put at the end of the output buffer, with the
+ * margin from image_decomp_margin(), and decompressed in place.
+ *
+ * @comp_type:	Compression type to test
+ * @data:	Uncompressed data
+ * @size:	Size of @data in bytes
+ * @comp:	Compressed data
+ * @comp_size:	Size of @comp in bytes
+ * Return: 0 if OK, non-zero on failure
+ */
+static int run_in_place_test(struct unit_test_state *uts, int comp_type,
+			     const void *data, ulong size, const void *comp,
+			     ulong comp_size)
+{
+	const ulong load = 0x100000;
+	ulong unc_size, start, end, load_end;
+
+	ut_assertok(image_decomp_size(comp_type, comp, comp_size, &unc_size));
+	ut_asserteq(size, unc_size);
+
+	end = load + size + image_decomp_margin(comp_type, size);
+	start = ALIGN_DOWN(end - comp_size, 8);
+	memset(map_sysmem(load, start - load), '\0', start - load);
+	memmove(map_sysmem(start, comp_size), comp, comp_size);
+	ut_assertok(image_decomp(comp_type, load, start, IH_TYPE_KERNEL,
+				 map_sysmem(load, size),
+				 map_sysmem(start, comp_size), comp_size, size,
+				 &load_end));
+	ut_asserteq(load + size, load_end);
+	ut_asserteq_mem(data, map_sysmem(load, size), size);
+
+	return 0;
+}
+
+static int compression_test_bootm_in_place(struct unit_test_state *uts)
+{
+	const ulong size = SZ_1M;
+	ulong comp_size = size + SZ_64K;
+	ulong unc_size;
+	u8 *data, *comp;
+	uint seed = 1;
+	int i;
+
+	/* random letters, which compress to about 60% of their size */
+	data = malloc(size);
+	comp = malloc(comp_size);
+	ut_assertnonnull(data);
+	ut_assertnonnull(comp);
+	for (i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = 'a' + (seed >> 16) % 26;
+	}
+	ut_assertok(gzip(comp, &comp_size, data, size));
+	ut_assertok(run_in_place_test(uts, IH_COMP_GZIP, data, size, comp,
+				      comp_size));
+
+	ut_assertok(run_in_place_test(uts, IH_COMP_ZSTD, plain, strlen(plain),
+				      zstd_compressed, zstd_compressed_size));
+
+	/* this lz4 frame does not record its size */
+	ut_asserteq(-ENOENT, image_decomp_size(IH_COMP_LZ4, lz4_compressed,
+					       lz4_compressed_size,
+					       &unc_size));
+	ut_asserteq(-ENOSYS, image_decomp_size(IH_COMP_LZMA, comp, comp_size,
+					       &unc_size));
+
+	free(comp);
+	free(data);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_bootm_in_place, 0);
+
 int do_ut_compression(struct cmd_tbl *cmdtp, int flag, int argc,
 		      char *const argv[])
 {
@@ -6,6 +6,7 @@
  */
 
 #include <common.h>
+#include <bloblist.h>
 #include <errno.h>
 #include <dm.h>
 #include <fdtdec.h>
@@ -1353,3 +1354,147 @@ static int dm_test_dev_get_mem(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_dev_get_mem, UT_TESTF_SCAN_FDT);
+
+/* Test probing devices which were left until they are used */
+static int dm_test_probe_deferred(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	ut_assertok(uclass_find_first_device(UCLASS_TEST_FDT, &dev));
+	ut_assertnonnull(dev);
+	ut_assert(!device_active(dev));
+
+	dev_or_flags(dev, DM_FLAG_PROBE_DEFERRED);
+	dm_probe_deferred();
+	ut_assert(device_active(dev));
+	ut_assert(dev_get_flags(dev) & DM_FLAG_PROBE_DEFERRED);
+
+	/* other devices are left alone */
+	ut_assertok(uclass_find_first_device(UCLASS_TEST_BUS, &dev));
+	ut_assert(!device_active(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_probe_deferred, UT_TESTF_SCAN_FDT);
+
+/* Test that probing after bind is deferred only for devices which allow it */
+static int dm_test_probe_may_defer(struct unit_test_state *uts)
+{
+	struct udevice *on, *off, *rtc;
+
+	if (!CONFIG_IS_ENABLED(DM_DEFERRED_PROBE))
+		return -EAGAIN;
+
+	ut_assertok(uclass_find_device_by_name(UCLASS_LED, "default_on", &on));
+	ut_assertok(uclass_find_device_by_name(UCLASS_LED, "default_off",
+					       &off));
+	ut_assertok(uclass_find_first_device(UCLASS_RTC, &rtc));
+	ut_assertnonnull(rtc);
+	ut_assert(!device_active(on));
+	ut_assert(!device_active(off));
+	ut_assert(!device_active(rtc));
+
+	/* the RTC is allowed to wait by its uclass */
+	dev_or_flags(rtc, DM_FLAG_PROBE_AFTER_BIND);
+	ut_assertok(dm_probe_devices(gd->dm_root, false));
+
+	/* an LED which defaults to on is probed at once, the others wait */
+	ut_assert(device_active(on));
+	ut_assert(!(dev_get_flags(on) & DM_FLAG_PROBE_DEFERRED));
+	ut_assert(!device_active(off));
+	ut_assert(dev_get_flags(off) & DM_FLAG_PROBE_DEFERRED);
+	ut_assert(!device_active(rtc));
+	ut_assert(dev_get_flags(rtc) & DM_FLAG_PROBE_DEFERRED);
+
+	dm_probe_deferred();
+	ut_assert(device_active(off));
+	ut_assert(device_active(rtc));
+
+	return 0;
+}
+DM_TEST(dm_test_probe_may_defer, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DM_PROBE_STATS)
+/* Test recording the memory used by a device */
+static int dm_test_dev_times(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	ut_assertok(uclass_find_first_device(UCLASS_TEST_DEVRES, &dev));
+	ut_assertnonnull(dev);
+	ut_asserteq(0, dev->stats.priv_bytes);
+	ut_asserteq(0, dev->stats.devres_bytes);
+
+	/* the allocation in bind() is not counted */
+	ut_assertok(device_probe(dev));
+	ut_asserteq(dev_get_attach_size(dev, DM_TAG_PRIV),
+		    dev->stats.priv_bytes);
+	ut_asserteq(TEST_DEVRES_SIZE2 + TEST_DEVRES_SIZE3,
+		    dev->stats.devres_bytes);
+
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_asserteq(0, dev->stats.priv_bytes);
+	ut_asserteq(0, dev->stats.devres_bytes);
+
+	return 0;
+}
+DM_TEST(dm_test_dev_times, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static int count_active(struct udevice *dev)
+{
+	struct udevice *child;
+	int count = device_active(dev);
+
+	device_foreach_child(child, dev)
+		count += count_active(child);
+
+	return count;
+}
+
+/* Test writing the device stats to the bloblist */
+static int dm_test_dev_times_stash(struct unit_test_state *uts)
+{
+	struct dm_times_hdr *hdr;
+	struct dm_times_rec *rec;
+	struct udevice *dev;
+	int i, count;
+	bool found;
+
+	ut_assertok(uclass_first_device_err(UCLASS_TEST, &dev));
+	count = count_active(dm_root());
+
+	ut_assertok(bloblist_new(CONFIG_BLOBLIST_ADDR, CONFIG_BLOBLIST_SIZE, 0,
+				 0));
+	ut_assertok(dm_stash_times());
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_DM_TIMES, 0);
+	ut_assertnonnull(hdr);
+	ut_asserteq(DM_TIMES_VERSION, hdr->version);
+	ut_asserteq(sizeof(*hdr), hdr->hdr_size);
+	ut_asserteq(sizeof(*rec), hdr->rec_size);
+	ut_asserteq(count, hdr->count);
+
+	found = false;
+	rec = (struct dm_times_rec *)(hdr + 1);
+	for (i = 0; i < hdr->count; i++, rec++) {
+		if (!strcmp(rec->name, dev->name)) {
+			ut_asserteq(UCLASS_TEST, rec->uclass_id);
+			ut_asserteq(dev->stats.priv_bytes, rec->priv_bytes);
+			found = true;
+		}
+		/* slowest first */
+		if (i)
+			ut_assert(rec->probe_us <= rec[-1].probe_us);
+	}
+	ut_assert(found);
+
+	/* the record is replaced when written again */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(dm_stash_times());
+	hdr = bloblist_find(BLOBLISTT_U_BOOT_DM_TIMES, 0);
+	ut_assertnonnull(hdr);
+	ut_asserteq(count - 1, hdr->count);
+
+	return 0;
+}
+DM_TEST(dm_test_dev_times_stash, UT_TESTF_SCAN_PDATA);
+#endif
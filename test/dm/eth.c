@@ -14,6 +14,8 @@
 #include <malloc.h>
 #include <net.h>
 #include <net6.h>
+#include <net/pktbuf.h>
+#include <net/sink.h>
 #include <asm/eth.h>
 #include <dm/test.h>
 #include <dm/device-internal.h>
@@ -617,6 +619,175 @@ static int dm_test_eth_async_ping_reply(struct unit_test_state *uts)
 
 DM_TEST(dm_test_eth_async_ping_reply, UT_TESTF_SCAN_FDT);
 
+/* Test allocating, referencing and releasing pool packet buffers */
+static int dm_test_eth_pktbuf(struct unit_test_state *uts)
+{
+	struct pktbuf_stats before, stats;
+	uchar *pkts[PKTBUFSRX + 1 + CONFIG_NET_PKTBUF_EXTRA];
+	uchar local;
+	uchar *pkt;
+	int count, i;
+
+	pktbuf_get_stats(&before);
+	pkt = pktbuf_alloc();
+	ut_assertnonnull(pkt);
+	ut_assert(pktbuf_is_pooled(pkt));
+	ut_asserteq(0, (ulong)pkt % PKTALIGN);
+	ut_asserteq(before.headroom, pktbuf_headroom(pkt));
+
+	pktbuf_get_stats(&stats);
+	ut_asserteq(before.in_use + 1, stats.in_use);
+	ut_asserteq(before.allocs + 1, stats.allocs);
+
+	/* An extra reference keeps the buffer allocated */
+	ut_assert(!pktbuf_is_shared(pkt));
+	pktbuf_get(pkt);
+	ut_assert(pktbuf_is_shared(pkt));
+	pktbuf_put(pkt);
+	ut_assert(!pktbuf_is_shared(pkt));
+	ut_assert(pktbuf_is_pooled(pkt));
+	pktbuf_put(pkt);
+	ut_assert(!pktbuf_is_pooled(pkt));
+	pktbuf_get_stats(&stats);
+	ut_asserteq(before.in_use, stats.in_use);
+
+	/* Headers can be prepended within the headroom only */
+	ut_asserteq_ptr(pkt - before.headroom,
+			pktbuf_push(pkt, before.headroom));
+	ut_assertnull(pktbuf_push(pkt, before.headroom + 1));
+	ut_asserteq(0, pktbuf_headroom(&local));
+	ut_assert(!pktbuf_is_pooled(&local));
+
+	/* Drain the pool */
+	count = 0;
+	while ((pkt = pktbuf_alloc()))
+		pkts[count++] = pkt;
+	ut_asserteq(before.total - before.in_use, count);
+	pktbuf_get_stats(&stats);
+	ut_asserteq(before.fails + 1, stats.fails);
+	ut_asserteq(before.total, stats.peak);
+
+	for (i = 0; i < count; i++)
+		pktbuf_put(pkts[i]);
+	pktbuf_get_stats(&stats);
+	ut_asserteq(before.in_use, stats.in_use);
+
+	return 0;
+}
+
+DM_TEST(dm_test_eth_pktbuf, 0);
+
+#if IS_ENABLED(CONFIG_NET_SINK)
+#define SINK_CHUNK	(CONFIG_NET_SINK_BUF_SIZE / 2)
+#define SINK_SIZE	(SINK_CHUNK * 3 + 0x123)
+#define SINK_PIECE	0x400
+
+static uchar *sink_dst;
+static ulong sink_written;
+static int sink_writes;
+static bool sink_finished;
+static bool sink_aborted;
+
+static int sb_sink_write(struct net_sink *sink, u64 offset, void *buf,
+			 ulong len)
+{
+	/* data must arrive in order */
+	if (offset != sink_written || offset + len > SINK_SIZE)
+		return -EINVAL;
+	memcpy(sink_dst + offset, buf, len);
+	sink_written += len;
+	sink_writes++;
+
+	return 0;
+}
+
+static int sb_sink_finish(struct net_sink *sink, u64 size)
+{
+	sink_finished = size == sink_written;
+
+	return 0;
+}
+
+static void sb_sink_abort(struct net_sink *sink)
+{
+	sink_aborted = true;
+}
+
+static struct net_sink sb_sink = {
+	.name	= "test",
+	.align	= 0x100,
+	.write	= sb_sink_write,
+	.finish	= sb_sink_finish,
+	.abort	= sb_sink_abort,
+};
+
+/* Test streaming a download received partly out of order to a sink */
+static int dm_test_eth_sink(struct unit_test_state *uts)
+{
+	uchar *src;
+	ulong i;
+
+	src = malloc(SINK_SIZE);
+	sink_dst = calloc(1, SINK_SIZE);
+	ut_assertnonnull(src);
+	ut_assertnonnull(sink_dst);
+	for (i = 0; i < SINK_SIZE; i++)
+		src[i] = i * 7 + (i >> 8);
+
+	sink_written = 0;
+	sink_writes = 0;
+	sink_finished = false;
+	sink_aborted = false;
+	ut_assertok(net_sink_set(&sb_sink));
+	ut_assert(net_sink_active());
+
+	/* Store pairs of pieces swapped, and every piece twice */
+	for (i = 0; i < SINK_SIZE; i += 2 * SINK_PIECE) {
+		ulong next = min_t(ulong, i + SINK_PIECE, SINK_SIZE);
+		ulong len = min_t(ulong, SINK_PIECE, SINK_SIZE - next);
+
+		if (len)
+			ut_assertok(net_sink_store(next, src + next, len));
+		ut_assertok(net_sink_store(i, src + i, next - i));
+		ut_assertok(net_sink_store(i, src + i, next - i));
+	}
+	/* Only whole halves of the staging buffer are written so far */
+	ut_asserteq(3, sink_writes);
+	ut_asserteq(SINK_CHUNK * 3, sink_written);
+
+	/* A restarted transfer does not write the data again */
+	ut_assertok(net_sink_store(0, src, SINK_PIECE));
+
+	ut_assertok(net_sink_end(true, 0, SINK_SIZE));
+	ut_assert(!net_sink_active());
+	ut_assert(sink_finished);
+	ut_assert(!sink_aborted);
+	ut_asserteq(4, sink_writes);
+	ut_asserteq_mem(src, sink_dst, SINK_SIZE);
+
+	/* Data beyond the staging buffer is refused */
+	ut_assertok(net_sink_set(&sb_sink));
+	ut_assert(net_sink_store(SINK_CHUNK * 2, src, 1) < 0);
+	ut_asserteq(-EIO, net_sink_end(true, 0, SINK_CHUNK * 2 + 1));
+	ut_assert(sink_aborted);
+	ut_assert(!net_sink_active());
+
+	/* A transfer which is not a download leaves the sink alone */
+	ut_assertok(net_sink_set(&sb_sink));
+	ut_assertok(net_sink_end(false, 0, 0));
+	ut_assert(net_sink_active());
+	net_sink_clear();
+	ut_assert(!net_sink_active());
+
+	free(sink_dst);
+	free(src);
+
+	return 0;
+}
+
+DM_TEST(dm_test_eth_sink, 0);
+#endif
+
 #if IS_ENABLED(CONFIG_IPV6_ROUTER_DISCOVERY)
 
 static u8 ip6_ra_buf[] = {0x60, 0xf, 0xc5, 0x4a, 0x0, 0x38, 0x3a, 0xff, 0xfe,
@@ -23,6 +23,7 @@
 #include <of_live.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
 #include <dm/root.h>
 #include <dm/test.h>
@@ -1366,6 +1367,117 @@ static int dm_test_livetree_ensure(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_livetree_ensure, UT_TESTF_SCAN_FDT);
 
+/* check that two live trees have the same nodes and properties */
+static int check_same_tree(struct unit_test_state *uts,
+			   const struct device_node *np,
+			   const struct device_node *ref)
+{
+	const struct property *pp, *rp;
+
+	for (; np || ref; np = np->sibling, ref = ref->sibling) {
+		ut_assertnonnull(np);
+		ut_assertnonnull(ref);
+		ut_asserteq_str(ref->full_name, np->full_name);
+		ut_asserteq_str(ref->name, np->name);
+		ut_asserteq_str(ref->type, np->type);
+		ut_asserteq(ref->phandle, np->phandle);
+		for (pp = np->properties, rp = ref->properties; pp || rp;
+		     pp = pp->next, rp = rp->next) {
+			ut_assertnonnull(pp);
+			ut_assertnonnull(rp);
+			ut_asserteq_str(rp->name, pp->name);
+			ut_asserteq(rp->length, pp->length);
+			ut_asserteq_mem(rp->value, pp->value, rp->length);
+		}
+		if (np->parent)
+			ut_asserteq_str(ref->parent->full_name,
+					np->parent->full_name);
+		ut_assertok(check_same_tree(uts, np->child, ref->child));
+	}
+
+	return 0;
+}
+
+/* check stashing a live tree and using it at another address */
+static int dm_test_livetree_stash(struct unit_test_state *uts)
+{
+	struct device_node *root, *ref;
+	void *fdt, *buf, *moved;
+	const void *val;
+	long size;
+	int fdt_size, len;
+
+	/* move both the flat tree and the stash after stashing */
+	fdt_size = fdt_totalsize(gd->fdt_blob);
+	fdt = malloc(fdt_size);
+	ut_assertnonnull(fdt);
+	size = of_live_stash_size(gd->fdt_blob);
+	ut_assert(size > 0);
+	buf = memalign(__alignof__(struct device_node), size);
+	moved = memalign(__alignof__(struct device_node), size);
+	ut_assertnonnull(buf);
+	ut_assertnonnull(moved);
+	ut_asserteq(-ENOSPC, of_live_stash(gd->fdt_blob, buf, size - 1));
+	ut_assertok(of_live_stash(gd->fdt_blob, buf, size));
+	memcpy(fdt, gd->fdt_blob, fdt_size);
+	memcpy(moved, buf, size);
+	memset(buf, '\xff', size);
+
+	ut_assertok(of_live_unstash(moved, fdt, &root));
+	ut_assert((void *)root > moved && (void *)root < moved + size);
+	ut_assertok(unflatten_device_tree(fdt, &ref));
+	ut_assertok(check_same_tree(uts, root, ref));
+
+	/* property values are shared with the flat tree */
+	val = fdt_getprop(fdt, 0, "compatible", &len);
+	ut_assertnonnull(val);
+	ut_asserteq_ptr(val, of_get_property(root, "compatible", NULL));
+
+	/* the tree can only be unstashed once */
+	ut_asserteq(-EINVAL, of_live_unstash(moved, fdt, &root));
+
+	/* a changed flat tree cannot use the stash */
+	ut_assertok(of_live_stash(fdt, buf, size));
+	ut_assertok(fdt_setprop_inplace_u32(fdt, 0, "#address-cells", 3));
+	ut_asserteq(-ENOENT, of_live_unstash(buf, fdt, &root));
+
+	of_live_free(ref);
+	free(moved);
+	free(buf);
+	free(fdt);
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_stash, 0);
+
+/* check looking up nodes by phandle in the control tree */
+static int dm_test_livetree_phandle(struct unit_test_state *uts)
+{
+	struct device_node *np, *first;
+	int count = 0;
+
+	for_each_of_allnodes(np) {
+		if (!np->phandle)
+			continue;
+		first = of_find_node_by_phandle(NULL, np->phandle);
+		ut_assertnonnull(first);
+		ut_asserteq(np->phandle, first->phandle);
+		count++;
+	}
+	ut_assert(count > 0);
+	ut_assertnull(of_find_node_by_phandle(NULL, 0));
+	ut_assertnull(of_find_node_by_phandle(NULL, 0xfffffff0));
+
+	/* a lookup still works after the index is dropped */
+	np = of_find_node_opts_by_path(NULL, "/pinctrl-gpio/base-gpios", NULL);
+	ut_assertnonnull(np);
+	of_reset_phandle_index();
+	ut_asserteq_ptr(np, of_find_node_by_phandle(NULL, np->phandle));
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_phandle, UT_TESTF_SCAN_FDT | UT_TESTF_LIVE_TREE);
+
 static int dm_test_oftree_new(struct unit_test_state *uts)
 {
 	ofnode node, subnode, check;
@@ -16,6 +16,7 @@
 #include <dm/root.h>
 #include <dm/device-internal.h>
 #include <dm/devres.h>
+#include <dm/lists.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
 #include <dm/of_access.h>
@@ -1227,3 +1228,42 @@ static int dm_test_read_resource(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_read_resource, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that looking up drivers by compatible string finds the first one */
+static int dm_test_lists_compat(struct unit_test_state *uts)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id, *found, *first;
+	struct driver *entry, *drv;
+	int count = 0;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			drv = lists_driver_lookup_compat(id->compatible,
+							 &found);
+			ut_assertnonnull(drv);
+			ut_asserteq_str(id->compatible, found->compatible);
+
+			/* an earlier driver or entry must take precedence */
+			ut_assert(drv <= entry);
+			if (drv == entry)
+				ut_assert(found <= id);
+			for (first = drv->of_match; first != found; first++)
+				ut_assert(strcmp(first->compatible,
+						 id->compatible));
+			count++;
+		}
+	}
+	ut_assert(count > 0);
+
+	ut_assertnull(lists_driver_lookup_compat("sandbox,no-such-driver",
+						 &found));
+	ut_asserteq_ptr(DM_DRIVER_GET(denx_u_boot_fdt_test),
+			lists_driver_lookup_compat("denx,u-boot-fdt-test",
+						   &found));
+	ut_asserteq(DM_TEST_TYPE_FIRST, found->data);
+
+	return 0;
+}
+DM_TEST(dm_test_lists_compat, 0);
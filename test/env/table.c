@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the default environment table
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_internal.h>
+#include <env_table.h>
+#include <search.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+/* Check the table against the parsed default environment */
+static int env_test_default_table(struct unit_test_state *uts)
+{
+	const struct env_table *tab = &env_default_table;
+	struct hsearch_data linear, table;
+	struct env_entry item, *ep;
+	const char *name, *prev = NULL;
+	char buf[32];
+	int i, size;
+
+	for (size = 0; default_environment[size] ||
+	     default_environment[size + 1]; size++)
+		;
+	memset(&linear, '\0', sizeof(linear));
+	memset(&table, '\0', sizeof(table));
+	ut_asserteq(1, himport_r(&linear, default_environment, size + 2, '\0',
+				 0, 0, 0, NULL));
+	ut_asserteq(1, env_table_import(tab, &table, 0));
+	ut_asserteq(linear.filled, table.filled);
+	ut_asserteq(tab->count, table.filled);
+
+	for (i = 0; i < tab->count; i++) {
+		name = tab->strings + tab->index[i];
+		if (prev)
+			ut_assert(strcmp(prev, name) < 0);
+		prev = name;
+
+		item.key = name;
+		item.data = NULL;
+		ut_assert(hsearch_r(item, ENV_FIND, &ep, &linear, 0));
+		ut_asserteq_str(ep->data, env_table_get(tab, name));
+
+		/* the imported variable refers to the table */
+		ut_assert(hsearch_r(item, ENV_FIND, &ep, &table, 0));
+		ut_asserteq_ptr(env_table_get(tab, name), ep->data);
+		ut_assert(env_table_owns(ep->key));
+	}
+	ut_assertnull(env_table_get(tab, "not-a-default-variable"));
+
+	/* deleted variables are not set */
+	for (i = 0; i < tab->deleted_count; i++) {
+		name = tab->strings + tab->deleted[i];
+		ut_assertnull(env_table_get(tab, name));
+		item.key = name;
+		item.data = NULL;
+		ut_assert(!hsearch_r(item, ENV_FIND, &ep, &linear, 0));
+	}
+
+	if (tab->count) {
+		/* changing a variable copies it */
+		item.key = tab->strings + tab->index[0];
+		item.data = "changed";
+		ut_assert(hsearch_r(item, ENV_ENTER, &ep, &table, 0));
+		ut_asserteq_str("changed", ep->data);
+		ut_assert(!env_table_owns(ep->data));
+		ut_assertok(hdelete_r(item.key, &table, 0));
+
+		ut_asserteq(strlen(env_table_get(tab, item.key)),
+			    env_get_default_into(item.key, buf, sizeof(buf)));
+	}
+
+	hdestroy_r(&linear);
+	hdestroy_r(&table);
+
+	return 0;
+}
+ENV_TEST(env_test_default_table, 0);
+
+/* Check that importing without clearing deletes variables as himport_r() does */
+static int env_test_table_delete(struct unit_test_state *uts)
+{
+	static const char strings[] = "a\0" "1\0" "b\0";
+	static const unsigned int index[] = { 0 };
+	static const unsigned int deleted[] = { 4 };
+	const struct env_table tab = {
+		.strings	= strings,
+		.size		= sizeof(strings),
+		.index		= index,
+		.count		= ARRAY_SIZE(index),
+		.deleted	= deleted,
+		.deleted_count	= ARRAY_SIZE(deleted),
+	};
+	struct hsearch_data htab;
+	struct env_entry item, *ep;
+
+	memset(&htab, '\0', sizeof(htab));
+	ut_asserteq(1, himport_r(&htab, "b=2\0c=3\0", 9, '\0', 0, 0, 0,
+				 NULL));
+	ut_asserteq(1, env_table_import(&tab, &htab, H_NOCLEAR));
+
+	item.data = NULL;
+	item.key = "a";
+	ut_assert(hsearch_r(item, ENV_FIND, &ep, &htab, 0));
+	ut_asserteq_str("1", ep->data);
+	item.key = "b";
+	ut_assert(!hsearch_r(item, ENV_FIND, &ep, &htab, 0));
+	item.key = "c";
+	ut_assert(hsearch_r(item, ENV_FIND, &ep, &htab, 0));
+	ut_asserteq_str("3", ep->data);
+
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_table_delete, 0);
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for the SHA-1 and SHA-256 implementations
+ */
+
+#include <test/lib.h>
+#include <test/ut.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+static const char sha_str1[] = "abc";
+static const char sha_str2[] =
+	"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+/* Pieces for feeding 1000 bytes, crossing block boundaries in various ways */
+static const int sha_pieces[] = { 1, 63, 64, 65, 127, 3, 677 };
+
+static void sha_fill(u8 *buf, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = i * 131 + 7;
+}
+
+#if CONFIG_IS_ENABLED(SHA1)
+static int lib_sha1(struct unit_test_state *uts)
+{
+	static const u8 expect1[SHA1_SUM_LEN] = {
+		0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+		0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d,
+	};
+	static const u8 expect2[SHA1_SUM_LEN] = {
+		0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+		0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1,
+	};
+	static const u8 expect3[SHA1_SUM_LEN] = {
+		0x42, 0x5b, 0x5f, 0x2d, 0x2d, 0x34, 0x4f, 0x4f, 0x64, 0x67,
+		0xcd, 0xa9, 0x06, 0x5c, 0xdc, 0x84, 0x06, 0x19, 0xdc, 0x2d,
+	};
+	u8 buf[1001], out[SHA1_SUM_LEN];
+	sha1_context ctx;
+	int i, pos;
+
+	sha1_csum((const u8 *)sha_str1, strlen(sha_str1), out);
+	ut_asserteq_mem(expect1, out, SHA1_SUM_LEN);
+	sha1_csum((const u8 *)sha_str2, strlen(sha_str2), out);
+	ut_asserteq_mem(expect2, out, SHA1_SUM_LEN);
+
+	/* several blocks at once, from an unaligned buffer */
+	sha_fill(buf + 1, 1000);
+	sha1_csum_wd(buf + 1, 1000, out, 128);
+	ut_asserteq_mem(expect3, out, SHA1_SUM_LEN);
+
+	sha1_starts(&ctx);
+	for (i = 0, pos = 0; i < ARRAY_SIZE(sha_pieces); i++) {
+		sha1_update(&ctx, buf + 1 + pos, sha_pieces[i]);
+		pos += sha_pieces[i];
+	}
+	sha1_finish(&ctx, out);
+	ut_asserteq_mem(expect3, out, SHA1_SUM_LEN);
+
+	return 0;
+}
+LIB_TEST(lib_sha1, 0);
+#endif
+
+static int lib_sha256(struct unit_test_state *uts)
+{
+	static const u8 expect1[SHA256_SUM_LEN] = {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+		0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+	};
+	static const u8 expect2[SHA256_SUM_LEN] = {
+		0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+		0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+		0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+		0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1,
+	};
+	static const u8 expect3[SHA256_SUM_LEN] = {
+		0x53, 0x3b, 0x69, 0x88, 0x50, 0x84, 0x9b, 0x79,
+		0x08, 0xb2, 0x0a, 0x22, 0x65, 0x8f, 0x63, 0x9c,
+		0x0b, 0x2a, 0x47, 0x6f, 0x17, 0x91, 0xf8, 0x5f,
+		0x50, 0x18, 0x82, 0x87, 0xc3, 0x1a, 0x9a, 0xba,
+	};
+	u8 buf[1001], out[SHA256_SUM_LEN];
+	sha256_context ctx;
+	int i, pos;
+
+	sha256_csum_wd((const u8 *)sha_str1, strlen(sha_str1), out,
+		       CHUNKSZ_SHA256);
+	ut_asserteq_mem(expect1, out, SHA256_SUM_LEN);
+	sha256_csum_wd((const u8 *)sha_str2, strlen(sha_str2), out,
+		       CHUNKSZ_SHA256);
+	ut_asserteq_mem(expect2, out, SHA256_SUM_LEN);
+
+	/* several blocks at once, from an unaligned buffer */
+	sha_fill(buf + 1, 1000);
+	sha256_csum_wd(buf + 1, 1000, out, 128);
+	ut_asserteq_mem(expect3, out, SHA256_SUM_LEN);
+
+	sha256_starts(&ctx);
+	for (i = 0, pos = 0; i < ARRAY_SIZE(sha_pieces); i++) {
+		sha256_update(&ctx, buf + 1 + pos, sha_pieces[i]);
+		pos += sha_pieces[i];
+	}
+	sha256_finish(&ctx, out);
+	ut_asserteq_mem(expect3, out, SHA256_SUM_LEN);
+
+	return 0;
+}
+LIB_TEST(lib_sha256, 0);
@@ -9,6 +9,7 @@ Test operation of shell commands relating to environment variables.
 import os
 import os.path
 import re
+import struct
 from subprocess import call, CalledProcessError
 import tempfile
 
@@ -545,6 +546,151 @@ def test_env_ext4(state_test_env):
         if fs_img:
             call('rm -f %s' % fs_img, shell=True)
 
+# Magic of a record in the SPI flash environment log, "EnvL"
+ENV_SF_LOG_MAGIC = 0x4c766e45
+
+def read_env_sf_log(fname, offset, size):
+    """Read the records in the SPI flash environment log
+
+    Args:
+        fname: Filename of the SPI flash image
+        offset: Offset of the log in the image
+        size: Size of the log
+
+    Returns:
+        tuple:
+            list of bytes: Data of each record
+            int: Offset of the end of the log, within the log area
+    """
+    with open(fname, 'rb') as fh:
+        fh.seek(offset)
+        data = fh.read(size)
+    recs = []
+    pos = 0
+    while pos + 16 <= size:
+        magic, rec_size = struct.unpack_from('=II', data, pos)
+        if magic != ENV_SF_LOG_MAGIC:
+            break
+        recs.append(data[pos + 16:pos + 16 + rec_size])
+        pos += 16 + rec_size
+    assert data[pos:] == b'\xff' * (size - pos)
+    return recs, pos
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_echo')
+@pytest.mark.buildconfigspec('cmd_nvedit_load')
+@pytest.mark.buildconfigspec('cmd_nvedit_select')
+@pytest.mark.buildconfigspec('env_sf_log')
+def test_env_sf_log(state_test_env):
+    """Test the environment log in SPI flash on sandbox
+
+    This checks that saving appends the changes to the log, that loading
+    replays them and that a record left by an interrupted save is ignored,
+    with the next save writing the whole environment and starting a new log.
+    """
+    c = state_test_env.u_boot_console
+    config = c.config.buildconfig
+    env_offset = int(config['config_env_offset'], 0)
+    env_size = int(config['config_env_sect_size'], 0)
+    log_offset = int(config['config_env_sf_log_offset'], 0)
+    log_size = int(config['config_env_sf_log_size'], 0)
+
+    # the flash must be changed in place, since sandbox may have it open
+    fname = c.config.source_dir + '/spi.bin'
+    if not os.path.exists(fname):
+        with open(fname, 'wb') as fh:
+            fh.write(b'\x00' * (2 * 1024 * 1024))
+    with open(fname, 'r+b') as fh:
+        fh.seek(env_offset)
+        old_env = fh.read(env_size)
+        fh.seek(log_offset)
+        old_log = fh.read(log_size)
+        fh.seek(env_offset)
+        fh.write(b'\xff' * env_size)
+        fh.seek(log_offset)
+        fh.write(b'\xff' * log_size)
+
+    try:
+        response = c.run_command('env select SPIFlash')
+        assert 'Select Environment on SPIFlash: OK' in response
+
+        response = c.run_command('env load')
+        assert 'bad CRC, using default environment' in response
+
+        # the log is not valid until the environment is written
+        c.run_command('env set test_sf_log one')
+        response = c.run_command('env save')
+        assert 'Writing to SPI flash...done' in response
+        assert 'Erasing SPI flash log...done' in response
+        assert 'OK' in response
+        assert read_env_sf_log(fname, log_offset, log_size) == ([], 0)
+
+        # each save now appends the changes
+        c.run_command('env set test_sf_log two')
+        c.run_command('env set test_sf_log2 two')
+        response = c.run_command('env save')
+        assert 'Appending to SPI flash...done' in response
+        assert 'Writing to SPI flash' not in response
+        c.run_command('env set test_sf_log three')
+        c.run_command('env set test_sf_log2')
+        response = c.run_command('env save')
+        assert 'Appending to SPI flash...done' in response
+        recs, end = read_env_sf_log(fname, log_offset, log_size)
+        assert len(recs) == 2
+        assert recs[0].rstrip(b'\0') == b'test_sf_log=two\0test_sf_log2=two'
+        assert recs[1].rstrip(b'\0') == b'test_sf_log=three\0test_sf_log2'
+
+        response = c.run_command('env save')
+        assert 'Unchanged' in response
+        assert read_env_sf_log(fname, log_offset, log_size) == (recs, end)
+
+        # loading replays the log over the environment
+        c.run_command('env set test_sf_log changed')
+        c.run_command('env set test_sf_log2 changed')
+        response = c.run_command('env load')
+        assert 'Loading Environment from SPIFlash... OK' in response
+        assert c.run_command('echo $test_sf_log') == 'three'
+        response = c.run_command('printenv test_sf_log2')
+        assert '"test_sf_log2" not defined' in response
+
+        # a save interrupted while programming leaves a partial record
+        with open(fname, 'r+b') as fh:
+            fh.seek(log_offset + end)
+            fh.write(struct.pack('=IIII', ENV_SF_LOG_MAGIC, 20, 0, 0) +
+                     b'test_sf_log=fo')
+        response = c.run_command('env load')
+        assert 'Loading Environment from SPIFlash... OK' in response
+        assert c.run_command('echo $test_sf_log') == 'three'
+
+        # which cannot be appended to, so the next save starts again
+        c.run_command('env set test_sf_log four')
+        response = c.run_command('env save')
+        assert 'Appending to SPI flash' not in response
+        assert 'Writing to SPI flash...done' in response
+        assert 'Erasing SPI flash log...done' in response
+        assert read_env_sf_log(fname, log_offset, log_size) == ([], 0)
+
+        c.run_command('env set test_sf_log five')
+        response = c.run_command('env save')
+        assert 'Appending to SPI flash...done' in response
+        c.run_command('env set test_sf_log changed')
+        response = c.run_command('env load')
+        assert 'Loading Environment from SPIFlash... OK' in response
+        assert c.run_command('echo $test_sf_log') == 'five'
+
+    finally:
+        with open(fname, 'r+b') as fh:
+            fh.seek(env_offset)
+            fh.write(old_env)
+            fh.seek(log_offset)
+            fh.write(old_log)
+
+        # restore env location: NOWHERE (prio 0 in sandbox)
+        response = c.run_command('env select nowhere')
+        assert 'Select Environment on nowhere: OK' in response
+        response = c.run_command('env load')
+        assert 'Loading Environment from nowhere... OK' in response
+
 def test_env_text(u_boot_console):
     """Test the script that converts the environment to a text file"""
 
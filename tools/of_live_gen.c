@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Generate U-Boot's live tree at build time
+ *
+ * This reads a device tree blob and writes a C file holding the live tree
+ * which unflatten_device_tree() would build from it, in the stashed form used
+ * by of_live_unstash(): pointers into the tree and into the blob are written
+ * as offsets, so the C compiler lays out the target's structures and U-Boot
+ * only has to turn the offsets back into pointers. See CONFIG_OF_LIVE_BUILTIN
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <u-boot/crc.h>
+#include "fdt_host.h"
+
+static const void *blob;
+
+/* Write a reference to an offset in the device tree blob */
+static void fdt_ref(const char *field, const void *ptr)
+{
+	printf("\t\t.%s = FDT(%#lx),\n", field,
+	       (unsigned long)((const char *)ptr - (const char *)blob));
+}
+
+/* Write a string as a C literal */
+static void put_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			putchar('\\');
+		putchar(*str);
+	}
+	putchar('"');
+}
+
+/*
+ * Get the full path of a node, given the path of its parent, which is empty
+ * for the root node and its subnodes. Returns NULL if out of memory
+ */
+static char *node_path(int offset, const char *parent)
+{
+	const char *name = fdt_get_name(blob, offset, NULL);
+	char *path;
+
+	if (!offset)
+		return strdup("/");
+	path = malloc(strlen(parent) + strlen(name) + 2);
+	if (path)
+		sprintf(path, "%s/%s", parent, name);
+
+	return path;
+}
+
+/* Count the nodes in a subtree */
+static int count_nodes(int offset)
+{
+	int subnode, count = 1;
+
+	fdt_for_each_subnode(subnode, blob, offset)
+		count += count_nodes(subnode);
+
+	return count;
+}
+
+/*
+ * Write the struct members for a node, its properties and its subnodes,
+ * returning the number of the next node or -ve on error
+ */
+static int declare_node(int offset, int num, const char *parent)
+{
+	int prop, subnode, count;
+	char *path;
+
+	path = node_path(offset, parent);
+	if (!path)
+		return -ENOMEM;
+	printf("\tstruct device_node n%d;\n", num);
+	printf("\tchar n%d_path[%zu];\n", num, strlen(path) + 1);
+	count = 0;
+	fdt_for_each_property_offset(prop, blob, offset)
+		printf("\tstruct property n%d_p%d;\n", num, count++);
+
+	num++;
+	fdt_for_each_subnode(subnode, blob, offset) {
+		num = declare_node(subnode, num, offset ? path : "");
+		if (num < 0)
+			break;
+	}
+	free(path);
+
+	return num;
+}
+
+/*
+ * Write the initialiser for a node, its properties and its subnodes, in the
+ * same form as unflatten_device_tree() creates them. The node has number @num,
+ * its parent @parent and its next sibling @sibling, or -1 if none. Returns the
+ * number of the next node, or -ve on error
+ */
+static int define_node(int offset, int num, int parent, int sibling,
+		       const char *parent_path)
+{
+	const void *type = NULL;
+	const char *name;
+	int prop, subnode, next, count;
+	unsigned int phandle = 0;
+	char *path;
+
+	name = fdt_get_name(blob, offset, NULL);
+	if (!name)
+		return -EINVAL;
+
+	/* version 0x10 onwards has the unit name rather than the full path */
+	if (*name == '/') {
+		fprintf(stderr, "Device tree version %d is not supported\n",
+			fdt_version(blob));
+		return -EINVAL;
+	}
+
+	count = 0;
+	fdt_for_each_property_offset(prop, blob, offset) {
+		const char *pname;
+		const void *value;
+		int sz;
+
+		value = fdt_getprop_by_offset(blob, prop, &pname, &sz);
+		if (!value || !pname)
+			return -EINVAL;
+		if (!strcmp(pname, "phandle") ||
+		    !strcmp(pname, "linux,phandle")) {
+			if (!phandle)
+				phandle = fdt32_to_cpu(*(fdt32_t *)value);
+		}
+		if (!strcmp(pname, "ibm,phandle"))
+			phandle = fdt32_to_cpu(*(fdt32_t *)value);
+		if (!type && !strcmp(pname, "device_type"))
+			type = value;
+
+		printf("\t.n%d_p%d = {\n", num, count);
+		fdt_ref("name", pname);
+		printf("\t\t.length = %d,\n", sz);
+		fdt_ref("value", value);
+		if (fdt_next_property_offset(blob, prop) >= 0)
+			printf("\t\t.next = TREE(n%d_p%d),\n", num, count + 1);
+		printf("\t},\n");
+		count++;
+	}
+
+	path = node_path(offset, parent_path);
+	if (!path)
+		return -ENOMEM;
+	subnode = fdt_first_subnode(blob, offset);
+	printf("\t.n%d = {\n", num);
+	if (offset)
+		fdt_ref("name", name);
+	else
+		printf("\t\t.name = CONST(OF_LIVE_CONST_ROOT),\n");
+	if (type)
+		fdt_ref("type", type);
+	else
+		printf("\t\t.type = CONST(OF_LIVE_CONST_NULL),\n");
+	printf("\t\t.phandle = %#x,\n", phandle);
+	printf("\t\t.full_name = TREE(n%d_path),\n", num);
+	if (count)
+		printf("\t\t.properties = TREE(n%d_p0),\n", num);
+	if (parent >= 0)
+		printf("\t\t.parent = TREE(n%d),\n", parent);
+	if (subnode >= 0)
+		printf("\t\t.child = TREE(n%d),\n", num + 1);
+	if (sibling >= 0)
+		printf("\t\t.sibling = TREE(n%d),\n", sibling);
+	printf("\t},\n");
+	printf("\t.n%d_path = ", num);
+	put_string(path);
+	printf(",\n");
+
+	next = num + 1;
+	for (; subnode >= 0 && next >= 0;
+	     subnode = fdt_next_subnode(blob, subnode)) {
+		int following = -1;
+
+		if (fdt_next_subnode(blob, subnode) >= 0)
+			following = next + count_nodes(subnode);
+		next = define_node(subnode, next, num, following,
+				   offset ? path : "");
+	}
+	free(path);
+
+	return next;
+}
+
+int main(int argc, char *argv[])
+{
+	void *buf;
+	long size;
+	FILE *f;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s <dtb>\n", argv[0]);
+		return 1;
+	}
+	f = fopen(argv[1], "rb");
+	if (!f) {
+		perror(argv[1]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	rewind(f);
+	buf = malloc(size);
+	if (!buf || fread(buf, 1, size, f) != size) {
+		perror(argv[1]);
+		return 1;
+	}
+	fclose(f);
+	blob = buf;
+	if (fdt_check_header(blob) || fdt_totalsize(blob) > size) {
+		fprintf(stderr, "%s: Invalid device tree\n", argv[1]);
+		return 1;
+	}
+
+	printf("// SPDX-License-Identifier: GPL-2.0+\n");
+	printf("/* Generated by of_live_gen from %s, do not edit */\n\n",
+	       argv[1]);
+	printf("#include <common.h>\n");
+	printf("#include <of_live.h>\n");
+	printf("#include <dm/of.h>\n\n");
+
+	printf("struct of_live_builtin {\n");
+	printf("\tstruct of_live_stash hdr;\n");
+	if (declare_node(0, 0, "") < 0)
+		return 1;
+	printf("};\n\n");
+
+	printf("#define REF(offset, tag) \\\n");
+	printf("\t((void *)((unsigned long)(offset) << OF_LIVE_REF_SHIFT | (tag)))\n");
+	printf("#define TREE(member) \\\n");
+	printf("\tREF(offsetof(struct of_live_builtin, member) - OF_LIVE_STASH_HDR, \\\n");
+	printf("\t    OF_LIVE_REF_TREE)\n");
+	printf("#define FDT(offset)\tREF(offset, OF_LIVE_REF_FDT)\n");
+	printf("#define CONST(index)\tREF(index, OF_LIVE_REF_CONST)\n\n");
+
+	printf("_Static_assert(offsetof(struct of_live_builtin, n0) == OF_LIVE_STASH_HDR,\n");
+	printf("\t       \"the tree must follow the header\");\n\n");
+
+	printf("static struct of_live_builtin tree = {\n");
+	printf("\t.hdr = {\n");
+	printf("\t\t.magic = OF_LIVE_STASH_MAGIC,\n");
+	printf("\t\t.fdt_size = %#x,\n", fdt_totalsize(blob));
+	printf("\t\t.fdt_crc = %#x,\n", crc32(0, blob, fdt_totalsize(blob)));
+	printf("\t\t.size = sizeof(struct of_live_builtin) - OF_LIVE_STASH_HDR,\n");
+	printf("\t},\n");
+	if (define_node(0, 0, -1, -1, "") < 0) {
+		fprintf(stderr, "%s: Cannot convert device tree\n", argv[1]);
+		return 1;
+	}
+	printf("};\n\n");
+	printf("void *const of_live_builtin = &tree;\n");
+
+	return 0;
+}
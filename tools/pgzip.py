@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+
+"""
+Compress a file as an indexed gzip file.
+
+The input is split into blocks which are compressed independently, in
+parallel, each as a gzip member of its own. The header of every member has
+an extra field 'UB' holding the compressed size of the member and the size
+of its data, so U-Boot can find the member holding any part of the data
+without decompressing the ones before it: 'unzip -o' reads part of the file
+and 'gzwrite -r' resumes writing it. An empty member marks the end.
+
+The output is a valid gzip file, which gzip -d decompresses as usual.
+"""
+
+import argparse
+import concurrent.futures
+import os
+import struct
+import sys
+import zlib
+
+# gzip header fields
+GZIP_MAGIC = b'\x1f\x8b'
+GZIP_DEFLATED = 8
+GZIP_FEXTRA = 4
+GZIP_OS_UNIX = 3
+
+def parse_size(text):
+    """Parse a size with an optional K, M or G suffix."""
+    mult = {'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}.get(text[-1:].upper())
+    if mult:
+        return int(text[:-1], 0) * mult
+    return int(text, 0)
+
+def parse_args():
+    """Parse command line arguments."""
+    parser = argparse.ArgumentParser(
+        description='Compress a file as an indexed gzip file for U-Boot.')
+    parser.add_argument('input', type=str, help='input file')
+    parser.add_argument('output', type=str, help='output file')
+    parser.add_argument('-b', '--block-size', type=parse_size, default='1M',
+                        help='uncompressed size of each member (default 1M)')
+    parser.add_argument('-l', '--level', type=int, default=6,
+                        choices=range(1, 10), metavar='1-9',
+                        help='compression level (default 6)')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(),
+                        help='number of blocks to compress in parallel')
+
+    args = parser.parse_args()
+    if args.block_size <= 0 or args.block_size >= 1 << 32:
+        parser.error('block size must be between 1 and 4G - 1')
+    return args
+
+def make_member(data, level):
+    """Compress data as a gzip member with an index field.
+
+    Returns:
+        bytes of the member
+    """
+    comp = zlib.compressobj(level, zlib.DEFLATED, -zlib.MAX_WBITS)
+    body = comp.compress(data) + comp.flush()
+    extra = struct.pack('<2sHII', b'UB', 8, 0, 0)
+    size = 12 + len(extra) + len(body) + 8
+    if size >= 1 << 32:
+        raise ValueError('member too large, use a smaller block size')
+    extra = struct.pack('<2sHII', b'UB', 8, size, len(data))
+    header = struct.pack('<2sBBIBBH', GZIP_MAGIC, GZIP_DEFLATED, GZIP_FEXTRA,
+                         0, 0, GZIP_OS_UNIX, len(extra))
+    trailer = struct.pack('<II', zlib.crc32(data), len(data))
+    return header + extra + body + trailer
+
+def read_blocks(inf, block_size):
+    """Generate the blocks of the input file."""
+    while True:
+        data = inf.read(block_size)
+        if not data:
+            break
+        yield data
+
+def main():
+    """Compress the input file."""
+    args = parse_args()
+    with open(args.input, 'rb') as inf, open(args.output, 'wb') as outf, \
+         concurrent.futures.ThreadPoolExecutor(args.jobs) as pool:
+        # zlib releases the GIL, so threads compress blocks in parallel.
+        # Only a limited number of blocks are in flight at once.
+        pending = []
+        for data in read_blocks(inf, args.block_size):
+            pending.append(pool.submit(make_member, data, args.level))
+            if len(pending) > args.jobs * 2:
+                outf.write(pending.pop(0).result())
+        for future in pending:
+            outf.write(future.result())
+        outf.write(make_member(b'', args.level))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())